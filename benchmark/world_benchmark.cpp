@@ -0,0 +1,113 @@
+#include "system/job_system.h"
+#include "system/time.h"
+#include "world/world.h"
+
+// Compares iterating entities stored in archetype chunks (structure of arrays) against the same data stored as an
+// array of structs, where every object carries all of its state even when a system only touches part of it.
+
+namespace Game {
+    struct Position {
+        f32 x, y, z;
+    };
+
+    struct Velocity {
+        f32 x, y, z;
+    };
+
+    struct Rotation {
+        f32 x, y, z, w;
+    };
+
+    struct Scale {
+        f32 x, y, z;
+    };
+
+    struct Health {
+        f32 current, max;
+    };
+
+    struct GameObject {
+        Position position;
+        Velocity velocity;
+        Rotation rotation;
+        Scale scale;
+        Health health;
+        u32 flags;
+    };
+
+    constexpr u32 entity_count = 1'000'000;
+    constexpr u32 iteration_count = 100;
+    constexpr f32 timestep = 1.0f / 60.0f;
+
+    template<typename Function>
+    f64 measure_ns_per_entity(const Function& function) {
+        function(); // Warm up
+        TimePoint start_time = Time::now();
+        for (u32 i = 0; i < iteration_count; ++i) {
+            function();
+        }
+        f64 elapsed_ns = (f64) Time::as<Nanoseconds>(Time::now() - start_time).count();
+        return elapsed_ns / (f64) iteration_count / (f64) entity_count;
+    }
+
+    void run_world_benchmark() {
+        JobSystem job_system{};
+        create_job_system(job_system);
+
+        std::vector<GameObject> game_objects(entity_count);
+        World world{};
+        for (u32 i = 0; i < entity_count; ++i) {
+            GameObject& game_object = game_objects[i];
+            game_object.velocity = { 1.0f, 2.0f, 3.0f };
+            game_object.rotation = { 0.0f, 0.0f, 0.0f, 1.0f };
+            game_object.scale = { 1.0f, 1.0f, 1.0f };
+            game_object.health = { 100.0f, 100.0f };
+            create_entity(world, game_object.position, game_object.velocity, game_object.rotation, game_object.scale, game_object.health);
+        }
+
+        f64 array_of_structs_ns = measure_ns_per_entity([&game_objects] {
+            for (GameObject& game_object : game_objects) {
+                game_object.position.x += game_object.velocity.x * timestep;
+                game_object.position.y += game_object.velocity.y * timestep;
+                game_object.position.z += game_object.velocity.z * timestep;
+            }
+        });
+
+        auto integrate = [](u32 count, Position* positions, const Velocity* velocities) {
+            for (u32 i = 0; i < count; ++i) {
+                positions[i].x += velocities[i].x * timestep;
+                positions[i].y += velocities[i].y * timestep;
+                positions[i].z += velocities[i].z * timestep;
+            }
+        };
+
+        f64 world_ns = measure_ns_per_entity([&world, &integrate] {
+            for_each_chunk<Position, Velocity>(world, integrate);
+        });
+
+        f64 parallel_world_ns = measure_ns_per_entity([&world, &job_system, &integrate] {
+            parallel_for_each_chunk<Position, Velocity>(world, job_system, integrate);
+        });
+
+        GM_LOG_INFO("Iterating [{}] entities [{}] times", entity_count, iteration_count);
+        GM_LOG_INFO("Array of structs:     {:.3f} ns/entity", array_of_structs_ns);
+        GM_LOG_INFO("World chunks:         {:.3f} ns/entity ({:.2f}x)", world_ns, array_of_structs_ns / world_ns);
+        GM_LOG_INFO("World chunks [{} workers]: {:.3f} ns/entity ({:.2f}x)", job_system.worker_count, parallel_world_ns, array_of_structs_ns / parallel_world_ns);
+
+        destroy_job_system(job_system);
+    }
+}
+
+int main() {
+    Game::initialize_log({
+        .level = Game::LogLevel::info,
+        .async_enabled = false,
+    });
+    try {
+        Game::run_world_benchmark();
+    } catch (const Game::Error& e) {
+        e.printStacktrace();
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -1,5 +1,11 @@
 #version 450
 
+layout(push_constant) uniform Transform {
+    vec2 position;
+    float rotation;
+    float scale;
+} transform;
+
 layout(location = 0) out vec3 fragColor;
 
 vec2 positions[3] = vec2[](
@@ -15,6 +21,9 @@ vec3 colors[3] = vec3[](
 );
 
 void main() {
-    gl_Position = vec4(positions[gl_VertexIndex], 0.0, 1.0);
+    float c = cos(transform.rotation);
+    float s = sin(transform.rotation);
+    vec2 position = mat2(c, s, -s, c) * positions[gl_VertexIndex] * transform.scale + transform.position;
+    gl_Position = vec4(position, 0.0, 1.0);
     fragColor = colors[gl_VertexIndex];
-}
\ No newline at end of file
+}
@@ -1,26 +1,99 @@
 #include "app.h"
+#include "graphics/vulkan_instance.h"
+#include "graphics/vulkan_pipeline.h"
+#include "system/file.h"
 
 namespace Game {
+    // Files that the app keeps between runs live next to the executable, so that they are found again regardless of the
+    // working directory the app is started from
+    std::filesystem::path get_app_file_path(const std::filesystem::path& path) {
+        return path.empty() ? path : get_executable_directory() / path;
+    }
+
+    // Every phase writes its own part of the app, so phases that don't depend on each other can run at the same time
     void create_app(App& app, const AppConfig& config) {
-        create_window(app.window, {
-            .title = config.title,
-            .width = config.width,
-            .height = config.height,
-            .maximized = config.maximized,
-            .resizable = config.resizable,
+        app.start_time = Time::now();
+        create_job_system(app.job_system);
+
+        std::filesystem::path pipeline_cache_path = get_app_file_path(config.pipeline_cache_path);
+        std::filesystem::path physical_device_cache_path = get_app_file_path(config.physical_device_cache_path);
+
+        StartupGraph startup_graph{};
+
+        u32 file_loader_phase = add_startup_phase(startup_graph, {
+            .name = "FileLoader",
+            .on_run = [&app, &config] {
+                create_file_loader(app.file_loader, app.job_system, config.file_loader);
+            },
+        });
+
+        // GLFW must be initialized and the window created on the main thread
+        u32 window_phase = add_startup_phase(startup_graph, {
+            .name = "Window",
+            .main_thread = true,
+            .on_run = [&app, &config] {
+                create_window(app.window, {
+                    .title = config.title,
+                    .width = config.width,
+                    .height = config.height,
+                    .maximized = config.maximized,
+                    .resizable = config.resizable,
+                });
+                set_window_event_dispatcher(app.window, &app.event_dispatcher);
+            },
         });
 
-        create_renderer(app.renderer, {
-            .window = &app.window,
-            .app_name = config.title,
-            .debug_enabled = true,
-            .max_frames_in_flight = 2,
+        u32 vulkan_loader_phase = add_startup_phase(startup_graph, {
+            .name = "VulkanLoader",
+            .on_run = [&app] {
+                load_vulkan_instance_properties(app.renderer.vulkan);
+            },
         });
+
+        u32 shader_reflection_phase = add_startup_phase(startup_graph, {
+            .name = "ShaderReflection",
+            .on_run = [&app] {
+                reflect_embedded_shaders(app.renderer.vulkan);
+            },
+        });
+
+        u32 pipeline_cache_file_phase = add_startup_phase(startup_graph, {
+            .name = "PipelineCacheFile",
+            .on_run = [&app, &pipeline_cache_path] {
+                read_vulkan_pipeline_cache_file(app.renderer.vulkan, pipeline_cache_path);
+            },
+        });
+
+        // The surface is created from the window, which GLFW only allows on the main thread on some platforms
+        add_startup_phase(startup_graph, {
+            .name = "Renderer",
+            .dependencies = { window_phase, vulkan_loader_phase, shader_reflection_phase, pipeline_cache_file_phase, file_loader_phase },
+            .main_thread = true,
+            .on_run = [&app, &config, &pipeline_cache_path, &physical_device_cache_path] {
+                create_renderer(app.renderer, {
+                    .window = &app.window,
+                    .file_loader = &app.file_loader,
+                    .app_name = config.title,
+                    .debug_enabled = true,
+                    .max_frames_in_flight = 2,
+                    .shader_hot_reload_enabled = config.shader_hot_reload_enabled,
+                    .shaders_source_directory = config.shaders_source_directory,
+                    .pipeline_cache_path = pipeline_cache_path,
+                    .physical_device_uuid = config.physical_device_uuid,
+                    .physical_device_cache_path = physical_device_cache_path,
+                });
+            },
+        });
+
+        run_startup_graph(startup_graph, app.job_system);
     }
 
-    void destroy_app(const App& app) {
+    void destroy_app(App& app) {
+        // Shader hot reload waits for its loads when the renderer is destroyed
         destroy_renderer(app.renderer);
+        destroy_file_loader(app.file_loader);
         destroy_window(app.window);
+        destroy_job_system(app.job_system);
     }
 
     void start_app(App& app) {
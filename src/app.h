@@ -1,7 +1,14 @@
 #pragma once
 
 #include "graphics/renderer.h"
+#include "system/binary_log.h"
+#include "system/file_loader.h"
+#include "system/flight_recorder.h"
+#include "system/job_system.h"
+#include "system/startup_graph.h"
 #include "window/window.h"
+#include "world/system_scheduler.h"
+#include "world/world.h"
 
 namespace Game {
     struct AppConfig {
@@ -10,19 +17,38 @@ namespace Game {
         i32 height = 600;
         bool maximized = false;
         bool resizable = true;
-        LogLevel log_level = LogLevel::trace;
+        std::filesystem::path pipeline_cache_path = "pipeline_cache.bin"; // Relative to the executable directory
+        std::filesystem::path physical_device_cache_path = "physical_devices.bin"; // Relative to the executable directory
+        std::string physical_device_uuid; // Of the GPU to render with instead of the one that scores highest, as logged at startup
+#ifdef GM_DEBUG
+        bool shader_hot_reload_enabled = true;
+#else
+        bool shader_hot_reload_enabled = false;
+#endif
+        std::filesystem::path shaders_source_directory = GM_SHADERS_SOURCE_DIR;
+        LogConfig log{};
+        BinaryLogConfig binary_log{};
+        FlightRecorderConfig flight_recorder{};
+        FileLoaderConfig file_loader{};
     };
 
     struct App {
         AppConfig config{};
         bool running = false;
+        TimePoint start_time{}; // When the app started to be created, to measure the time to the first frame
+        bool first_frame_rendered = false;
+        JobSystem job_system{};
+        FileLoader file_loader{};
+        EventDispatcher event_dispatcher{};
         Renderer renderer{};
         Window window{};
+        World world{};
+        SystemScheduler system_scheduler{};
     };
 
     void create_app(App& app, const AppConfig& config);
 
-    void destroy_app(const App& app);
+    void destroy_app(App& app);
 
     void start_app(App& app);
 
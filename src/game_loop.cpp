@@ -1,16 +1,35 @@
 #include "game_loop.h"
+#include "system/flight_recorder.h"
 #include "system/time.h"
 
 namespace Game {
     void run_game_loop(App& app, const GameLoopConfig& config) {
+        if (config.update_rate <= 0.0) {
+            GM_THROW("Invalid game loop update rate [" << config.update_rate << "]");
+        }
 
         // Update game at fixed timesteps to have game systems update at a predictable rate
-        constexpr f64 timestep_sec = 1.0 / 60.0;
-        constexpr f64 timestep_ms = timestep_sec * 1000.0;
+        const f64 timestep_sec = 1.0 / config.update_rate;
+        const f64 timestep_ms = timestep_sec * 1000.0;
+
+        // How much game time the loop can simulate per frame before it gives up on catching up
+        const f64 max_ticks_ms = config.max_ticks_per_frame * timestep_ms;
+
+        // Smoothing of the time scale when recovering from overload, to avoid oscillating between slow and normal speed
+        constexpr f64 time_scale_recovery_rate = 0.05;
 
         // How far the game time is behind the app time
         f64 game_lag_ms = 0.0;
 
+        GameLoopStats local_stats{};
+        GameLoopStats& stats = config.stats ? *config.stats : local_stats;
+        stats.time_scale = 1.0;
+
+        // Log overload at most once per second to avoid flooding the log while the game is struggling
+        TimePoint last_overload_log_time = Time::zero();
+
+        FramePacer frame_pacer{};
+
         // Use the duration of the last game loop cycle to increment game time lag
         TimePoint last_cycle_start_time = Time::now();
 
@@ -25,35 +44,138 @@ namespace Game {
             }
 
             last_cycle_start_time = cycle_start_time;
+            stats.frame_count++;
+
+            // When time dilation is enabled, scale the app time down to what the loop can actually simulate within
+            // its tick budget. The game then runs in slow motion while overloaded instead of skipping ahead.
+            if (config.time_dilation_enabled) {
+                f64 target_time_scale = std::clamp(max_ticks_ms / last_cycle_duration_ms, config.min_time_scale, 1.0);
+                if (target_time_scale < stats.time_scale) {
+                    stats.time_scale = target_time_scale;
+                } else {
+                    stats.time_scale += (target_time_scale - stats.time_scale) * time_scale_recovery_rate;
+                }
+                f64 scaled_cycle_duration_ms = last_cycle_duration_ms * stats.time_scale;
+                stats.dilated_time_ms += last_cycle_duration_ms - scaled_cycle_duration_ms;
+                last_cycle_duration_ms = scaled_cycle_duration_ms;
+            }
+
             game_lag_ms += last_cycle_duration_ms;
 
+            // Never let the lag build up beyond the limit, catching up on it would only stall the game further.
+            // Lag can also reach the limit over many frames that each stay within the tick budget, which the
+            // dilation above doesn't react to, so the time scale is lowered here as well.
+            if (game_lag_ms > config.max_lag_ms) {
+                f64 excess_lag_ms = game_lag_ms - config.max_lag_ms;
+                game_lag_ms = config.max_lag_ms;
+                if (config.time_dilation_enabled && stats.time_scale > config.min_time_scale) {
+                    stats.time_scale = std::max(stats.time_scale * config.max_lag_ms / (config.max_lag_ms + excess_lag_ms), config.min_time_scale);
+                    stats.dilated_time_ms += excess_lag_ms;
+                } else {
+                    stats.dropped_time_ms += excess_lag_ms;
+                }
+
+                if (Time::as<Seconds>(cycle_start_time - last_overload_log_time).count() >= 1.0) {
+                    GM_LOG_WARNING(
+                        "Game loop lag exceeded the [{:.1f} ms] limit by [{:.1f} ms], [{:.1f} ms] total dropped time, time scale [{:.2f}]",
+                        config.max_lag_ms,
+                        excess_lag_ms,
+                        stats.dropped_time_ms,
+                        stats.time_scale
+                    );
+                    last_overload_log_time = cycle_start_time;
+                }
+            }
+
             //
             // EVENTS
             //
 
             glfwPollEvents();
+            dispatch_queued_events(app.event_dispatcher);
+            update_file_loader(app.file_loader);
 
             if (glfwWindowShouldClose(app.window)) {
                 stop_app(app);
             }
 
+            TimePoint update_start_time = Time::now();
+
             //
             // UPDATE
             //
 
             // Update game time at fixed timesteps to have game systems update at a predictable rate.
             // Whenever the game time lags behind the app time by one-or-more timesteps, tick the game
-            // time forwards until it's caught up.
-            while (game_lag_ms >= timestep_ms) {
+            // time forwards until it's caught up, or until the tick budget for this frame is spent.
+            u32 tick_count = 0;
+            while (game_lag_ms >= timestep_ms && tick_count < config.max_ticks_per_frame) {
+
+                // Events are only timestamped when they are polled, which is after the app time that this frame's
+                // ticks simulate, so they can't be spread over the ticks by time. The first tick handles everything
+                // that was polled this frame, the other ticks only clear the per-tick input state. A frame without
+                // ticks leaves the input queued for the next one.
+                update_window_input(app.window, update_start_time);
+
                 config.on_update(app, timestep_sec);
                 game_lag_ms -= timestep_ms;
+                tick_count++;
+            }
+            stats.tick_count += tick_count;
+
+            // If the game is still behind after spending the tick budget, drop the remaining whole timesteps.
+            // Carrying them over to the next frame is what makes the game fall further behind every frame.
+            if (game_lag_ms >= timestep_ms) {
+                u64 dropped_tick_count = (u64) (game_lag_ms / timestep_ms);
+                f64 dropped_time_ms = dropped_tick_count * timestep_ms;
+                game_lag_ms -= dropped_time_ms;
+                stats.dropped_tick_count += dropped_tick_count;
+                stats.dropped_time_ms += dropped_time_ms;
+                stats.overloaded_frame_count++;
+
+                if (Time::as<Seconds>(cycle_start_time - last_overload_log_time).count() >= 1.0) {
+                    GM_LOG_WARNING(
+                        "Game loop is overloaded, dropped [{}] ticks this frame, [{:.1f} ms] total dropped time, time scale [{:.2f}]",
+                        dropped_tick_count,
+                        stats.dropped_time_ms,
+                        stats.time_scale
+                    );
+                    last_overload_log_time = cycle_start_time;
+                }
             }
 
             //
             // RENDER
             //
 
-            config.on_render(app);
+            TimePoint render_start_time = Time::now();
+
+            f64 alpha = std::clamp(game_lag_ms / timestep_ms, 0.0, 1.0);
+            config.on_render(app, alpha);
+
+            //
+            // PACING
+            //
+
+            TimePoint pacing_start_time = Time::now();
+
+            f64 frame_rate = config.max_frame_rate;
+            if (config.unfocused_frame_rate > 0.0 && !is_window_focused(app.window)) {
+                frame_rate = frame_rate > 0.0 ? std::min(frame_rate, config.unfocused_frame_rate) : config.unfocused_frame_rate;
+            }
+            if (frame_rate > 0.0) {
+                wait_for_next_frame(frame_pacer, 1000.0 / frame_rate);
+                stats.frame_pacer = frame_pacer.stats;
+            }
+
+            record_flight_frame({
+                .frame_index = stats.frame_count,
+                .tick_count = tick_count,
+                .events_duration = Time::as<Microseconds>(update_start_time - cycle_start_time),
+                .update_duration = Time::as<Microseconds>(render_start_time - update_start_time),
+                .render_duration = Time::as<Microseconds>(pacing_start_time - render_start_time),
+                .pacing_duration = Time::as<Microseconds>(Time::now() - pacing_start_time),
+            });
         }
     }
-}
\ No newline at end of file
+}
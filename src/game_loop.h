@@ -1,12 +1,52 @@
 #pragma once
 
 #include "app.h"
+#include "system/frame_pacer.h"
 
 namespace Game {
+    struct GameLoopStats {
+        u64 frame_count = 0;
+        u64 tick_count = 0;
+        u64 overloaded_frame_count = 0; // Frames where the game could not catch up within the tick budget
+        u64 dropped_tick_count = 0;
+        f64 dropped_time_ms = 0.0;      // Simulation time that was skipped to let the game catch up
+        f64 dilated_time_ms = 0.0;      // Simulation time that was slowed down instead of skipped
+        f64 time_scale = 1.0;           // Current rate of game time relative to app time
+        FramePacerStats frame_pacer{};
+    };
+
     struct GameLoopConfig {
         std::function<void(App& app, f64 timestep)> on_update;
-        std::function<void(App& app)> on_render;
+
+        // Alpha is how far the app time is between the last tick and the next one [0, 1), used to blend the
+        // state of the previous and current tick so that motion stays smooth when rendering faster than updating.
+        std::function<void(App& app, f64 alpha)> on_render;
+
+        // Number of fixed timestep updates per second.
+        f64 update_rate = 60.0;
+
+        // Frames per second to pace rendering to, 0 for unlimited. Presentation doesn't always block (mailbox
+        // present mode, minimized or occluded windows), without a limit the loop renders frames nobody sees.
+        f64 max_frame_rate = 0.0;
+
+        // Frames per second while the window is not focused, 0 for the same as when focused.
+        f64 unfocused_frame_rate = 15.0;
+
+        // Maximum number of updates per frame. When an update costs close to a full timestep, catching up on lag
+        // makes the next frame even slower, so the loop stops ticking after this many updates and drops the rest.
+        u32 max_ticks_per_frame = 5;
+
+        // Upper bound for how far the game time may lag behind the app time. The excess is dropped, or slows the game
+        // down when time dilation is enabled.
+        f64 max_lag_ms = 250.0;
+
+        // Slow down game time when overloaded, instead of dropping simulation time.
+        bool time_dilation_enabled = false;
+        f64 min_time_scale = 0.25;
+
+        // Optional output for the game loop counters.
+        GameLoopStats* stats = nullptr;
     };
 
     void run_game_loop(App& app, const GameLoopConfig& config);
-}
\ No newline at end of file
+}
@@ -0,0 +1,32 @@
+#include "embedded_shader.h"
+
+// Generated into the build directory by the ShaderEmbedder tool
+#include "embedded_shaders.h"
+
+namespace Game {
+    std::span<const EmbeddedShader> get_embedded_shaders() {
+        return embedded_shaders;
+    }
+
+    const EmbeddedShader& get_embedded_shader(std::string_view name) {
+        for (const EmbeddedShader& shader : embedded_shaders) {
+            if (shader.name == name) {
+                return shader;
+            }
+        }
+        GM_THROW("Could not find embedded shader [" << name << "]");
+    }
+
+    const EmbeddedShader& get_embedded_shader(u64 hash) {
+        for (const EmbeddedShader& shader : embedded_shaders) {
+            if (shader.hash == hash) {
+                return shader;
+            }
+        }
+        GM_THROW("Could not find embedded shader with hash [" << std::hex << hash << "]");
+    }
+
+    std::span<const u8> get_embedded_shader_bytes(const EmbeddedShader& shader) {
+        return {(const u8*) shader.code.data(), shader.code.size_bytes()};
+    }
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#include "system/numbers.h"
+
+#include <span>
+#include <string_view>
+
+// SPIR-V compiled into the executable by the ShaderEmbedder tool, so that shaders are loaded without any file I/O
+// and don't depend on the working directory. The generated arrays are aligned for the Vulkan loader.
+
+namespace Game {
+    struct EmbeddedShader {
+        std::string_view name;     // Source file name, e.g. "triangle.vert"
+        std::span<const u32> code; // SPIR-V
+        u64 hash = 0;              // FNV-1a of the code, identifies the shader in caches
+    };
+
+    std::span<const EmbeddedShader> get_embedded_shaders();
+
+    // Throws if there is no shader with the name.
+    const EmbeddedShader& get_embedded_shader(std::string_view name);
+
+    // Throws if there is no shader with the hash.
+    const EmbeddedShader& get_embedded_shader(u64 hash);
+
+    std::span<const u8> get_embedded_shader_bytes(const EmbeddedShader& shader);
+}
@@ -1,6 +1,11 @@
 #include "renderer.h"
 
+#include "embedded_shader.h"
+#include "vulkan_pipeline.h"
+#include "vulkan_shader_object.h"
 #include "vulkan_swap_chain.h"
+#include "system/binary_log.h"
+#include "system/flight_recorder.h"
 
 namespace Game {
     void wait_until_window_is_not_minimized(const Window& window) {
@@ -10,11 +15,18 @@ namespace Game {
         i32 height = 0;
         get_window_size(window, &width, &height);
 
+        if (!iconified && width != 0 && height != 0) {
+            return;
+        }
+
+        // No frames are rendered until the window is restored, which is not a stall
+        set_flight_recorder_watchdog_paused(true);
         while (iconified || width == 0 || height == 0) {
             iconified = is_window_iconified(window);
             get_window_size(window, &width, &height);
             glfwWaitEvents();
         }
+        set_flight_recorder_watchdog_paused(false);
     }
 
     void recreate_swap_chain(Vulkan& vulkan) {
@@ -27,7 +39,38 @@ namespace Game {
         });
     }
 
-    void record_command_buffer(Vulkan& vulkan, VkCommandBuffer command_buffer) {
+    // Dynamic rendering has no render pass to transition the swap chain image, so it is done with barriers instead
+    void transition_swap_chain_image(
+        const Vulkan& vulkan,
+        VkCommandBuffer command_buffer,
+        VkImageLayout old_layout,
+        VkImageLayout new_layout,
+        VkPipelineStageFlags source_stage,
+        VkAccessFlags source_access,
+        VkPipelineStageFlags destination_stage,
+        VkAccessFlags destination_access
+    ) {
+        VkImageMemoryBarrier image_memory_barrier{};
+        image_memory_barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+        image_memory_barrier.srcAccessMask = source_access;
+        image_memory_barrier.dstAccessMask = destination_access;
+        image_memory_barrier.oldLayout = old_layout;
+        image_memory_barrier.newLayout = new_layout;
+        image_memory_barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        image_memory_barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+        image_memory_barrier.image = vulkan.swap_chain_images[vulkan.swap_chain_current_image_index];
+        image_memory_barrier.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        image_memory_barrier.subresourceRange.baseMipLevel = 0;
+        image_memory_barrier.subresourceRange.levelCount = 1;
+        image_memory_barrier.subresourceRange.baseArrayLayer = 0;
+        image_memory_barrier.subresourceRange.layerCount = 1;
+
+        VkDependencyFlags dependency_flags = 0;
+        vkCmdPipelineBarrier(command_buffer, source_stage, destination_stage, dependency_flags, 0, nullptr, 0, nullptr, 1, &image_memory_barrier);
+    }
+
+    // Returns true if anything was drawn, false if the frame was only cleared
+    bool record_command_buffer(Vulkan& vulkan, VkCommandBuffer command_buffer, const PipelineState& pipeline_state, const std::vector<Transform>& transforms) {
         VkCommandBufferBeginInfo command_buffer_begin_info{};
         command_buffer_begin_info.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
         command_buffer_begin_info.flags = 0;
@@ -49,28 +92,89 @@ namespace Game {
             .color = clear_color_value
         };
 
-        VkRenderPassBeginInfo render_pass_begin_info{};
-        render_pass_begin_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-        render_pass_begin_info.renderPass = vulkan.swap_chain_render_pass;
-        render_pass_begin_info.framebuffer = vulkan.swap_chain_framebuffers[vulkan.swap_chain_current_image_index];
-        render_pass_begin_info.renderArea.offset = {0, 0};
-        render_pass_begin_info.renderArea.extent = vulkan.swap_chain_extent;
-        render_pass_begin_info.clearValueCount = 1;
-        render_pass_begin_info.pClearValues = &clear_color;
-
-        insert_cmd_debug_label(vulkan.device, command_buffer, VkDebugUtilsLabelEXT{
-            .sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_LABEL_EXT,
-            .pLabelName = "Begin render pass",
-        });
-
-        vkCmdBeginRenderPass(command_buffer, &render_pass_begin_info, VK_SUBPASS_CONTENTS_INLINE);
-
-        insert_cmd_debug_label(vulkan.device, command_buffer, VkDebugUtilsLabelEXT{
-            .sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_LABEL_EXT,
-            .pLabelName = "Bind pipeline",
-        });
+        // Shader objects can only be drawn with dynamic rendering
+        bool shader_objects_used = vulkan.physical_device_optional_features.shader_object;
+
+        if (shader_objects_used) {
+            // Waits for the same stage as the submit waits for the image to be available
+            transition_swap_chain_image(
+                vulkan,
+                command_buffer,
+                VK_IMAGE_LAYOUT_UNDEFINED,
+                VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                VK_ACCESS_NONE,
+                VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT
+            );
+
+            VkRenderingAttachmentInfo color_attachment_info{};
+            color_attachment_info.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
+            color_attachment_info.imageView = vulkan.swap_chain_image_views[vulkan.swap_chain_current_image_index];
+            color_attachment_info.imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+            color_attachment_info.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+            color_attachment_info.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+            color_attachment_info.clearValue = clear_color;
+
+            VkRenderingInfo rendering_info{};
+            rendering_info.sType = VK_STRUCTURE_TYPE_RENDERING_INFO;
+            rendering_info.renderArea.offset = {0, 0};
+            rendering_info.renderArea.extent = vulkan.swap_chain_extent;
+            rendering_info.layerCount = 1;
+            rendering_info.colorAttachmentCount = 1;
+            rendering_info.pColorAttachments = &color_attachment_info;
+
+            insert_cmd_debug_label(vulkan.device, command_buffer, VkDebugUtilsLabelEXT{
+                .sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_LABEL_EXT,
+                .pLabelName = "Begin rendering",
+            });
+
+            vkCmdBeginRendering(command_buffer, &rendering_info);
+        } else {
+            VkRenderPassBeginInfo render_pass_begin_info{};
+            render_pass_begin_info.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+            render_pass_begin_info.renderPass = vulkan.swap_chain_render_pass;
+            render_pass_begin_info.framebuffer = vulkan.swap_chain_framebuffers[vulkan.swap_chain_current_image_index];
+            render_pass_begin_info.renderArea.offset = {0, 0};
+            render_pass_begin_info.renderArea.extent = vulkan.swap_chain_extent;
+            render_pass_begin_info.clearValueCount = 1;
+            render_pass_begin_info.pClearValues = &clear_color;
+
+            insert_cmd_debug_label(vulkan.device, command_buffer, VkDebugUtilsLabelEXT{
+                .sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_LABEL_EXT,
+                .pLabelName = "Begin render pass",
+            });
+
+            vkCmdBeginRenderPass(command_buffer, &render_pass_begin_info, VK_SUBPASS_CONTENTS_INLINE);
+        }
 
-        vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, vulkan.pipeline);
+        // Null until the pipeline has been compiled, or if the shader objects could not be created. There is nothing
+        // else to fall back to, so the frame is only cleared.
+        VkPipelineLayout layout = nullptr;
+        if (shader_objects_used) {
+            insert_cmd_debug_label(vulkan.device, command_buffer, VkDebugUtilsLabelEXT{
+                .sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_LABEL_EXT,
+                .pLabelName = "Bind shader objects",
+            });
+
+            const VulkanShaderObjects* shader_objects = get_vulkan_shader_objects(vulkan, pipeline_state.vertex_shader, pipeline_state.fragment_shader);
+            if (shader_objects != nullptr) {
+                bind_vulkan_shader_objects(vulkan, command_buffer, *shader_objects, pipeline_state);
+                layout = shader_objects->layout;
+            }
+        } else {
+            insert_cmd_debug_label(vulkan.device, command_buffer, VkDebugUtilsLabelEXT{
+                .sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_LABEL_EXT,
+                .pLabelName = "Bind pipeline",
+            });
+
+            const VulkanPipeline* pipeline = get_vulkan_pipeline(vulkan, pipeline_state);
+            if (pipeline != nullptr) {
+                vkCmdBindPipeline(command_buffer, VK_PIPELINE_BIND_POINT_GRAPHICS, pipeline->handle);
+                set_vulkan_pipeline_dynamic_state(vulkan, command_buffer, pipeline_state);
+                layout = pipeline->layout;
+            }
+        }
 
         VkViewport viewport{};
         viewport.x = 0.0f;
@@ -87,7 +191,11 @@ namespace Game {
 
         u32 first_viewport = 0;
         u32 viewport_count = 1;
-        vkCmdSetViewport(command_buffer, first_viewport, viewport_count, &viewport);
+        if (shader_objects_used) {
+            vkCmdSetViewportWithCount(command_buffer, viewport_count, &viewport);
+        } else {
+            vkCmdSetViewport(command_buffer, first_viewport, viewport_count, &viewport);
+        }
 
         VkRect2D scissor{};
         scissor.offset = {0, 0};
@@ -100,7 +208,11 @@ namespace Game {
 
         u32 first_scissor = 0;
         u32 scissor_count = 1;
-        vkCmdSetScissor(command_buffer, first_scissor, scissor_count, &scissor);
+        if (shader_objects_used) {
+            vkCmdSetScissorWithCount(command_buffer, scissor_count, &scissor);
+        } else {
+            vkCmdSetScissor(command_buffer, first_scissor, scissor_count, &scissor);
+        }
 
         insert_cmd_debug_label(vulkan.device, command_buffer, VkDebugUtilsLabelEXT{
             .sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_LABEL_EXT,
@@ -111,23 +223,50 @@ namespace Game {
         u32 instance_count = 1; // Used for instanced rendering, use 1 if you're not doing that.
         u32 first_vertex = 0; // Used as an offset into the vertex buffer, defines the lowest value of gl_VertexIndex.
         u32 first_instance = 0; // Used as an offset for instanced rendering, defines the lowest value of gl_InstanceIndex.
-        vkCmdDraw(command_buffer, vertex_count, instance_count, first_vertex, first_instance);
-
-        insert_cmd_debug_label(vulkan.device, command_buffer, VkDebugUtilsLabelEXT{
-            .sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_LABEL_EXT,
-            .pLabelName = "End render pass",
-        });
+        if (layout != nullptr) {
+            for (const Transform& transform : transforms) {
+                u32 push_constant_offset = 0;
+                vkCmdPushConstants(command_buffer, layout, VK_SHADER_STAGE_VERTEX_BIT, push_constant_offset, sizeof(Transform), &transform);
+                vkCmdDraw(command_buffer, vertex_count, instance_count, first_vertex, first_instance);
+            }
+        }
 
-        vkCmdEndRenderPass(command_buffer);
+        if (shader_objects_used) {
+            insert_cmd_debug_label(vulkan.device, command_buffer, VkDebugUtilsLabelEXT{
+                .sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_LABEL_EXT,
+                .pLabelName = "End rendering",
+            });
+
+            vkCmdEndRendering(command_buffer);
+
+            transition_swap_chain_image(
+                vulkan,
+                command_buffer,
+                VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL,
+                VK_IMAGE_LAYOUT_PRESENT_SRC_KHR,
+                VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+                VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT,
+                VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+                VK_ACCESS_NONE
+            );
+        } else {
+            insert_cmd_debug_label(vulkan.device, command_buffer, VkDebugUtilsLabelEXT{
+                .sType = VK_STRUCTURE_TYPE_DEBUG_UTILS_LABEL_EXT,
+                .pLabelName = "End render pass",
+            });
+
+            vkCmdEndRenderPass(command_buffer);
+        }
 
         end_cmd_debug_label(vulkan.device, command_buffer);
 
         if (vkEndCommandBuffer(command_buffer) != VK_SUCCESS) {
             GM_THROW("Could not end command buffer");
         }
+        return layout != nullptr && !transforms.empty();
     }
 
-    void render_frame(Renderer& renderer) {
+    bool render_frame(Renderer& renderer) {
         Vulkan& vulkan = renderer.vulkan;
 
         VkCommandBuffer command_buffer = vulkan.command_buffers[renderer.current_frame];
@@ -142,10 +281,16 @@ namespace Game {
         u32 fence_count = 1;
         VkBool32 wait_for_all_fences = VK_TRUE;
         u64 wait_for_fences_timeout = UINT64_MAX; // Wait forever until the fence is signaled.
-        if (vkWaitForFences(vulkan.device, fence_count, &in_flight_fence, wait_for_all_fences, wait_for_fences_timeout) != VK_SUCCESS) {
+        VkResult wait_for_fences_result = vkWaitForFences(vulkan.device, fence_count, &in_flight_fence, wait_for_all_fences, wait_for_fences_timeout);
+        record_flight_vulkan_result("vkWaitForFences", wait_for_fences_result);
+        if (wait_for_fences_result != VK_SUCCESS) {
             GM_THROW("Could not wait for 'in flight' fence for frame [" << renderer.current_frame << "]");
         }
 
+        // The frame boundary, where optimized pipelines and pipelines rebuilt from changed shaders can be swapped in
+        update_vulkan_pipelines(vulkan);
+        update_shader_hot_reload(renderer.shader_hot_reload, vulkan);
+
         //
         // Acquire an image from the swap chain to use for the current frame.
         //
@@ -160,10 +305,11 @@ namespace Game {
             image_available_fence,
             &vulkan.swap_chain_current_image_index
         );
+        record_flight_vulkan_result("vkAcquireNextImageKHR", next_image_result);
         // VK_ERROR_OUT_OF_DATE_KHR: The swap chain has become incompatible with the surface and can no longer be used for rendering.
         if (next_image_result == VK_ERROR_OUT_OF_DATE_KHR) {
             recreate_swap_chain(vulkan);
-            return;
+            return false;
         }
         // VK_SUBOPTIMAL_KHR: The swap chain can still be used to successfully present to the surface, but the surface properties are no longer matched exactly.
         if (next_image_result != VK_SUCCESS && next_image_result != VK_SUBOPTIMAL_KHR) {
@@ -184,7 +330,8 @@ namespace Game {
         VkCommandBufferResetFlags command_buffer_reset_flags = 0;
         vkResetCommandBuffer(command_buffer, command_buffer_reset_flags);
 
-        record_command_buffer(renderer.vulkan, command_buffer);
+        GM_BINARY_LOG_TRACE("Recording frame [{}] into swap chain image [{}] with [{}] draws", renderer.current_frame, vulkan.swap_chain_current_image_index, renderer.transforms.size());
+        bool drew = record_command_buffer(renderer.vulkan, command_buffer, renderer.triangle_pipeline_state, renderer.transforms);
 
         //
         // Submit the rendering commands to the graphics queue to perform the rendering.
@@ -217,7 +364,9 @@ namespace Game {
         });
 
         u32 submit_count = 1;
-        if (vkQueueSubmit(vulkan.graphics_queue, submit_count, &submit_info, in_flight_fence) != VK_SUCCESS) {
+        VkResult submit_result = vkQueueSubmit(vulkan.graphics_queue, submit_count, &submit_info, in_flight_fence);
+        record_flight_vulkan_result("vkQueueSubmit", submit_result);
+        if (submit_result != VK_SUCCESS) {
             GM_THROW("Could not submit render commands to graphics queue");
         }
 
@@ -247,6 +396,7 @@ namespace Game {
         });
 
         VkResult present_result = vkQueuePresentKHR(vulkan.present_queue, &present_info);
+        record_flight_vulkan_result("vkQueuePresentKHR", present_result);
 
         // VK_ERROR_OUT_OF_DATE_KHR: The swap chain has become incompatible with the surface and can no longer be used for rendering.
         // VK_SUBOPTIMAL_KHR: The swap chain can still be used to successfully present to the surface, but the surface properties are no longer matched exactly.
@@ -260,6 +410,7 @@ namespace Game {
         end_queue_debug_label(vulkan.device, vulkan.present_queue);
 
         renderer.current_frame = (renderer.current_frame + 1) % renderer.max_frames_in_flight;
+        return drew;
     }
 
     bool handle_renderer_event(Renderer& renderer, const Event& event) {
@@ -279,11 +430,43 @@ namespace Game {
             .engine_name = std::format("{} Engine", config.app_name),
             .validation_layers_enabled = config.debug_enabled,
             .max_frames_in_flight = config.max_frames_in_flight,
+            // Hot reload swaps in rebuilt pipelines, which shader objects would draw past
+            .shader_object_enabled = !config.shader_hot_reload_enabled,
+            .pipeline_cache_path = config.pipeline_cache_path,
+            .physical_device_uuid = config.physical_device_uuid,
+            .physical_device_cache_path = config.physical_device_cache_path,
         });
+
+        renderer.triangle_pipeline_state = {
+            .vertex_shader = get_embedded_shader("triangle.vert").hash,
+            .fragment_shader = get_embedded_shader("triangle.frag").hash,
+            .color_format = renderer.vulkan.swap_chain_surface_format.format,
+        };
+        // Starts compiling while the rest of the app is created, instead of on the first frame
+        if (!renderer.vulkan.physical_device_optional_features.shader_object) {
+            get_vulkan_pipeline(renderer.vulkan, renderer.triangle_pipeline_state);
+        }
+
+        if (config.shader_hot_reload_enabled) {
+            if (std::filesystem::is_directory(config.shaders_source_directory)) {
+                create_shader_hot_reload(renderer.shader_hot_reload, renderer.vulkan, *config.file_loader, {
+                    .source_directory = config.shaders_source_directory,
+                    .vertex_shader_file = "triangle.vert",
+                    .fragment_shader_file = "triangle.frag",
+                    .pipeline = {
+                        .name = "TrianglePipeline",
+                        .state = renderer.triangle_pipeline_state,
+                    },
+                });
+            } else {
+                GM_LOG_WARNING("Could not find shader sources in [{}], shader hot reload is disabled", config.shaders_source_directory.string());
+            }
+        }
     }
 
-    void destroy_renderer(const Renderer& renderer) {
+    void destroy_renderer(Renderer& renderer) {
         vkDeviceWaitIdle(renderer.vulkan.device);
+        destroy_shader_hot_reload(renderer.shader_hot_reload);
         destroy_vulkan(renderer.vulkan);
     }
 }
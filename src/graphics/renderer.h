@@ -1,28 +1,40 @@
 #pragma once
 
+#include "graphics/shader_hot_reload.h"
 #include "graphics/vulkan.h"
 #include "window/window.h"
+#include "world/transform.h"
 
 namespace Game {
     struct RendererConfig {
         Window* window = nullptr;
+        FileLoader* file_loader = nullptr; // Reads the compiled shaders for shader hot reload
         std::string app_name = "";
         bool debug_enabled = false;
         u32 max_frames_in_flight = 0;
+        bool shader_hot_reload_enabled = false;
+        std::filesystem::path shaders_source_directory;
+        std::filesystem::path pipeline_cache_path;
+        std::string physical_device_uuid;
+        std::filesystem::path physical_device_cache_path;
     };
 
     struct Renderer {
         Vulkan vulkan{};
+        ShaderHotReload shader_hot_reload{};
+        PipelineState triangle_pipeline_state{};
         u32 current_frame = 0;
         u32 max_frames_in_flight = 0;
         bool framebuffer_resized = false;
+        std::vector<Transform> transforms; // Transforms of the triangles to draw in the next frame
     };
 
     void create_renderer(Renderer& renderer, const RendererConfig& config);
 
-    void destroy_renderer(const Renderer& renderer);
+    void destroy_renderer(Renderer& renderer);
 
     bool handle_renderer_event(Renderer& renderer, const Event& event);
 
-    void render_frame(Renderer& renderer);
+    // Returns true if the submitted frame drew anything. Until the pipeline has been compiled, frames are only cleared.
+    bool render_frame(Renderer& renderer);
 }
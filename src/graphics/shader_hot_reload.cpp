@@ -0,0 +1,170 @@
+#include "shader_hot_reload.h"
+
+#include "system/time.h"
+
+#include <cstdio>
+
+#if defined(GM_PLATFORM_WINDOWS)
+    #include <process.h>
+    #define popen _popen
+    #define pclose _pclose
+    #define getpid _getpid
+#else
+    #include <unistd.h>
+#endif
+
+namespace Game {
+    // The output is named after the process and the rebuild, so that other running instances and the loads of an
+    // earlier rebuild never read a file that is being written
+    std::filesystem::path compile_shader(const ShaderHotReload& hot_reload, const std::string& source_file) {
+        std::filesystem::path source_path = hot_reload.config.source_directory / source_file;
+        std::string output_file = std::format("hot_reload_{}_{}_{}.spv", (i64) getpid(), hot_reload.rebuild_count, source_file);
+        std::filesystem::path output_path = std::filesystem::temp_directory_path() / output_file;
+        std::string command = std::format("\"{}\" -o \"{}\" \"{}\" 2>&1", hot_reload.config.compiler, output_path.string(), source_path.string());
+
+        FILE* process = popen(command.c_str(), "r");
+        if (process == nullptr) {
+            GM_THROW("Could not run shader compiler [" << hot_reload.config.compiler << "]");
+        }
+        std::string output;
+        char buffer[256];
+        while (std::fgets(buffer, sizeof(buffer), process) != nullptr) {
+            output += buffer;
+        }
+        if (pclose(process) != 0) {
+            GM_THROW("Could not compile shader [" << source_path << "]:\n" << output);
+        }
+        return output_path;
+    }
+
+    // The compiled shaders of one rebuild, filled in as their loads are processed
+    struct ShaderRebuild {
+        TimePoint start_time{};
+        std::vector<u8> vertex_shader_code;
+        std::vector<u8> fragment_shader_code;
+        std::atomic<u32> loaded_count = 0;
+    };
+
+    void create_rebuilt_pipeline(ShaderHotReload& hot_reload, const ShaderRebuild& rebuild) {
+        const ShaderHotReloadConfig& config = hot_reload.config;
+
+        PipelineConfig pipeline_config = config.pipeline;
+        pipeline_config.vertex_shader_code = rebuild.vertex_shader_code;
+        pipeline_config.fragment_shader_code = rebuild.fragment_shader_code;
+
+        VulkanPipeline pipeline{};
+        try {
+            create_vulkan_pipeline(*hot_reload.vulkan, pipeline, pipeline_config);
+        } catch (const Error&) {
+            destroy_vulkan_pipeline(*hot_reload.vulkan, pipeline);
+            throw;
+        }
+
+        {
+            std::lock_guard lock(hot_reload.mutex);
+            // A pipeline that was rebuilt but never swapped in has never been used by a frame
+            if (hot_reload.rebuilt_pipeline.handle != nullptr) {
+                destroy_vulkan_pipeline(*hot_reload.vulkan, hot_reload.rebuilt_pipeline);
+            }
+            hot_reload.rebuilt_pipeline = pipeline;
+        }
+
+        Milliseconds duration = Time::as<Milliseconds>(Time::now() - rebuild.start_time);
+        GM_LOG_INFO("Rebuilt [{}] in [{:.1f}] ms", config.pipeline.name, duration.count());
+    }
+
+    void load_compiled_shader(ShaderHotReload& hot_reload, const std::shared_ptr<ShaderRebuild>& rebuild, const std::filesystem::path& path, std::vector<u8> ShaderRebuild::* code) {
+        auto remove_compiled_shader = [](FileLoad& load) {
+            std::error_code error;
+            std::filesystem::remove(load.path, error);
+        };
+        load_file(*hot_reload.file_loader, path, remove_compiled_shader, [&hot_reload, rebuild, code](FileLoad& load) {
+            (*rebuild).*code = std::move(load.bytes);
+
+            // The load that is processed last creates the pipeline. If either load fails, the pipeline is not rebuilt.
+            if (rebuild->loaded_count.fetch_add(1, std::memory_order_acq_rel) == 0) {
+                return;
+            }
+            try {
+                create_rebuilt_pipeline(hot_reload, *rebuild);
+            } catch (const std::exception& e) {
+                GM_LOG_ERROR("Could not rebuild [{}]: {}", hot_reload.config.pipeline.name, e.what());
+            }
+        });
+    }
+
+    void rebuild_pipeline(ShaderHotReload& hot_reload, const std::vector<std::filesystem::path>& changed_paths) {
+        const ShaderHotReloadConfig& config = hot_reload.config;
+        bool shader_changed = std::any_of(changed_paths.begin(), changed_paths.end(), [&config](const std::filesystem::path& path) {
+            return path.filename() == config.vertex_shader_file || path.filename() == config.fragment_shader_file;
+        });
+        if (!shader_changed) {
+            return;
+        }
+
+        auto rebuild = std::make_shared<ShaderRebuild>();
+        rebuild->start_time = Time::now();
+        hot_reload.rebuild_count++;
+
+        // Both stages are compiled every time, so the pipeline never mixes a stale stage with a new one
+        std::filesystem::path vertex_shader_path = compile_shader(hot_reload, config.vertex_shader_file);
+        std::filesystem::path fragment_shader_path;
+        try {
+            fragment_shader_path = compile_shader(hot_reload, config.fragment_shader_file);
+        } catch (const Error&) {
+            std::error_code error;
+            std::filesystem::remove(vertex_shader_path, error);
+            throw;
+        }
+        load_compiled_shader(hot_reload, rebuild, vertex_shader_path, &ShaderRebuild::vertex_shader_code);
+        load_compiled_shader(hot_reload, rebuild, fragment_shader_path, &ShaderRebuild::fragment_shader_code);
+    }
+
+    void create_shader_hot_reload(ShaderHotReload& hot_reload, const Vulkan& vulkan, FileLoader& file_loader, const ShaderHotReloadConfig& config) {
+        hot_reload.config = config;
+        hot_reload.vulkan = &vulkan;
+        hot_reload.file_loader = &file_loader;
+        create_file_watcher(hot_reload.watcher, {
+            .directory = config.source_directory,
+        }, [&hot_reload](const std::vector<std::filesystem::path>& changed_paths) {
+            // The current pipeline stays in use until the shaders compile again
+            try {
+                rebuild_pipeline(hot_reload, changed_paths);
+            } catch (const std::exception& e) {
+                GM_LOG_ERROR("Could not rebuild [{}]: {}", hot_reload.config.pipeline.name, e.what());
+            }
+        });
+        hot_reload.enabled = true;
+    }
+
+    void destroy_shader_hot_reload(ShaderHotReload& hot_reload) {
+        if (!hot_reload.enabled) {
+            return;
+        }
+        destroy_file_watcher(hot_reload.watcher);
+        // The last load of a rebuild creates the pipeline
+        wait_for_file_loads(*hot_reload.file_loader);
+        if (hot_reload.rebuilt_pipeline.handle != nullptr) {
+            destroy_vulkan_pipeline(*hot_reload.vulkan, hot_reload.rebuilt_pipeline);
+            hot_reload.rebuilt_pipeline = {};
+        }
+        hot_reload.enabled = false;
+    }
+
+    void update_shader_hot_reload(ShaderHotReload& hot_reload, Vulkan& vulkan) {
+        if (!hot_reload.enabled) {
+            return;
+        }
+
+        // Never blocks on a rebuild in progress, the swap is picked up by a later frame instead
+        std::unique_lock lock(hot_reload.mutex, std::try_to_lock);
+        if (!lock.owns_lock() || hot_reload.rebuilt_pipeline.handle == nullptr) {
+            return;
+        }
+        if (!replace_vulkan_pipeline(vulkan, hot_reload.config.pipeline.state, hot_reload.rebuilt_pipeline)) {
+            return; // The first compile of the pipeline is still in progress
+        }
+        hot_reload.rebuilt_pipeline = {};
+        GM_LOG_INFO("Swapped in rebuilt [{}]", hot_reload.config.pipeline.name);
+    }
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "graphics/vulkan_pipeline.h"
+#include "system/file_loader.h"
+#include "system/file_watcher.h"
+
+// Rebuilds a pipeline when its shader sources change, without stalling the frame loop. The watcher thread compiles
+// the sources to SPIR-V, the file loader reads them and the new pipeline is created on the job system worker that
+// processes the last of them, and the renderer swaps it in at the start of the next frame. The old pipeline is
+// destroyed once no frame in flight can still be using it.
+
+namespace Game {
+    struct ShaderHotReloadConfig {
+        std::filesystem::path source_directory;
+        std::string compiler = "glslc";
+        std::string vertex_shader_file;   // Source file name in the source directory
+        std::string fragment_shader_file; // Source file name in the source directory
+        // Without code, the compiled shaders are filled in for every rebuild. The rebuilt pipeline takes the place of
+        // the cached pipeline with the same state.
+        PipelineConfig pipeline{};
+    };
+
+    struct ShaderHotReload {
+        ShaderHotReloadConfig config{};
+        const Vulkan* vulkan = nullptr;
+        FileLoader* file_loader = nullptr;
+        FileWatcher watcher{};
+        u32 rebuild_count = 0; // Only used by the watcher thread
+        bool enabled = false;
+
+        // Guards the rebuilt pipeline
+        std::mutex mutex;
+        VulkanPipeline rebuilt_pipeline{}; // Waiting to be swapped in, if the handle is set
+    };
+
+    void create_shader_hot_reload(ShaderHotReload& hot_reload, const Vulkan& vulkan, FileLoader& file_loader, const ShaderHotReloadConfig& config);
+
+    // Call from the main thread when the device is idle. Waits for the shaders that are being loaded.
+    void destroy_shader_hot_reload(ShaderHotReload& hot_reload);
+
+    // Swaps in a rebuilt pipeline, the pipeline state cache destroys the one it replaces once it is no longer in flight.
+    // Call at the start of every frame, after waiting for the frame's fence.
+    void update_shader_hot_reload(ShaderHotReload& hot_reload, Vulkan& vulkan);
+}
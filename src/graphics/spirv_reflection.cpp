@@ -0,0 +1,390 @@
+#include "spirv_reflection.h"
+
+namespace Game {
+    // Opcodes, enums and decorations from the SPIR-V specification, only the ones that are needed for reflection
+    constexpr u32 spirv_magic = 0x07230203;
+    constexpr u32 spirv_header_word_count = 5;
+    constexpr u32 spirv_no_value = ~0u;
+
+    constexpr u32 spirv_op_entry_point = 15;
+    constexpr u32 spirv_op_type_bool = 20;
+    constexpr u32 spirv_op_type_int = 21;
+    constexpr u32 spirv_op_type_float = 22;
+    constexpr u32 spirv_op_type_vector = 23;
+    constexpr u32 spirv_op_type_matrix = 24;
+    constexpr u32 spirv_op_type_image = 25;
+    constexpr u32 spirv_op_type_sampler = 26;
+    constexpr u32 spirv_op_type_sampled_image = 27;
+    constexpr u32 spirv_op_type_array = 28;
+    constexpr u32 spirv_op_type_runtime_array = 29;
+    constexpr u32 spirv_op_type_struct = 30;
+    constexpr u32 spirv_op_type_pointer = 32;
+    constexpr u32 spirv_op_constant = 43;
+    constexpr u32 spirv_op_spec_constant = 50;
+    constexpr u32 spirv_op_variable = 59;
+    constexpr u32 spirv_op_decorate = 71;
+    constexpr u32 spirv_op_member_decorate = 72;
+    constexpr u32 spirv_op_type_acceleration_structure = 5341;
+
+    constexpr u32 spirv_execution_model_vertex = 0;
+    constexpr u32 spirv_execution_model_tessellation_control = 1;
+    constexpr u32 spirv_execution_model_tessellation_evaluation = 2;
+    constexpr u32 spirv_execution_model_geometry = 3;
+    constexpr u32 spirv_execution_model_fragment = 4;
+    constexpr u32 spirv_execution_model_gl_compute = 5;
+
+    constexpr u32 spirv_storage_class_uniform_constant = 0;
+    constexpr u32 spirv_storage_class_input = 1;
+    constexpr u32 spirv_storage_class_uniform = 2;
+    constexpr u32 spirv_storage_class_push_constant = 9;
+    constexpr u32 spirv_storage_class_storage_buffer = 12;
+
+    constexpr u32 spirv_decoration_block = 2;
+    constexpr u32 spirv_decoration_buffer_block = 3;
+    constexpr u32 spirv_decoration_array_stride = 6;
+    constexpr u32 spirv_decoration_matrix_stride = 7;
+    constexpr u32 spirv_decoration_built_in = 11;
+    constexpr u32 spirv_decoration_location = 30;
+    constexpr u32 spirv_decoration_binding = 33;
+    constexpr u32 spirv_decoration_descriptor_set = 34;
+    constexpr u32 spirv_decoration_offset = 35;
+
+    constexpr u32 spirv_dim_buffer = 5;
+    constexpr u32 spirv_dim_subpass_data = 6;
+
+    // What an id is declared as, and how it is decorated
+    struct SpirvId {
+        u32 opcode = 0;
+        u32 instruction = 0; // Index of the first word of the declaring instruction
+        u32 set = spirv_no_value;
+        u32 binding = spirv_no_value;
+        u32 location = spirv_no_value;
+        u32 array_stride = 0;
+        bool built_in = false;
+        bool block = false;
+        bool buffer_block = false;
+        std::vector<u32> member_offsets;
+        std::vector<u32> member_matrix_strides;
+    };
+
+    struct SpirvModule {
+        std::span<const u32> words;
+        std::vector<SpirvId> ids;
+    };
+
+    // Operand 0 is the result id. Shaders are reflected at runtime when they are hot reloaded, so a malformed
+    // instruction must not read into the next one.
+    u32 get_operand(const SpirvModule& module, u32 id, u32 operand_index) {
+        u32 instruction = module.ids[id].instruction;
+        u32 word_count = module.words[instruction] >> 16;
+        if (operand_index + 1 >= word_count) {
+            GM_THROW("SPIR-V id [" << id << "] has no operand [" << operand_index << "], its instruction has [" << word_count << "] words");
+        }
+        return module.words[instruction + 1 + operand_index];
+    }
+
+    const SpirvId& get_id(const SpirvModule& module, u32 id) {
+        if (id >= module.ids.size() || module.ids[id].opcode == 0) {
+            GM_THROW("SPIR-V id [" << id << "] is not declared");
+        }
+        return module.ids[id];
+    }
+
+    u32 get_constant_value(const SpirvModule& module, u32 constant_id) {
+        const SpirvId& constant = get_id(module, constant_id);
+        if (constant.opcode != spirv_op_constant && constant.opcode != spirv_op_spec_constant) {
+            GM_THROW("SPIR-V id [" << constant_id << "] is not a constant");
+        }
+        return get_operand(module, constant_id, 2);
+    }
+
+    u32 get_type_size(const SpirvModule& module, u32 type_id, u32 matrix_stride = 0) {
+        const SpirvId& type = get_id(module, type_id);
+        switch (type.opcode) {
+            case spirv_op_type_int:
+            case spirv_op_type_float:
+                return get_operand(module, type_id, 1) / 8;
+            case spirv_op_type_vector:
+                return get_operand(module, type_id, 2) * get_type_size(module, get_operand(module, type_id, 1));
+            case spirv_op_type_matrix: {
+                u32 column_size = matrix_stride > 0 ? matrix_stride : get_type_size(module, get_operand(module, type_id, 1));
+                return get_operand(module, type_id, 2) * column_size;
+            }
+            case spirv_op_type_array: {
+                u32 element_size = type.array_stride > 0 ? type.array_stride : get_type_size(module, get_operand(module, type_id, 1));
+                return get_constant_value(module, get_operand(module, type_id, 2)) * element_size;
+            }
+            case spirv_op_type_runtime_array:
+                return 0;
+            case spirv_op_type_struct: {
+                u32 member_count = (module.words[type.instruction] >> 16) - 2; // After the opcode and the result id
+                if (type.member_offsets.size() < member_count) {
+                    GM_THROW("SPIR-V struct [" << type_id << "] has members without an offset");
+                }
+                u32 size = 0;
+                for (u32 member = 0; member < member_count; ++member) {
+                    u32 member_matrix_stride = member < type.member_matrix_strides.size() ? type.member_matrix_strides[member] : 0;
+                    u32 member_size = get_type_size(module, get_operand(module, type_id, 1 + member), member_matrix_stride);
+                    size = std::max(size, type.member_offsets[member] + member_size);
+                }
+                return size;
+            }
+            default:
+                GM_THROW("Could not get the size of SPIR-V type [" << type_id << "] with opcode [" << type.opcode << "]");
+        }
+    }
+
+    VkShaderStageFlagBits get_shader_stage(u32 execution_model) {
+        switch (execution_model) {
+            case spirv_execution_model_vertex:
+                return VK_SHADER_STAGE_VERTEX_BIT;
+            case spirv_execution_model_tessellation_control:
+                return VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT;
+            case spirv_execution_model_tessellation_evaluation:
+                return VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT;
+            case spirv_execution_model_geometry:
+                return VK_SHADER_STAGE_GEOMETRY_BIT;
+            case spirv_execution_model_fragment:
+                return VK_SHADER_STAGE_FRAGMENT_BIT;
+            case spirv_execution_model_gl_compute:
+                return VK_SHADER_STAGE_COMPUTE_BIT;
+            default:
+                GM_THROW("Unsupported SPIR-V execution model [" << execution_model << "]");
+        }
+    }
+
+    VkDescriptorType get_descriptor_type(const SpirvModule& module, u32 type_id, u32 storage_class) {
+        const SpirvId& type = get_id(module, type_id);
+        switch (type.opcode) {
+            case spirv_op_type_struct:
+                if (storage_class == spirv_storage_class_storage_buffer || type.buffer_block) {
+                    return VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+                }
+                if (type.block) {
+                    return VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+                }
+                break;
+            case spirv_op_type_sampler:
+                return VK_DESCRIPTOR_TYPE_SAMPLER;
+            case spirv_op_type_sampled_image:
+                return VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+            case spirv_op_type_image: {
+                u32 dim = get_operand(module, type_id, 2);
+                bool sampled = get_operand(module, type_id, 6) == 1; // 2 means that it is used without a sampler
+                if (dim == spirv_dim_subpass_data) {
+                    return VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT;
+                }
+                if (dim == spirv_dim_buffer) {
+                    return sampled ? VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER : VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER;
+                }
+                return sampled ? VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE : VK_DESCRIPTOR_TYPE_STORAGE_IMAGE;
+            }
+            case spirv_op_type_acceleration_structure:
+                return VK_DESCRIPTOR_TYPE_ACCELERATION_STRUCTURE_KHR;
+            default:
+                break;
+        }
+        GM_THROW("Could not get the descriptor type of SPIR-V type [" << type_id << "] with opcode [" << type.opcode << "]");
+    }
+
+    VkFormat get_vertex_input_format(const SpirvModule& module, u32 type_id) {
+        const SpirvId& type = get_id(module, type_id);
+        u32 component_count = 1;
+        u32 component_type_id = type_id;
+        if (type.opcode == spirv_op_type_vector) {
+            component_count = get_operand(module, type_id, 2);
+            component_type_id = get_operand(module, type_id, 1);
+        }
+        const SpirvId& component_type = get_id(module, component_type_id);
+        if ((component_type.opcode != spirv_op_type_float && component_type.opcode != spirv_op_type_int) || get_operand(module, component_type_id, 1) != 32) {
+            GM_THROW("Unsupported SPIR-V vertex input type [" << type_id << "], only 32-bit scalars and vectors are supported");
+        }
+        if (component_type.opcode == spirv_op_type_float) {
+            constexpr VkFormat float_formats[] = {VK_FORMAT_R32_SFLOAT, VK_FORMAT_R32G32_SFLOAT, VK_FORMAT_R32G32B32_SFLOAT, VK_FORMAT_R32G32B32A32_SFLOAT};
+            return float_formats[component_count - 1];
+        }
+        if (get_operand(module, component_type_id, 2) == 1) {
+            constexpr VkFormat sint_formats[] = {VK_FORMAT_R32_SINT, VK_FORMAT_R32G32_SINT, VK_FORMAT_R32G32B32_SINT, VK_FORMAT_R32G32B32A32_SINT};
+            return sint_formats[component_count - 1];
+        }
+        constexpr VkFormat uint_formats[] = {VK_FORMAT_R32_UINT, VK_FORMAT_R32G32_UINT, VK_FORMAT_R32G32B32_UINT, VK_FORMAT_R32G32B32A32_UINT};
+        return uint_formats[component_count - 1];
+    }
+
+    // Matrices and arrays take one location per column or element
+    void add_vertex_inputs(const SpirvModule& module, ShaderReflection& reflection, u32 location, u32 type_id) {
+        const SpirvId& type = get_id(module, type_id);
+        if (type.opcode == spirv_op_type_matrix || type.opcode == spirv_op_type_array) {
+            u32 element_count = type.opcode == spirv_op_type_matrix ? get_operand(module, type_id, 2) : get_constant_value(module, get_operand(module, type_id, 2));
+            u32 element_type_id = get_operand(module, type_id, 1);
+            u32 element_location_count = get_id(module, element_type_id).opcode == spirv_op_type_matrix ? get_operand(module, element_type_id, 2) : 1;
+            for (u32 i = 0; i < element_count; ++i) {
+                add_vertex_inputs(module, reflection, location + i * element_location_count, element_type_id);
+            }
+            return;
+        }
+        reflection.vertex_inputs.push_back({
+            .location = location,
+            .format = get_vertex_input_format(module, type_id),
+            .size = get_type_size(module, type_id),
+        });
+    }
+
+    ShaderReflection reflect_spirv(std::span<const u8> code) {
+        if (code.size() % sizeof(u32) != 0 || code.size() < spirv_header_word_count * sizeof(u32) || (uintptr_t) code.data() % alignof(u32) != 0) {
+            GM_THROW("Invalid SPIR-V of [" << code.size() << "] bytes");
+        }
+        SpirvModule module{};
+        module.words = {(const u32*) code.data(), code.size() / sizeof(u32)};
+        if (module.words[0] != spirv_magic) {
+            GM_THROW("Invalid SPIR-V, it doesn't start with the magic number");
+        }
+        u32 id_bound = module.words[3];
+        module.ids.resize(id_bound);
+
+        ShaderReflection reflection{};
+        bool entry_point_found = false;
+        std::vector<u32> variables;
+
+        for (u32 i = spirv_header_word_count; i < module.words.size();) {
+            u32 word_count = module.words[i] >> 16;
+            u32 opcode = module.words[i] & 0xffff;
+            if (word_count == 0 || i + word_count > module.words.size()) {
+                GM_THROW("Invalid SPIR-V instruction with opcode [" << opcode << "] at word [" << i << "]");
+            }
+            const u32* operands = &module.words[i + 1];
+
+            // Only the first entry point is reflected, the shaders are compiled with one each
+            if (opcode == spirv_op_entry_point && !entry_point_found) {
+                reflection.stage = get_shader_stage(operands[0]);
+                entry_point_found = true;
+            }
+
+            u32 result_id = spirv_no_value;
+            switch (opcode) {
+                case spirv_op_type_bool:
+                case spirv_op_type_int:
+                case spirv_op_type_float:
+                case spirv_op_type_vector:
+                case spirv_op_type_matrix:
+                case spirv_op_type_image:
+                case spirv_op_type_sampler:
+                case spirv_op_type_sampled_image:
+                case spirv_op_type_array:
+                case spirv_op_type_runtime_array:
+                case spirv_op_type_struct:
+                case spirv_op_type_pointer:
+                case spirv_op_type_acceleration_structure:
+                    result_id = operands[0];
+                    break;
+                case spirv_op_constant:
+                case spirv_op_spec_constant:
+                case spirv_op_variable:
+                    result_id = operands[1];
+                    break;
+                default:
+                    break;
+            }
+            if (result_id != spirv_no_value) {
+                if (result_id >= id_bound) {
+                    GM_THROW("SPIR-V id [" << result_id << "] is out of the bound [" << id_bound << "]");
+                }
+                module.ids[result_id].opcode = opcode;
+                module.ids[result_id].instruction = i;
+                if (opcode == spirv_op_variable) {
+                    variables.push_back(result_id);
+                }
+            }
+
+            // Decorations come before the declarations they apply to
+            if (opcode == spirv_op_decorate && word_count >= 3 && operands[0] < id_bound) {
+                SpirvId& target = module.ids[operands[0]];
+                u32 value = word_count >= 4 ? operands[2] : 0;
+                switch (operands[1]) {
+                    case spirv_decoration_block: target.block = true; break;
+                    case spirv_decoration_buffer_block: target.buffer_block = true; break;
+                    case spirv_decoration_array_stride: target.array_stride = value; break;
+                    case spirv_decoration_built_in: target.built_in = true; break;
+                    case spirv_decoration_location: target.location = value; break;
+                    case spirv_decoration_binding: target.binding = value; break;
+                    case spirv_decoration_descriptor_set: target.set = value; break;
+                    default: break;
+                }
+            }
+            if (opcode == spirv_op_member_decorate && word_count >= 5 && operands[0] < id_bound) {
+                SpirvId& target = module.ids[operands[0]];
+                u32 member = operands[1];
+                if (operands[2] == spirv_decoration_offset) {
+                    target.member_offsets.resize(std::max((u32) target.member_offsets.size(), member + 1));
+                    target.member_offsets[member] = operands[3];
+                } else if (operands[2] == spirv_decoration_matrix_stride) {
+                    target.member_matrix_strides.resize(std::max((u32) target.member_matrix_strides.size(), member + 1));
+                    target.member_matrix_strides[member] = operands[3];
+                }
+            }
+
+            i += word_count;
+        }
+        if (!entry_point_found) {
+            GM_THROW("Invalid SPIR-V, it has no entry point");
+        }
+
+        for (u32 variable_id : variables) {
+            const SpirvId& variable = module.ids[variable_id];
+            u32 storage_class = get_operand(module, variable_id, 2);
+            const SpirvId& pointer_type = get_id(module, get_operand(module, variable_id, 0));
+            if (pointer_type.opcode != spirv_op_type_pointer) {
+                GM_THROW("SPIR-V variable [" << variable_id << "] is not a pointer");
+            }
+            u32 type_id = get_operand(module, get_operand(module, variable_id, 0), 2);
+
+            if (storage_class == spirv_storage_class_push_constant) {
+                const SpirvId& type = get_id(module, type_id);
+                if (type.member_offsets.empty()) {
+                    GM_THROW("SPIR-V push constant block [" << variable_id << "] has no members with an offset");
+                }
+                u32 offset = *std::min_element(type.member_offsets.begin(), type.member_offsets.end());
+                reflection.push_constants = {
+                    .offset = offset,
+                    .size = get_type_size(module, type_id) - offset,
+                };
+                continue;
+            }
+
+            if (storage_class == spirv_storage_class_uniform_constant || storage_class == spirv_storage_class_uniform || storage_class == spirv_storage_class_storage_buffer) {
+                if (variable.binding == spirv_no_value) {
+                    GM_THROW("SPIR-V resource variable [" << variable_id << "] has no binding");
+                }
+                u32 count = 1;
+                while (get_id(module, type_id).opcode == spirv_op_type_array || get_id(module, type_id).opcode == spirv_op_type_runtime_array) {
+                    if (get_id(module, type_id).opcode == spirv_op_type_array) {
+                        count *= get_constant_value(module, get_operand(module, type_id, 2));
+                    }
+                    type_id = get_operand(module, type_id, 1);
+                }
+                reflection.descriptor_bindings.push_back({
+                    .set = variable.set == spirv_no_value ? 0 : variable.set,
+                    .binding = variable.binding,
+                    .type = get_descriptor_type(module, type_id, storage_class),
+                    .count = count,
+                });
+                continue;
+            }
+
+            if (storage_class == spirv_storage_class_input && reflection.stage == VK_SHADER_STAGE_VERTEX_BIT && !variable.built_in) {
+                if (variable.location == spirv_no_value) {
+                    GM_THROW("SPIR-V vertex input variable [" << variable_id << "] has no location");
+                }
+                add_vertex_inputs(module, reflection, variable.location, type_id);
+            }
+        }
+
+        std::sort(reflection.descriptor_bindings.begin(), reflection.descriptor_bindings.end(), [](const ReflectedDescriptorBinding& a, const ReflectedDescriptorBinding& b) {
+            return a.set != b.set ? a.set < b.set : a.binding < b.binding;
+        });
+        std::sort(reflection.vertex_inputs.begin(), reflection.vertex_inputs.end(), [](const ReflectedVertexInput& a, const ReflectedVertexInput& b) {
+            return a.location < b.location;
+        });
+        return reflection;
+    }
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "system/numbers.h"
+
+#include <span>
+#include <vector>
+
+// Reads the interface of a shader from the decorations in its SPIR-V, so that pipeline layouts and vertex input state
+// are derived from the shaders instead of being written by hand and kept in sync with them.
+
+namespace Game {
+    struct ReflectedDescriptorBinding {
+        u32 set = 0;
+        u32 binding = 0;
+        VkDescriptorType type = VK_DESCRIPTOR_TYPE_MAX_ENUM;
+        u32 count = 1; // Array size, where a runtime sized array counts as 1
+    };
+
+    struct ReflectedPushConstants {
+        u32 offset = 0; // Of the first member that is used
+        u32 size = 0;   // 0 if the shader has no push constant block
+    };
+
+    struct ReflectedVertexInput {
+        u32 location = 0;
+        VkFormat format = VK_FORMAT_UNDEFINED;
+        u32 size = 0; // In bytes
+    };
+
+    struct ShaderReflection {
+        VkShaderStageFlagBits stage = VK_SHADER_STAGE_ALL;
+        std::vector<ReflectedDescriptorBinding> descriptor_bindings; // Sorted by set and binding
+        ReflectedPushConstants push_constants{};
+        std::vector<ReflectedVertexInput> vertex_inputs; // Sorted by location, only for vertex shaders
+    };
+
+    // Throws if the code is not valid SPIR-V or uses a type that can't be reflected.
+    ShaderReflection reflect_spirv(std::span<const u8> code);
+}
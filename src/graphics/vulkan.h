@@ -1,7 +1,16 @@
 #pragma once
 
+#include "graphics/spirv_reflection.h"
+#include "system/time.h"
 #include "window/window.h"
 
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
 namespace Game {
 
     struct QueueFamilyIndices {
@@ -9,17 +18,234 @@ namespace Game {
         std::optional<u32> present_family;
     };
 
+    struct VulkanPipeline {
+        VkPipeline handle = nullptr;
+        VkPipelineLayout layout = nullptr; // Owned by the layout cache
+        VkShaderModule vertex_shader = nullptr;
+        VkShaderModule fragment_shader = nullptr;
+    };
+
+    struct RetiredPipeline {
+        VulkanPipeline pipeline{};
+        u32 frames_left = 0; // Frames to wait for before no frame in flight can be using the pipeline
+    };
+
+    enum class BlendMode : u8 {
+        Opaque,
+        Alpha,    // Source over destination by the source alpha
+        Additive,
+    };
+
+    // Everything that makes one pipeline differ from another, kept small so that it is cheap to hash and compare at
+    // draw time. The vertex layout and the pipeline layout are reflected from the shaders, so the shaders cover them.
+    // With extended dynamic state, the fields that are dynamic are set when recording and left out of the pipeline.
+    struct PipelineState {
+        u64 vertex_shader = 0;   // Hash of the embedded shader
+        u64 fragment_shader = 0; // Hash of the embedded shader
+        VkFormat color_format = VK_FORMAT_UNDEFINED;
+        VkFormat depth_format = VK_FORMAT_UNDEFINED; // Without depth testing if undefined
+        VkSampleCountFlagBits sample_count = VK_SAMPLE_COUNT_1_BIT;
+        VkPrimitiveTopology topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+        VkPolygonMode polygon_mode = VK_POLYGON_MODE_FILL;
+        VkCullModeFlags cull_mode = VK_CULL_MODE_BACK_BIT;
+        VkFrontFace front_face = VK_FRONT_FACE_CLOCKWISE;
+        VkCompareOp depth_compare_op = VK_COMPARE_OP_LESS;
+        BlendMode blend_mode = BlendMode::Alpha;
+        bool depth_write_enabled = true;
+
+        bool operator==(const PipelineState& other) const = default;
+    };
+
+    struct PipelineStateHash {
+        u64 operator()(const PipelineState& state) const;
+    };
+
+    enum class PipelineStatus : u8 {
+        Compiling,
+        Ready,
+        Failed,
+    };
+
+    struct CachedPipeline {
+        VulkanPipeline pipeline{}; // Only read once the status is ready, it is written by a compiler thread
+        std::atomic<PipelineStatus> status = PipelineStatus::Compiling;
+    };
+
+    struct PipelineCompileRequest {
+        PipelineState state{};
+        CachedPipeline* cached_pipeline = nullptr;
+        VkPipeline linked_pipeline = nullptr; // Fast linked from libraries already if set, only the optimized link is left
+    };
+
+    // One of the four parts of a pipeline with the graphics pipeline library, with only the fields of the state that
+    // the part depends on. Every state that shares those fields shares the library.
+    struct PipelineLibraryKey {
+        VkGraphicsPipelineLibraryFlagsEXT part = 0;
+        PipelineState state{};
+
+        bool operator==(const PipelineLibraryKey& other) const = default;
+    };
+
+    struct PipelineLibraryKeyHash {
+        u64 operator()(const PipelineLibraryKey& key) const;
+    };
+
+    // Linked with link time optimization on a compiler thread, to take the place of the fast linked pipeline
+    struct OptimizedPipeline {
+        CachedPipeline* cached_pipeline = nullptr;
+        VulkanPipeline pipeline{};
+        VkPipeline linked_pipeline = nullptr; // Only replaced if the cached pipeline is still this one
+    };
+
+    // Pipelines by their state. A state that is looked up for the first time is compiled on the compiler threads, so
+    // that creating a pipeline never stalls a frame. Every compiler thread has its own VkPipelineCache, which the
+    // driver would otherwise have to lock for every pipeline.
+    // With the graphics pipeline library, the parts of a pipeline are compiled once as libraries that new states fast
+    // link in microseconds, and an optimized link of the same libraries takes over once a compiler thread is done.
+    struct VulkanPipelineStateCache {
+        // Only accessed by the thread that renders
+        std::unordered_map<PipelineState, CachedPipeline, PipelineStateHash> pipelines;
+        u64 hit_count = 0;
+        u64 miss_count = 0;
+        u64 fast_link_count = 0;
+        Milliseconds fast_link_time{};
+        std::vector<RetiredPipeline> retired_pipelines; // Replaced by optimized links or by rebuilds from changed shaders
+
+        std::vector<std::thread> compiler_threads;
+        std::vector<VkPipelineCache> compiler_pipeline_caches; // One per compiler thread
+        std::vector<char> file_data; // Saved by an earlier run, every compiler thread's cache starts from it
+
+        // Guards the fields below
+        std::mutex mutex;
+        std::condition_variable condition;
+        std::deque<PipelineCompileRequest> compile_requests;
+        bool running = false;
+        u32 failed_count = 0;
+        Milliseconds creation_time{}; // Of all the pipelines that were compiled
+        Milliseconds slowest_creation_time{};
+        std::unordered_map<PipelineLibraryKey, VulkanPipeline, PipelineLibraryKeyHash> libraries;
+        std::vector<OptimizedPipeline> optimized_pipelines; // Waiting to be swapped in
+    };
+
+    // Canonical description of a layout, compared in full so that a hash collision can't share the wrong layout
+    using VulkanLayoutKey = std::vector<u32>;
+
+    struct VulkanLayoutKeyHash {
+        u64 operator()(const VulkanLayoutKey& key) const;
+    };
+
+    // Identical descriptor set layouts and pipeline layouts are created once and shared by every pipeline that uses them
+    struct VulkanLayoutCache {
+        std::mutex mutex;
+        std::unordered_map<VulkanLayoutKey, VkDescriptorSetLayout, VulkanLayoutKeyHash> descriptor_set_layouts;
+        std::unordered_map<VulkanLayoutKey, VkPipelineLayout, VulkanLayoutKeyHash> pipeline_layouts;
+    };
+
+    // Device features that are used when the physical device supports them, with a fallback otherwise
+    struct VulkanOptionalFeatures {
+        bool graphics_pipeline_library = false; // Only with fast linking, which is the point of using it
+        bool shader_object = false; // Only with dynamic rendering, which drawing with shader objects needs
+        bool extended_dynamic_state = false; // Extended dynamic state 1 and 2, which are core in Vulkan 1.3
+        bool extended_dynamic_state3_polygon_mode = false;
+        bool extended_dynamic_state3_color_blend = false; // Both the blend enable and the blend equation
+    };
+
+    // What a physical device supports and how it scored when the device was picked, for diagnostics
+    struct VulkanPhysicalDeviceReport {
+        std::string name;
+        std::string uuid; // Hex of the device UUID, which `VulkanConfig::physical_device_uuid` can be set to
+        VkPhysicalDeviceType type = VK_PHYSICAL_DEVICE_TYPE_OTHER;
+        u32 vendor_id = 0;
+        u32 device_id = 0;
+        u32 driver_version = 0; // Encoded by the vendor
+        u32 api_version = 0;
+        u32 queue_family_count = 0;
+        bool graphics_present_queue_shared = false; // Graphics and present in one queue family
+        bool dedicated_transfer_queue = false;
+        bool dedicated_compute_queue = false;
+        VkFormat depth_format = VK_FORMAT_UNDEFINED;
+        VulkanOptionalFeatures optional_features{}; // What the device supports, whether or not it is used
+        u32 score = 0;
+        std::string unsuitable_reason; // Empty if the device can be used
+        bool cached = false; // The capabilities came from the physical device cache instead of the device
+        bool picked = false;
+    };
+
+    // Commands of device extensions, which the loader doesn't export. Null when the extension is not used.
+    struct VulkanDeviceFunctions {
+        PFN_vkCreateShadersEXT create_shaders = nullptr;
+        PFN_vkDestroyShaderEXT destroy_shader = nullptr;
+        PFN_vkCmdBindShadersEXT cmd_bind_shaders = nullptr;
+        PFN_vkCmdSetVertexInputEXT cmd_set_vertex_input = nullptr;
+        PFN_vkCmdSetPolygonModeEXT cmd_set_polygon_mode = nullptr;
+        PFN_vkCmdSetRasterizationSamplesEXT cmd_set_rasterization_samples = nullptr;
+        PFN_vkCmdSetSampleMaskEXT cmd_set_sample_mask = nullptr;
+        PFN_vkCmdSetAlphaToCoverageEnableEXT cmd_set_alpha_to_coverage_enable = nullptr;
+        PFN_vkCmdSetAlphaToOneEnableEXT cmd_set_alpha_to_one_enable = nullptr;
+        PFN_vkCmdSetDepthClampEnableEXT cmd_set_depth_clamp_enable = nullptr;
+        PFN_vkCmdSetLogicOpEnableEXT cmd_set_logic_op_enable = nullptr;
+        PFN_vkCmdSetColorBlendEnableEXT cmd_set_color_blend_enable = nullptr;
+        PFN_vkCmdSetColorBlendEquationEXT cmd_set_color_blend_equation = nullptr;
+        PFN_vkCmdSetColorWriteMaskEXT cmd_set_color_write_mask = nullptr;
+    };
+
+    struct ShaderObjectKey {
+        u64 shader = 0; // Hash of the embedded shader
+        VkPipelineLayout layout = nullptr; // The shader is created against the layout of the pair it was first used in
+
+        bool operator==(const ShaderObjectKey& other) const = default;
+    };
+
+    struct ShaderObjectKeyHash {
+        u64 operator()(const ShaderObjectKey& key) const;
+    };
+
+    // Hashes of an embedded vertex shader and fragment shader
+    using ShaderPair = std::pair<u64, u64>;
+
+    struct ShaderPairHash {
+        u64 operator()(const ShaderPair& shader_pair) const;
+    };
+
+    struct VulkanShaderObjects {
+        VkShaderEXT vertex_shader = nullptr;
+        VkShaderEXT fragment_shader = nullptr;
+        VkPipelineLayout layout = nullptr; // Owned by the layout cache
+        VkVertexInputBindingDescription2EXT vertex_binding{};
+        std::vector<VkVertexInputAttributeDescription2EXT> vertex_attributes;
+        bool failed = false;
+    };
+
+    // Shaders that are bound individually, with all the state that a pipeline bakes in set when recording instead.
+    // A shader is created once per layout, however many states it is drawn with. Only accessed by the thread that renders.
+    struct VulkanShaderObjectCache {
+        std::unordered_map<ShaderObjectKey, VkShaderEXT, ShaderObjectKeyHash> shaders;
+        std::unordered_map<ShaderPair, VulkanShaderObjects, ShaderPairHash> shader_pairs;
+    };
+
     struct VulkanConfig {
         Window* window = nullptr;
         std::string application_name;
         std::string engine_name;
         bool validation_layers_enabled = false;
         u32 max_frames_in_flight = 0;
+        u32 pipeline_compiler_thread_count = 2;
+        bool graphics_pipeline_library_enabled = true; // Used if the device supports it
+        bool shader_object_enabled = true; // Used instead of pipelines if the device supports it
+        bool extended_dynamic_state_enabled = true; // Used if the device supports it
+        std::filesystem::path pipeline_cache_path; // Pipelines are saved to it when destroyed, if set
+        std::string physical_device_uuid; // Picked instead of the highest scoring device, if set and suitable
+        std::filesystem::path physical_device_cache_path; // Capabilities of the devices are saved to it, if set
     };
 
     struct Vulkan {
         VulkanConfig config{};
 
+        // Enumerated before the instance is created, which doesn't have to wait for the window
+        std::vector<VkLayerProperties> instance_layers;
+        std::vector<VkExtensionProperties> instance_extensions;
+        bool instance_properties_loaded = false;
+
         VkInstance instance = nullptr;
         VkDebugUtilsMessengerEXT debug_messenger = nullptr;
 
@@ -34,10 +260,13 @@ namespace Game {
         std::vector<VkPresentModeKHR> physical_device_present_modes;
         QueueFamilyIndices physical_device_queue_family_indices{};
         VkFormat physical_device_depth_format = VK_FORMAT_UNDEFINED;
+        VulkanOptionalFeatures physical_device_optional_features{};
+        std::vector<VulkanPhysicalDeviceReport> physical_device_reports; // Of every device, from when one was picked
 
         VkDevice device = nullptr;
         VkQueue graphics_queue = nullptr;
         VkQueue present_queue = nullptr;
+        VulkanDeviceFunctions device_functions{};
 
         VkSwapchainKHR swap_chain = nullptr;
         VkExtent2D swap_chain_extent{};
@@ -52,10 +281,15 @@ namespace Game {
         u32 swap_chain_current_image_index;
         std::string swap_chain_name;
 
-        VkPipeline pipeline = nullptr;
-        VkPipelineLayout pipeline_layout = nullptr;
-        VkShaderModule vertex_shader = nullptr;
-        VkShaderModule fragment_shader = nullptr;
+        // Guarded by its own mutex, so that pipelines can be created on other threads while frames are rendered
+        mutable VulkanLayoutCache layout_cache{};
+
+        // By the hash of the embedded shader. Filled before the device is created and only read after, so compiler
+        // threads read it without a lock.
+        std::unordered_map<u64, ShaderReflection> embedded_shader_reflections;
+
+        VulkanPipelineStateCache pipeline_state_cache{};
+        VulkanShaderObjectCache shader_object_cache{};
 
         VkCommandPool command_pool = nullptr;
         std::vector<VkCommandBuffer> command_buffers;
@@ -63,7 +297,7 @@ namespace Game {
 
     void create_vulkan(Vulkan& vulkan, const VulkanConfig& config);
 
-    void destroy_vulkan(const Vulkan& vulkan);
+    void destroy_vulkan(Vulkan& vulkan);
 
     void render_frame(Vulkan& vulkan);
 }
@@ -8,6 +8,43 @@ namespace Game {
         return queue;
     }
 
+    PFN_vkVoidFunction get_device_function(VkDevice device, const char* function_name) {
+        PFN_vkVoidFunction function = vkGetDeviceProcAddr(device, function_name);
+        if (!function) {
+            GM_THROW("Could not get Vulkan device function [" << function_name << "]");
+        }
+        return function;
+    }
+
+    // Loaded once, instead of looking them up for every command that is recorded
+    void load_device_functions(Vulkan& vulkan) {
+        VulkanDeviceFunctions& functions = vulkan.device_functions;
+        if (vulkan.physical_device_optional_features.shader_object) {
+            functions.create_shaders = (PFN_vkCreateShadersEXT) get_device_function(vulkan.device, "vkCreateShadersEXT");
+            functions.destroy_shader = (PFN_vkDestroyShaderEXT) get_device_function(vulkan.device, "vkDestroyShaderEXT");
+            functions.cmd_bind_shaders = (PFN_vkCmdBindShadersEXT) get_device_function(vulkan.device, "vkCmdBindShadersEXT");
+            functions.cmd_set_vertex_input = (PFN_vkCmdSetVertexInputEXT) get_device_function(vulkan.device, "vkCmdSetVertexInputEXT");
+            functions.cmd_set_polygon_mode = (PFN_vkCmdSetPolygonModeEXT) get_device_function(vulkan.device, "vkCmdSetPolygonModeEXT");
+            functions.cmd_set_rasterization_samples = (PFN_vkCmdSetRasterizationSamplesEXT) get_device_function(vulkan.device, "vkCmdSetRasterizationSamplesEXT");
+            functions.cmd_set_sample_mask = (PFN_vkCmdSetSampleMaskEXT) get_device_function(vulkan.device, "vkCmdSetSampleMaskEXT");
+            functions.cmd_set_alpha_to_coverage_enable = (PFN_vkCmdSetAlphaToCoverageEnableEXT) get_device_function(vulkan.device, "vkCmdSetAlphaToCoverageEnableEXT");
+            functions.cmd_set_alpha_to_one_enable = (PFN_vkCmdSetAlphaToOneEnableEXT) get_device_function(vulkan.device, "vkCmdSetAlphaToOneEnableEXT");
+            functions.cmd_set_depth_clamp_enable = (PFN_vkCmdSetDepthClampEnableEXT) get_device_function(vulkan.device, "vkCmdSetDepthClampEnableEXT");
+            functions.cmd_set_logic_op_enable = (PFN_vkCmdSetLogicOpEnableEXT) get_device_function(vulkan.device, "vkCmdSetLogicOpEnableEXT");
+            functions.cmd_set_color_blend_enable = (PFN_vkCmdSetColorBlendEnableEXT) get_device_function(vulkan.device, "vkCmdSetColorBlendEnableEXT");
+            functions.cmd_set_color_blend_equation = (PFN_vkCmdSetColorBlendEquationEXT) get_device_function(vulkan.device, "vkCmdSetColorBlendEquationEXT");
+            functions.cmd_set_color_write_mask = (PFN_vkCmdSetColorWriteMaskEXT) get_device_function(vulkan.device, "vkCmdSetColorWriteMaskEXT");
+        }
+        // Pipelines with extended dynamic state 3 set the same state as shader objects
+        if (vulkan.physical_device_optional_features.extended_dynamic_state3_polygon_mode) {
+            functions.cmd_set_polygon_mode = (PFN_vkCmdSetPolygonModeEXT) get_device_function(vulkan.device, "vkCmdSetPolygonModeEXT");
+        }
+        if (vulkan.physical_device_optional_features.extended_dynamic_state3_color_blend) {
+            functions.cmd_set_color_blend_enable = (PFN_vkCmdSetColorBlendEnableEXT) get_device_function(vulkan.device, "vkCmdSetColorBlendEnableEXT");
+            functions.cmd_set_color_blend_equation = (PFN_vkCmdSetColorBlendEquationEXT) get_device_function(vulkan.device, "vkCmdSetColorBlendEquationEXT");
+        }
+    }
+
     void create_vulkan_device(Vulkan& vulkan, const DeviceConfig& config) {
         const QueueFamilyIndices& queue_family_indices = vulkan.physical_device_queue_family_indices;
         const VkPhysicalDeviceFeatures& enabled_features = vulkan.physical_device_features;
@@ -35,8 +72,45 @@ namespace Game {
             queue_create_infos.push_back(queue_create_info);
         }
 
+        // Optional features are chained onto the create info
+        const void* next_features = nullptr;
+
+        VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT graphics_pipeline_library_features{};
+        graphics_pipeline_library_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT;
+        graphics_pipeline_library_features.graphicsPipelineLibrary = VK_TRUE;
+        if (vulkan.physical_device_optional_features.graphics_pipeline_library) {
+            graphics_pipeline_library_features.pNext = (void*) next_features;
+            next_features = &graphics_pipeline_library_features;
+        }
+
+        VkPhysicalDeviceShaderObjectFeaturesEXT shader_object_features{};
+        shader_object_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SHADER_OBJECT_FEATURES_EXT;
+        shader_object_features.shaderObject = VK_TRUE;
+
+        VkPhysicalDeviceDynamicRenderingFeatures dynamic_rendering_features{};
+        dynamic_rendering_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES;
+        dynamic_rendering_features.dynamicRendering = VK_TRUE;
+
+        if (vulkan.physical_device_optional_features.shader_object) {
+            shader_object_features.pNext = (void*) next_features;
+            dynamic_rendering_features.pNext = &shader_object_features;
+            next_features = &dynamic_rendering_features;
+        }
+
+        // Only the features that are used are enabled
+        VkPhysicalDeviceExtendedDynamicState3FeaturesEXT extended_dynamic_state3_features{};
+        extended_dynamic_state3_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_3_FEATURES_EXT;
+        extended_dynamic_state3_features.extendedDynamicState3PolygonMode = vulkan.physical_device_optional_features.extended_dynamic_state3_polygon_mode;
+        extended_dynamic_state3_features.extendedDynamicState3ColorBlendEnable = vulkan.physical_device_optional_features.extended_dynamic_state3_color_blend;
+        extended_dynamic_state3_features.extendedDynamicState3ColorBlendEquation = vulkan.physical_device_optional_features.extended_dynamic_state3_color_blend;
+        if (extended_dynamic_state3_features.extendedDynamicState3PolygonMode || extended_dynamic_state3_features.extendedDynamicState3ColorBlendEnable) {
+            extended_dynamic_state3_features.pNext = (void*) next_features;
+            next_features = &extended_dynamic_state3_features;
+        }
+
         VkDeviceCreateInfo device_create_info{};
         device_create_info.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
+        device_create_info.pNext = next_features;
         device_create_info.pEnabledFeatures = &enabled_features;
         device_create_info.enabledExtensionCount = (u32) enabled_extension_names.size();
         device_create_info.ppEnabledExtensionNames = enabled_extension_names.data();
@@ -49,6 +123,8 @@ namespace Game {
 
         set_vulkan_object_name(vulkan.device, vulkan.device, VK_OBJECT_TYPE_DEVICE, config.name.c_str());
 
+        load_device_functions(vulkan);
+
         vulkan.graphics_queue = get_device_queue(vulkan.device, queue_family_indices.graphics_family.value());
         if (!vulkan.graphics_queue) {
             GM_THROW("Could not get Vulkan device graphics queue");
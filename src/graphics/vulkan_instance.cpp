@@ -77,8 +77,7 @@ namespace Game {
         return layers;
     }
 
-    bool has_validation_layers(const std::vector<const char*>& validation_layers) {
-        std::vector<VkLayerProperties> available_validation_layers = get_available_validation_layers();
+    bool has_validation_layers(const std::vector<const char*>& validation_layers, const std::vector<VkLayerProperties>& available_validation_layers) {
         for (const char* layer_name: validation_layers) {
             bool layer_found = false;
             for (const auto& availableLayer: available_validation_layers) {
@@ -113,8 +112,7 @@ namespace Game {
         return extensions;
     }
 
-    bool has_extensions(const std::vector<const char*>& extensions) {
-        std::vector<VkExtensionProperties> available_extensions = get_available_extensions();
+    bool has_extensions(const std::vector<const char*>& extensions, const std::vector<VkExtensionProperties>& available_extensions) {
         for (const char* extension: extensions) {
             bool extensionFound = false;
             for (const VkExtensionProperties& availableExtension: available_extensions) {
@@ -144,16 +142,27 @@ namespace Game {
         return extensions;
     }
 
+    void load_vulkan_instance_properties(Vulkan& vulkan) {
+        vulkan.instance_layers = get_available_validation_layers();
+        vulkan.instance_extensions = get_available_extensions();
+        vulkan.instance_properties_loaded = true;
+        GM_LOG_DEBUG("Found [{}] Vulkan instance layers and [{}] instance extensions", vulkan.instance_layers.size(), vulkan.instance_extensions.size());
+    }
+
     void create_vulkan_instance(Vulkan& vulkan, const VulkanInstanceConfig& config) {
+        if (!vulkan.instance_properties_loaded) {
+            load_vulkan_instance_properties(vulkan);
+        }
+
         std::vector<const char*> extensions = get_required_extensions(config);
-        if (!has_extensions(extensions)) {
+        if (!has_extensions(extensions, vulkan.instance_extensions)) {
             GM_THROW("System does not have required Vulkan extensions");
         }
 
         std::vector<const char*> validation_layers;
         if (config.validation_layers_enabled) {
             validation_layers = get_required_validation_layers();
-            if (!has_validation_layers(validation_layers)) {
+            if (!has_validation_layers(validation_layers, vulkan.instance_layers)) {
                 GM_THROW("System does not have required Vulkan validation layers");
             }
         }
@@ -10,6 +10,11 @@ namespace Game {
         bool validation_layers_enabled = false;
     };
 
+    // Enumerates the instance layers and extensions, which is when the loader reads the layer manifests and loads the
+    // drivers. Doesn't need GLFW, so it can run on another thread while the window is created. The instance enumerates
+    // them itself if this wasn't called.
+    void load_vulkan_instance_properties(Vulkan& vulkan);
+
     void create_vulkan_instance(Vulkan& vulkan, const VulkanInstanceConfig& config);
 
     void destroy_vulkan_instance(const Vulkan& vulkan);
@@ -0,0 +1,161 @@
+#include "vulkan_layout_cache.h"
+#include "system/hash.h"
+
+namespace Game {
+    // FNV-1a
+    u64 VulkanLayoutKeyHash::operator()(const VulkanLayoutKey& key) const {
+        u64 hash = fnv1a_offset_basis;
+        for (u32 word : key) {
+            hash = hash_combine(hash, word);
+        }
+        return hash;
+    }
+
+    void add_handle_to_key(VulkanLayoutKey& key, void* handle) {
+        u64 value = (u64) (uintptr_t) handle;
+        key.push_back((u32) value);
+        key.push_back((u32) (value >> 32));
+    }
+
+    // Expects the cache to be locked
+    VkDescriptorSetLayout get_cached_descriptor_set_layout(const Vulkan& vulkan, std::span<const VkDescriptorSetLayoutBinding> bindings) {
+        VulkanLayoutKey key;
+        key.reserve(bindings.size() * 4);
+        for (const VkDescriptorSetLayoutBinding& binding : bindings) {
+            key.push_back(binding.binding);
+            key.push_back((u32) binding.descriptorType);
+            key.push_back(binding.descriptorCount);
+            key.push_back(binding.stageFlags);
+        }
+
+        VulkanLayoutCache& cache = vulkan.layout_cache;
+        auto iterator = cache.descriptor_set_layouts.find(key);
+        if (iterator != cache.descriptor_set_layouts.end()) {
+            return iterator->second;
+        }
+
+        VkDescriptorSetLayoutCreateInfo descriptor_set_layout_create_info{};
+        descriptor_set_layout_create_info.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+        descriptor_set_layout_create_info.bindingCount = (u32) bindings.size();
+        descriptor_set_layout_create_info.pBindings = bindings.data();
+
+        VkDescriptorSetLayout descriptor_set_layout;
+        if (vkCreateDescriptorSetLayout(vulkan.device, &descriptor_set_layout_create_info, GM_VK_ALLOCATOR, &descriptor_set_layout) != VK_SUCCESS) {
+            GM_THROW("Could not create Vulkan descriptor set layout");
+        }
+
+        std::string descriptor_set_layout_name = std::format("DescriptorSetLayout {}", cache.descriptor_set_layouts.size());
+        set_vulkan_object_name(vulkan.device, descriptor_set_layout, VK_OBJECT_TYPE_DESCRIPTOR_SET_LAYOUT, descriptor_set_layout_name.c_str());
+
+        cache.descriptor_set_layouts.emplace(std::move(key), descriptor_set_layout);
+        GM_LOG_DEBUG("Created [{}] with [{}] bindings", descriptor_set_layout_name, bindings.size());
+        return descriptor_set_layout;
+    }
+
+    VkDescriptorSetLayout get_vulkan_descriptor_set_layout(const Vulkan& vulkan, std::span<const VkDescriptorSetLayoutBinding> bindings) {
+        std::lock_guard lock(vulkan.layout_cache.mutex);
+        return get_cached_descriptor_set_layout(vulkan, bindings);
+    }
+
+    VkPipelineLayout get_vulkan_pipeline_layout(const Vulkan& vulkan, std::span<const ShaderReflection> shaders) {
+        return get_vulkan_pipeline_layout_description(vulkan, shaders).layout;
+    }
+
+    VulkanPipelineLayoutDescription get_vulkan_pipeline_layout_description(const Vulkan& vulkan, std::span<const ShaderReflection> shaders) {
+        // Bindings by set and binding number, with the stage flags of every stage that uses them
+        std::map<u32, std::map<u32, VkDescriptorSetLayoutBinding>> sets;
+        std::vector<VkPushConstantRange> push_constant_ranges;
+        for (const ShaderReflection& shader : shaders) {
+            for (const ReflectedDescriptorBinding& reflected_binding : shader.descriptor_bindings) {
+                auto [iterator, inserted] = sets[reflected_binding.set].try_emplace(reflected_binding.binding, VkDescriptorSetLayoutBinding{
+                    .binding = reflected_binding.binding,
+                    .descriptorType = reflected_binding.type,
+                    .descriptorCount = reflected_binding.count,
+                    .stageFlags = 0,
+                    .pImmutableSamplers = nullptr,
+                });
+                VkDescriptorSetLayoutBinding& binding = iterator->second;
+                if (binding.descriptorType != reflected_binding.type || binding.descriptorCount != reflected_binding.count) {
+                    GM_THROW("Shader stages declare set [" << reflected_binding.set << "] binding [" << reflected_binding.binding << "] differently");
+                }
+                binding.stageFlags |= shader.stage;
+            }
+            // One range per stage, a push to where ranges overlap must name every stage that declares them
+            if (shader.push_constants.size > 0) {
+                push_constant_ranges.push_back({
+                    .stageFlags = (VkShaderStageFlags) shader.stage,
+                    .offset = shader.push_constants.offset,
+                    .size = shader.push_constants.size,
+                });
+            }
+        }
+
+        std::lock_guard lock(vulkan.layout_cache.mutex);
+
+        // Sets are numbered from 0 in the pipeline layout, so unused sets in between get an empty layout
+        std::vector<VkDescriptorSetLayout> descriptor_set_layouts;
+        u32 set_count = sets.empty() ? 0 : sets.rbegin()->first + 1;
+        for (u32 set = 0; set < set_count; ++set) {
+            std::vector<VkDescriptorSetLayoutBinding> bindings;
+            for (const auto& [binding_number, binding] : sets[set]) {
+                bindings.push_back(binding);
+            }
+            descriptor_set_layouts.push_back(get_cached_descriptor_set_layout(vulkan, bindings));
+        }
+
+        VulkanLayoutKey key;
+        for (VkDescriptorSetLayout descriptor_set_layout : descriptor_set_layouts) {
+            add_handle_to_key(key, descriptor_set_layout);
+        }
+        key.push_back(~0u); // Separates the set layouts from the push constant ranges
+        for (const VkPushConstantRange& push_constant_range : push_constant_ranges) {
+            key.push_back(push_constant_range.stageFlags);
+            key.push_back(push_constant_range.offset);
+            key.push_back(push_constant_range.size);
+        }
+
+        VulkanPipelineLayoutDescription description{};
+        description.descriptor_set_layouts = descriptor_set_layouts;
+        description.push_constant_ranges = push_constant_ranges;
+
+        VulkanLayoutCache& cache = vulkan.layout_cache;
+        auto iterator = cache.pipeline_layouts.find(key);
+        if (iterator != cache.pipeline_layouts.end()) {
+            description.layout = iterator->second;
+            return description;
+        }
+
+        VkPipelineLayoutCreateInfo pipeline_layout_create_info{};
+        pipeline_layout_create_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+        pipeline_layout_create_info.setLayoutCount = (u32) descriptor_set_layouts.size();
+        pipeline_layout_create_info.pSetLayouts = descriptor_set_layouts.data();
+        pipeline_layout_create_info.pushConstantRangeCount = (u32) push_constant_ranges.size();
+        pipeline_layout_create_info.pPushConstantRanges = push_constant_ranges.data();
+
+        VkPipelineLayout pipeline_layout;
+        if (vkCreatePipelineLayout(vulkan.device, &pipeline_layout_create_info, GM_VK_ALLOCATOR, &pipeline_layout) != VK_SUCCESS) {
+            GM_THROW("Could not create Vulkan pipeline layout");
+        }
+
+        std::string pipeline_layout_name = std::format("PipelineLayout {}", cache.pipeline_layouts.size());
+        set_vulkan_object_name(vulkan.device, pipeline_layout, VK_OBJECT_TYPE_PIPELINE_LAYOUT, pipeline_layout_name.c_str());
+
+        cache.pipeline_layouts.emplace(std::move(key), pipeline_layout);
+        GM_LOG_DEBUG("Created [{}] with [{}] descriptor sets and [{}] push constant ranges", pipeline_layout_name, descriptor_set_layouts.size(), push_constant_ranges.size());
+        description.layout = pipeline_layout;
+        return description;
+    }
+
+    void destroy_vulkan_layout_cache(const Vulkan& vulkan) {
+        VulkanLayoutCache& cache = vulkan.layout_cache;
+        std::lock_guard lock(cache.mutex);
+        for (const auto& [key, pipeline_layout] : cache.pipeline_layouts) {
+            vkDestroyPipelineLayout(vulkan.device, pipeline_layout, GM_VK_ALLOCATOR);
+        }
+        for (const auto& [key, descriptor_set_layout] : cache.descriptor_set_layouts) {
+            vkDestroyDescriptorSetLayout(vulkan.device, descriptor_set_layout, GM_VK_ALLOCATOR);
+        }
+        cache.pipeline_layouts.clear();
+        cache.descriptor_set_layouts.clear();
+    }
+}
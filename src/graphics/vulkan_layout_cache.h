@@ -0,0 +1,27 @@
+#pragma once
+
+#include "spirv_reflection.h"
+#include "vulkan.h"
+
+#include <span>
+
+namespace Game {
+    struct VulkanPipelineLayoutDescription {
+        VkPipelineLayout layout = nullptr;
+        std::vector<VkDescriptorSetLayout> descriptor_set_layouts;
+        std::vector<VkPushConstantRange> push_constant_ranges;
+    };
+
+    // Creates the layout on the first request for a set of bindings, and returns the same layout for every later one.
+    VkDescriptorSetLayout get_vulkan_descriptor_set_layout(const Vulkan& vulkan, std::span<const VkDescriptorSetLayoutBinding> bindings);
+
+    // Merges the descriptor bindings and push constants of the stages of a pipeline into a shared pipeline layout.
+    // Throws if two stages declare the same binding differently.
+    VkPipelineLayout get_vulkan_pipeline_layout(const Vulkan& vulkan, std::span<const ShaderReflection> shaders);
+
+    // The pipeline layout together with what it was created from, which shader objects are created with instead.
+    VulkanPipelineLayoutDescription get_vulkan_pipeline_layout_description(const Vulkan& vulkan, std::span<const ShaderReflection> shaders);
+
+    // Call when no pipeline uses the layouts anymore.
+    void destroy_vulkan_layout_cache(const Vulkan& vulkan);
+}
@@ -1,16 +1,58 @@
 #include "vulkan_physical_device.h"
+#include "system/file.h"
+#include "system/hash.h"
+
+#include <fstream>
 
 namespace Game {
+    // The physical device cache file is a PhysicalDeviceCacheHeader followed by an array of PhysicalDeviceCapabilities
+    constexpr char physical_device_cache_magic[8] = {'G', 'M', 'P', 'D', 'C', '0', '0', '1'};
+    constexpr u32 physical_device_cache_version = 1;
+    constexpr u32 max_cached_extension_count = 32;
+    constexpr u32 max_cached_queue_family_count = 16;
+
+    // What is queried from a device apart from the surface, which only changes with the driver. Fixed size, so that it
+    // is written to and read from the cache file as is.
+    struct PhysicalDeviceCapabilities {
+        u8 uuid[VK_UUID_SIZE]{};
+        u32 vendor_id = 0;
+        u32 device_id = 0;
+        u32 driver_version = 0;
+        u32 api_version = 0;
+        VkPhysicalDeviceFeatures features{};
+        VulkanOptionalFeatures optional_features{};
+        VkFormat depth_format = VK_FORMAT_UNDEFINED;
+        u32 extension_count = 0;
+        VkExtensionProperties extensions[max_cached_extension_count]{};
+        u32 queue_family_count = 0;
+        VkQueueFamilyProperties queue_families[max_cached_queue_family_count]{};
+    };
+
+    static_assert(std::is_trivially_copyable_v<PhysicalDeviceCapabilities>);
+
+    struct PhysicalDeviceCacheHeader {
+        char magic[8];
+        u32 version = physical_device_cache_version;
+        u32 capabilities_size = sizeof(PhysicalDeviceCapabilities); // Changes with the Vulkan headers and the optional features
+        u64 extension_names_hash = 0; // Of the extensions that are looked for, which are the only ones that are cached
+        u32 device_count = 0;
+        u32 reserved = 0;
+    };
+
     struct PhysicalDeviceInfo {
         VkPhysicalDevice physical_device = nullptr;
         VkPhysicalDeviceProperties properties{};
+        u8 uuid[VK_UUID_SIZE]{};
         VkPhysicalDeviceFeatures features{};
         std::vector<VkExtensionProperties> extensions{};
+        std::vector<VkQueueFamilyProperties> queue_families;
         VkSurfaceCapabilitiesKHR surface_capabilities{};
         std::vector<VkSurfaceFormatKHR> surface_formats;
         std::vector<VkPresentModeKHR> present_modes;
         QueueFamilyIndices queue_family_indices{};
         VkFormat depth_format = VK_FORMAT_UNDEFINED;
+        VulkanOptionalFeatures optional_features{};
+        bool cached = false; // Everything but the properties and the surface came from the physical device cache
     };
 
     std::vector<const char*> get_required_extensions() {
@@ -23,6 +65,25 @@ namespace Game {
         return extensions;
     }
 
+    // Enabled when available, the features that need them are only used if they are supported as well
+    std::vector<const char*> get_optional_extensions() {
+        return {
+            VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME,
+            VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME,
+            VK_EXT_SHADER_OBJECT_EXTENSION_NAME,
+            VK_EXT_EXTENDED_DYNAMIC_STATE_3_EXTENSION_NAME,
+        };
+    }
+
+    bool has_extension(const std::vector<VkExtensionProperties>& extensions, const char* extension_name) {
+        for (const VkExtensionProperties& extension : extensions) {
+            if (strcmp(extension.extensionName, extension_name) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
     std::vector<VkExtensionProperties> get_available_extensions(VkPhysicalDevice physical_device) {
         const char* layer_name = nullptr;
         u32 extension_count = 0;
@@ -88,35 +149,98 @@ namespace Game {
         return available_device_features.samplerAnisotropy;
     }
 
-    u32 get_suitability_rating(
-        const PhysicalDeviceInfo& physical_device_info,
-        const std::vector<const char*>& required_extensions
-    ) {
+    bool has_dedicated_queue_family(const std::vector<VkQueueFamilyProperties>& queue_families, VkQueueFlags flag, VkQueueFlags excluded_flags) {
+        for (const VkQueueFamilyProperties& queue_family : queue_families) {
+            if ((queue_family.queueFlags & flag) != 0 && (queue_family.queueFlags & excluded_flags) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool has_dedicated_transfer_queue_family(const std::vector<VkQueueFamilyProperties>& queue_families) {
+        return has_dedicated_queue_family(queue_families, VK_QUEUE_TRANSFER_BIT, VK_QUEUE_GRAPHICS_BIT | VK_QUEUE_COMPUTE_BIT);
+    }
+
+    bool has_dedicated_compute_queue_family(const std::vector<VkQueueFamilyProperties>& queue_families) {
+        return has_dedicated_queue_family(queue_families, VK_QUEUE_COMPUTE_BIT, VK_QUEUE_GRAPHICS_BIT);
+    }
+
+    // What doesn't depend on the surface, checked before the surface is queried. Empty if the device is suitable.
+    std::string get_unsuitable_device_reason(const PhysicalDeviceInfo& physical_device_info, const std::vector<const char*>& required_extensions) {
         if (!has_extensions(required_extensions, physical_device_info.extensions)) {
-            GM_LOG_DEBUG("[{}] does not have required device extensions", physical_device_info.properties.deviceName);
-            return 0;
+            return "does not have required device extensions";
         }
         if (!has_required_features(physical_device_info.features)) {
-            GM_LOG_DEBUG("[{}] does not have required device features", physical_device_info.properties.deviceName);
-            return 0;
+            return "does not have required device features";
+        }
+        if (physical_device_info.depth_format == VK_FORMAT_UNDEFINED) {
+            return "does not have a suitable depth format";
         }
+        if (!has_dedicated_queue_family(physical_device_info.queue_families, VK_QUEUE_GRAPHICS_BIT, 0)) {
+            return "does not have a graphics queue family";
+        }
+        return "";
+    }
+
+    std::string get_unsuitable_surface_reason(const PhysicalDeviceInfo& physical_device_info) {
         if (!has_required_queue_family_indices(physical_device_info.queue_family_indices)) {
-            GM_LOG_DEBUG("[{}] does not have required queue family indices", physical_device_info.properties.deviceName);
-            return 0;
+            return "does not have required queue family indices";
         }
         if (!has_required_swap_chain_support(physical_device_info.surface_formats, physical_device_info.present_modes)) {
-            GM_LOG_DEBUG("[{}] does not have required swap chain info", physical_device_info.properties.deviceName);
-            return 0;
+            return "does not have required swap chain info";
         }
-        if (physical_device_info.depth_format == VK_FORMAT_UNDEFINED) {
-            GM_LOG_DEBUG("[{}] does not have a suitable depth format", physical_device_info.properties.deviceName);
-            return 0;
+        return "";
+    }
+
+    // The device type outweighs everything else, then how well the queue families fit, then the optional features
+    // that are supported. The largest image size only breaks ties.
+    u32 get_physical_device_score(const PhysicalDeviceInfo& physical_device_info) {
+        u32 score = 0;
+        switch (physical_device_info.properties.deviceType) {
+            case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU:
+                score += 10000;
+                break;
+            case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU:
+                score += 5000;
+                break;
+            case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU:
+                score += 2000;
+                break;
+            case VK_PHYSICAL_DEVICE_TYPE_CPU:
+                score += 1000;
+                break;
+            default:
+                break;
         }
-        u32 rating = physical_device_info.properties.limits.maxImageDimension2D;
-        if (physical_device_info.properties.deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU) {
-            rating += 1000;
+
+        // Presenting from the graphics queue family needs no ownership transfer of the swap chain images
+        const QueueFamilyIndices& queue_family_indices = physical_device_info.queue_family_indices;
+        if (queue_family_indices.graphics_family == queue_family_indices.present_family) {
+            score += 1000;
         }
-        return rating;
+        if (has_dedicated_transfer_queue_family(physical_device_info.queue_families)) {
+            score += 200;
+        }
+        if (has_dedicated_compute_queue_family(physical_device_info.queue_families)) {
+            score += 200;
+        }
+
+        const VulkanOptionalFeatures& optional_features = physical_device_info.optional_features;
+        for (bool supported : {
+            optional_features.graphics_pipeline_library,
+            optional_features.shader_object,
+            optional_features.extended_dynamic_state,
+            optional_features.extended_dynamic_state3_polygon_mode,
+            optional_features.extended_dynamic_state3_color_blend,
+        }) {
+            if (supported) {
+                score += 100;
+            }
+        }
+
+        score += std::min(physical_device_info.properties.limits.maxImageDimension2D / 1024, 99u);
+        return score;
     }
 
     VkFormat get_depth_format(VkPhysicalDevice physical_device) {
@@ -168,35 +292,53 @@ namespace Game {
         return present_modes;
     }
 
-    QueueFamilyIndices get_queue_family_indices(VkPhysicalDevice physical_device, VkSurfaceKHR surface) {
+    std::vector<VkQueueFamilyProperties> get_queue_families(VkPhysicalDevice physical_device) {
         u32 queue_family_count = 0;
         vkGetPhysicalDeviceQueueFamilyProperties(physical_device, &queue_family_count, nullptr);
 
         std::vector<VkQueueFamilyProperties> queue_families(queue_family_count);
         vkGetPhysicalDeviceQueueFamilyProperties(physical_device, &queue_family_count, queue_families.data());
+        return queue_families;
+    }
 
+    // Prefers a queue family that can both draw and present, so that the swap chain images stay in one family
+    QueueFamilyIndices get_queue_family_indices(VkPhysicalDevice physical_device, VkSurfaceKHR surface, const std::vector<VkQueueFamilyProperties>& queue_families) {
         QueueFamilyIndices indices;
         for (u32 queue_family_index = 0; queue_family_index < queue_families.size(); queue_family_index++) {
             const VkQueueFamilyProperties& queue_family = queue_families[queue_family_index];
-            if (queue_family.queueFlags & VK_QUEUE_GRAPHICS_BIT) {
-                indices.graphics_family = queue_family_index;
-            }
+            bool graphics_support = (queue_family.queueFlags & VK_QUEUE_GRAPHICS_BIT) != 0;
             VkBool32 presentation_support = false;
             vkGetPhysicalDeviceSurfaceSupportKHR(physical_device, queue_family_index, surface, &presentation_support);
-            if (presentation_support) {
+            if (graphics_support && presentation_support) {
+                indices.graphics_family = queue_family_index;
                 indices.present_family = queue_family_index;
-            }
-            if (has_required_queue_family_indices(indices)) {
                 break;
             }
+            if (graphics_support && !indices.graphics_family.has_value()) {
+                indices.graphics_family = queue_family_index;
+            }
+            if (presentation_support && !indices.present_family.has_value()) {
+                indices.present_family = queue_family_index;
+            }
         }
         return indices;
     }
 
-    VkPhysicalDeviceProperties get_properties(VkPhysicalDevice physical_device) {
-        VkPhysicalDeviceProperties properties;
+    // The UUID identifies the device across runs, unlike its handle or its index. It stays zero before Vulkan 1.1.
+    void get_properties(VkPhysicalDevice physical_device, VkPhysicalDeviceProperties& properties, u8* uuid) {
         vkGetPhysicalDeviceProperties(physical_device, &properties);
-        return properties;
+        if (properties.apiVersion < VK_API_VERSION_1_1) {
+            return;
+        }
+
+        VkPhysicalDeviceIDProperties id_properties{};
+        id_properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_ID_PROPERTIES;
+
+        VkPhysicalDeviceProperties2 properties2{};
+        properties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+        properties2.pNext = &id_properties;
+        vkGetPhysicalDeviceProperties2(physical_device, &properties2);
+        std::memcpy(uuid, id_properties.deviceUUID, VK_UUID_SIZE);
     }
 
     VkPhysicalDeviceFeatures get_features(VkPhysicalDevice physical_device) {
@@ -205,40 +347,315 @@ namespace Game {
         return features;
     }
 
+    VulkanOptionalFeatures get_optional_features(VkPhysicalDevice physical_device, const VkPhysicalDeviceProperties& properties, const std::vector<VkExtensionProperties>& extensions) {
+        VulkanOptionalFeatures optional_features{};
+        // The extended feature queries are core in Vulkan 1.1
+        if (properties.apiVersion < VK_API_VERSION_1_1) {
+            return optional_features;
+        }
+
+        bool graphics_pipeline_library_supported = has_extension(extensions, VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME)
+            && has_extension(extensions, VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME);
+        // Drawing with shader objects uses the dynamic rendering and dynamic state commands of Vulkan 1.3
+        bool shader_object_supported = properties.apiVersion >= VK_API_VERSION_1_3
+            && has_extension(extensions, VK_EXT_SHADER_OBJECT_EXTENSION_NAME);
+        bool extended_dynamic_state3_supported = has_extension(extensions, VK_EXT_EXTENDED_DYNAMIC_STATE_3_EXTENSION_NAME);
+
+        // Only the structures of supported extensions are chained onto the queries
+        void* next_features = nullptr;
+
+        VkPhysicalDeviceDynamicRenderingFeatures dynamic_rendering_features{};
+        dynamic_rendering_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES;
+
+        VkPhysicalDeviceShaderObjectFeaturesEXT shader_object_features{};
+        shader_object_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SHADER_OBJECT_FEATURES_EXT;
+
+        if (shader_object_supported) {
+            dynamic_rendering_features.pNext = next_features;
+            shader_object_features.pNext = &dynamic_rendering_features;
+            next_features = &shader_object_features;
+        }
+
+        VkPhysicalDeviceExtendedDynamicState3FeaturesEXT extended_dynamic_state3_features{};
+        extended_dynamic_state3_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_EXTENDED_DYNAMIC_STATE_3_FEATURES_EXT;
+
+        if (extended_dynamic_state3_supported) {
+            extended_dynamic_state3_features.pNext = next_features;
+            next_features = &extended_dynamic_state3_features;
+        }
+
+        VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT graphics_pipeline_library_features{};
+        graphics_pipeline_library_features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT;
+
+        if (graphics_pipeline_library_supported) {
+            graphics_pipeline_library_features.pNext = next_features;
+            next_features = &graphics_pipeline_library_features;
+        }
+
+        VkPhysicalDeviceFeatures2 features{};
+        features.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+        features.pNext = next_features;
+        vkGetPhysicalDeviceFeatures2(physical_device, &features);
+
+        VkPhysicalDeviceGraphicsPipelineLibraryPropertiesEXT graphics_pipeline_library_properties{};
+        graphics_pipeline_library_properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_PROPERTIES_EXT;
+
+        VkPhysicalDeviceProperties2 properties2{};
+        properties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+        properties2.pNext = graphics_pipeline_library_supported ? &graphics_pipeline_library_properties : nullptr;
+        vkGetPhysicalDeviceProperties2(physical_device, &properties2);
+
+        optional_features.graphics_pipeline_library = graphics_pipeline_library_supported
+            && graphics_pipeline_library_features.graphicsPipelineLibrary
+            && graphics_pipeline_library_properties.graphicsPipelineLibraryFastLinking;
+
+        optional_features.shader_object = shader_object_supported
+            && shader_object_features.shaderObject
+            && dynamic_rendering_features.dynamicRendering;
+
+        // Extended dynamic state 1 and 2 are core in Vulkan 1.3, apart from the logic op and patch control points
+        optional_features.extended_dynamic_state = properties.apiVersion >= VK_API_VERSION_1_3;
+
+        optional_features.extended_dynamic_state3_polygon_mode = extended_dynamic_state3_supported
+            && extended_dynamic_state3_features.extendedDynamicState3PolygonMode;
+
+        optional_features.extended_dynamic_state3_color_blend = extended_dynamic_state3_supported
+            && extended_dynamic_state3_features.extendedDynamicState3ColorBlendEnable
+            && extended_dynamic_state3_features.extendedDynamicState3ColorBlendEquation;
+
+        return optional_features;
+    }
+
+    std::string get_uuid_string(const u8* uuid) {
+        std::string uuid_string;
+        for (u32 i = 0; i < VK_UUID_SIZE; ++i) {
+            uuid_string += std::format("{:02x}", uuid[i]);
+        }
+        return uuid_string;
+    }
+
+    const char* get_physical_device_type_name(VkPhysicalDeviceType type) {
+        switch (type) {
+            case VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU:
+                return "Discrete";
+            case VK_PHYSICAL_DEVICE_TYPE_INTEGRATED_GPU:
+                return "Integrated";
+            case VK_PHYSICAL_DEVICE_TYPE_VIRTUAL_GPU:
+                return "Virtual";
+            case VK_PHYSICAL_DEVICE_TYPE_CPU:
+                return "CPU";
+            default:
+                return "Other";
+        }
+    }
+
+    // FNV-1a of the names
+    u64 get_extension_names_hash(const std::vector<const char*>& extension_names) {
+        u64 hash = fnv1a_offset_basis;
+        for (const char* extension_name : extension_names) {
+            hash = hash_bytes(hash, extension_name);
+            hash = hash_byte(hash, 0); // Separates the names
+        }
+        return hash;
+    }
+
+    // Returns nothing if the file is missing, unreadable, corrupt or was written by another version or with other extensions
+    std::vector<PhysicalDeviceCapabilities> read_physical_device_cache(const std::filesystem::path& path, u64 extension_names_hash) {
+        if (!std::filesystem::exists(path)) {
+            return {};
+        }
+        std::vector<char> bytes;
+        try {
+            bytes = read_bytes(path);
+        } catch (const std::exception& e) {
+            GM_LOG_DEBUG("Ignoring physical device cache [{}], it could not be read: {}", path.string(), e.what());
+            return {};
+        }
+        PhysicalDeviceCacheHeader header{};
+        if (bytes.size() < sizeof(header)) {
+            GM_LOG_DEBUG("Ignoring physical device cache [{}], it is truncated", path.string());
+            return {};
+        }
+        std::memcpy(&header, bytes.data(), sizeof(header));
+        if (std::memcmp(header.magic, physical_device_cache_magic, sizeof(header.magic)) != 0
+            || header.version != physical_device_cache_version
+            || header.capabilities_size != sizeof(PhysicalDeviceCapabilities)
+            || header.extension_names_hash != extension_names_hash
+            || bytes.size() != sizeof(header) + (u64) header.device_count * sizeof(PhysicalDeviceCapabilities)) {
+            GM_LOG_DEBUG("Ignoring physical device cache [{}], it was written by another version", path.string());
+            return {};
+        }
+        std::vector<PhysicalDeviceCapabilities> capabilities(header.device_count);
+        std::memcpy(capabilities.data(), bytes.data() + sizeof(header), header.device_count * sizeof(PhysicalDeviceCapabilities));
+
+        // The counts index the fixed size arrays, so a corrupt entry would read past them
+        for (const PhysicalDeviceCapabilities& device_capabilities : capabilities) {
+            if (device_capabilities.extension_count > max_cached_extension_count || device_capabilities.queue_family_count > max_cached_queue_family_count) {
+                GM_LOG_DEBUG("Ignoring physical device cache [{}], it is corrupt", path.string());
+                return {};
+            }
+        }
+        return capabilities;
+    }
+
+    // Through a temporary file, so that a crash while writing doesn't leave a truncated file behind. Failing to save
+    // only costs the next run the queries.
+    void write_physical_device_cache(const std::filesystem::path& path, u64 extension_names_hash, const std::vector<PhysicalDeviceCapabilities>& capabilities) {
+        PhysicalDeviceCacheHeader header{};
+        std::memcpy(header.magic, physical_device_cache_magic, sizeof(header.magic));
+        header.extension_names_hash = extension_names_hash;
+        header.device_count = (u32) capabilities.size();
+
+        std::filesystem::path temporary_path = path;
+        temporary_path += ".tmp";
+        {
+            std::ofstream file(temporary_path, std::ios::binary | std::ios::trunc);
+            file.write((const char*) &header, sizeof(header));
+            file.write((const char*) capabilities.data(), (std::streamsize) (capabilities.size() * sizeof(PhysicalDeviceCapabilities)));
+            if (!file) {
+                GM_LOG_WARNING("Could not write physical device cache [{}]", temporary_path.string());
+                return;
+            }
+        }
+        std::error_code error;
+        std::filesystem::rename(temporary_path, path, error);
+        if (error) {
+            GM_LOG_WARNING("Could not replace physical device cache [{}]: {}", path.string(), error.message());
+            return;
+        }
+        GM_LOG_DEBUG("Wrote capabilities of [{}] physical devices to [{}]", capabilities.size(), path.string());
+    }
+
+    // The capabilities of the same device with the same driver
+    const PhysicalDeviceCapabilities* find_cached_capabilities(const std::vector<PhysicalDeviceCapabilities>& cached_capabilities, const PhysicalDeviceInfo& physical_device_info) {
+        const VkPhysicalDeviceProperties& properties = physical_device_info.properties;
+        for (const PhysicalDeviceCapabilities& capabilities : cached_capabilities) {
+            if (std::memcmp(capabilities.uuid, physical_device_info.uuid, VK_UUID_SIZE) == 0
+                && capabilities.vendor_id == properties.vendorID
+                && capabilities.device_id == properties.deviceID
+                && capabilities.driver_version == properties.driverVersion
+                && capabilities.api_version == properties.apiVersion) {
+                return &capabilities;
+            }
+        }
+        return nullptr;
+    }
+
+    // Returns nothing if the device has more extensions or queue families than fit in the cache
+    std::optional<PhysicalDeviceCapabilities> get_capabilities(const PhysicalDeviceInfo& physical_device_info) {
+        if (physical_device_info.extensions.size() > max_cached_extension_count || physical_device_info.queue_families.size() > max_cached_queue_family_count) {
+            return std::nullopt;
+        }
+        PhysicalDeviceCapabilities capabilities{};
+        std::memcpy(capabilities.uuid, physical_device_info.uuid, VK_UUID_SIZE);
+        capabilities.vendor_id = physical_device_info.properties.vendorID;
+        capabilities.device_id = physical_device_info.properties.deviceID;
+        capabilities.driver_version = physical_device_info.properties.driverVersion;
+        capabilities.api_version = physical_device_info.properties.apiVersion;
+        capabilities.features = physical_device_info.features;
+        capabilities.optional_features = physical_device_info.optional_features;
+        capabilities.depth_format = physical_device_info.depth_format;
+        capabilities.extension_count = (u32) physical_device_info.extensions.size();
+        std::copy(physical_device_info.extensions.begin(), physical_device_info.extensions.end(), capabilities.extensions);
+        capabilities.queue_family_count = (u32) physical_device_info.queue_families.size();
+        std::copy(physical_device_info.queue_families.begin(), physical_device_info.queue_families.end(), capabilities.queue_families);
+        return capabilities;
+    }
+
+    // Everything but the surface, from the cache if the device and its driver haven't changed since it was written
     PhysicalDeviceInfo get_physical_device_info(
-        const Vulkan& vulkan,
         VkPhysicalDevice physical_device,
-        const std::vector<const char*>& required_extensions
+        const std::vector<const char*>& extensions,
+        const std::vector<PhysicalDeviceCapabilities>& cached_capabilities
     ) {
         PhysicalDeviceInfo physical_device_info{};
         physical_device_info.physical_device = physical_device;
-        physical_device_info.properties = get_properties(physical_device);
+        get_properties(physical_device, physical_device_info.properties, physical_device_info.uuid);
+
+        const PhysicalDeviceCapabilities* capabilities = find_cached_capabilities(cached_capabilities, physical_device_info);
+        if (capabilities != nullptr) {
+            physical_device_info.features = capabilities->features;
+            physical_device_info.extensions.assign(capabilities->extensions, capabilities->extensions + capabilities->extension_count);
+            physical_device_info.queue_families.assign(capabilities->queue_families, capabilities->queue_families + capabilities->queue_family_count);
+            physical_device_info.depth_format = capabilities->depth_format;
+            physical_device_info.optional_features = capabilities->optional_features;
+            physical_device_info.cached = true;
+            return physical_device_info;
+        }
+
         physical_device_info.features = get_features(physical_device);
-        physical_device_info.extensions = get_extensions(physical_device, required_extensions);
-        physical_device_info.queue_family_indices = get_queue_family_indices(physical_device, vulkan.surface);
+        physical_device_info.extensions = get_extensions(physical_device, extensions);
+        physical_device_info.queue_families = get_queue_families(physical_device);
+        physical_device_info.depth_format = get_depth_format(physical_device);
+        physical_device_info.optional_features = get_optional_features(physical_device, physical_device_info.properties, physical_device_info.extensions);
+        return physical_device_info;
+    }
+
+    // The surface can change between runs, so it is always queried
+    void get_surface_info(const Vulkan& vulkan, PhysicalDeviceInfo& physical_device_info) {
+        VkPhysicalDevice physical_device = physical_device_info.physical_device;
+        physical_device_info.queue_family_indices = get_queue_family_indices(physical_device, vulkan.surface, physical_device_info.queue_families);
         physical_device_info.surface_capabilities = get_surface_capabilities(physical_device, vulkan.surface);
         physical_device_info.surface_formats = get_surface_formats(physical_device, vulkan.surface);
         physical_device_info.present_modes = get_present_modes(physical_device, vulkan.surface);
-        physical_device_info.depth_format = get_depth_format(physical_device);
-        return physical_device_info;
     }
 
-    PhysicalDeviceInfo get_most_suitable_physical_device(
-        const Vulkan& vulkan,
-        const std::vector<VkPhysicalDevice>& available_devices,
-        const std::vector<const char*>& required_extensions
-    ) {
-        std::multimap<u32 , PhysicalDeviceInfo> devices_by_rating;
-        for (VkPhysicalDevice available_device : available_devices) {
-            PhysicalDeviceInfo physical_device_info = get_physical_device_info(vulkan, available_device, required_extensions);
-            u32 suitability_rating = get_suitability_rating(physical_device_info, required_extensions);
-            devices_by_rating.insert(std::make_pair(suitability_rating, physical_device_info));
+    VulkanPhysicalDeviceReport get_physical_device_report(const PhysicalDeviceInfo& physical_device_info) {
+        const VkPhysicalDeviceProperties& properties = physical_device_info.properties;
+        const QueueFamilyIndices& queue_family_indices = physical_device_info.queue_family_indices;
+        VulkanPhysicalDeviceReport report{};
+        report.name = properties.deviceName;
+        report.uuid = get_uuid_string(physical_device_info.uuid);
+        report.type = properties.deviceType;
+        report.vendor_id = properties.vendorID;
+        report.device_id = properties.deviceID;
+        report.driver_version = properties.driverVersion;
+        report.api_version = properties.apiVersion;
+        report.queue_family_count = (u32) physical_device_info.queue_families.size();
+        report.graphics_present_queue_shared = has_required_queue_family_indices(queue_family_indices) && queue_family_indices.graphics_family == queue_family_indices.present_family;
+        report.dedicated_transfer_queue = has_dedicated_transfer_queue_family(physical_device_info.queue_families);
+        report.dedicated_compute_queue = has_dedicated_compute_queue_family(physical_device_info.queue_families);
+        report.depth_format = physical_device_info.depth_format;
+        report.optional_features = physical_device_info.optional_features;
+        report.cached = physical_device_info.cached;
+        return report;
+    }
+
+    // Case and dashes are ignored, so that the UUID can be copied from other tools
+    std::string normalize_uuid_string(std::string_view uuid) {
+        std::string normalized_uuid;
+        for (char c : uuid) {
+            if (c != '-') {
+                normalized_uuid += (char) std::tolower((unsigned char) c);
+            }
         }
-        u32 highest_rating = devices_by_rating.rbegin()->first;
-        if (highest_rating == 0) {
-            return {};
+        return normalized_uuid;
+    }
+
+    // The device with the UUID in the config if it is suitable, otherwise the highest scoring suitable device
+    std::optional<u32> get_picked_physical_device_index(const Vulkan& vulkan, const std::vector<VulkanPhysicalDeviceReport>& reports) {
+        if (!vulkan.config.physical_device_uuid.empty()) {
+            std::string uuid = normalize_uuid_string(vulkan.config.physical_device_uuid);
+            for (u32 i = 0; i < reports.size(); ++i) {
+                if (reports[i].uuid != uuid) {
+                    continue;
+                }
+                if (reports[i].unsuitable_reason.empty()) {
+                    return i;
+                }
+                GM_LOG_WARNING("Physical device [{}] with UUID [{}] {}, picking another device", reports[i].name, uuid, reports[i].unsuitable_reason);
+                break;
+            }
+            GM_LOG_WARNING("Could not find a suitable physical device with UUID [{}], picking another device", uuid);
         }
-        return devices_by_rating.rbegin()->second;
+
+        std::optional<u32> picked_index;
+        for (u32 i = 0; i < reports.size(); ++i) {
+            if (reports[i].unsuitable_reason.empty() && (!picked_index.has_value() || reports[i].score > reports[*picked_index].score)) {
+                picked_index = i;
+            }
+        }
+        return picked_index;
     }
 
     std::vector<VkPhysicalDevice> get_available_physical_devices(const Vulkan& vulkan) {
@@ -259,11 +676,60 @@ namespace Game {
             GM_THROW("Could not find any available physical device");
         }
 
-        PhysicalDeviceInfo most_suitable_device_info = get_most_suitable_physical_device(vulkan, available_devices, get_required_extensions());
-        if (!most_suitable_device_info.physical_device) {
+        std::vector<const char*> required_extensions = get_required_extensions();
+        std::vector<const char*> extensions = required_extensions;
+        for (const char* optional_extension : get_optional_extensions()) {
+            extensions.push_back(optional_extension);
+        }
+
+        const std::filesystem::path& cache_path = vulkan.config.physical_device_cache_path;
+        u64 extension_names_hash = get_extension_names_hash(extensions);
+        std::vector<PhysicalDeviceCapabilities> cached_capabilities;
+        if (!cache_path.empty()) {
+            cached_capabilities = read_physical_device_cache(cache_path, extension_names_hash);
+        }
+
+        std::vector<PhysicalDeviceInfo> physical_device_infos;
+        std::vector<VulkanPhysicalDeviceReport> reports;
+        for (VkPhysicalDevice available_device : available_devices) {
+            PhysicalDeviceInfo& physical_device_info = physical_device_infos.emplace_back(get_physical_device_info(available_device, extensions, cached_capabilities));
+
+            // The surface is only queried for devices that could be used otherwise
+            std::string unsuitable_reason = get_unsuitable_device_reason(physical_device_info, required_extensions);
+            if (unsuitable_reason.empty()) {
+                get_surface_info(vulkan, physical_device_info);
+                unsuitable_reason = get_unsuitable_surface_reason(physical_device_info);
+            }
+
+            VulkanPhysicalDeviceReport& report = reports.emplace_back(get_physical_device_report(physical_device_info));
+            report.unsuitable_reason = unsuitable_reason;
+            report.score = unsuitable_reason.empty() ? get_physical_device_score(physical_device_info) : 0;
+        }
+
+        // Rewritten when a device was queried, or when a device in it is gone
+        bool cache_changed = cached_capabilities.size() != physical_device_infos.size();
+        std::vector<PhysicalDeviceCapabilities> capabilities;
+        for (const PhysicalDeviceInfo& physical_device_info : physical_device_infos) {
+            cache_changed |= !physical_device_info.cached;
+            if (std::optional<PhysicalDeviceCapabilities> device_capabilities = get_capabilities(physical_device_info)) {
+                capabilities.push_back(*device_capabilities);
+            }
+        }
+        if (!cache_path.empty() && cache_changed) {
+            write_physical_device_cache(cache_path, extension_names_hash, capabilities);
+        }
+
+        std::optional<u32> picked_index = get_picked_physical_device_index(vulkan, reports);
+        if (picked_index.has_value()) {
+            reports[*picked_index].picked = true;
+        }
+        vulkan.physical_device_reports = reports;
+        log_vulkan_physical_device_reports(vulkan);
+        if (!picked_index.has_value()) {
             GM_THROW("Could not find any suitable physical device");
         }
 
+        const PhysicalDeviceInfo& most_suitable_device_info = physical_device_infos[*picked_index];
         GM_LOG_DEBUG("Picked physical device [{}]", most_suitable_device_info.properties.deviceName);
 
         vulkan.physical_device = most_suitable_device_info.physical_device;
@@ -275,5 +741,64 @@ namespace Game {
         vulkan.physical_device_present_modes = most_suitable_device_info.present_modes;
         vulkan.physical_device_queue_family_indices = most_suitable_device_info.queue_family_indices;
         vulkan.physical_device_depth_format = most_suitable_device_info.depth_format;
+        vulkan.physical_device_optional_features = most_suitable_device_info.optional_features;
+        if (!vulkan.config.graphics_pipeline_library_enabled) {
+            vulkan.physical_device_optional_features.graphics_pipeline_library = false;
+        }
+        if (!vulkan.config.shader_object_enabled) {
+            vulkan.physical_device_optional_features.shader_object = false;
+        }
+        if (!vulkan.config.extended_dynamic_state_enabled) {
+            vulkan.physical_device_optional_features.extended_dynamic_state = false;
+            vulkan.physical_device_optional_features.extended_dynamic_state3_polygon_mode = false;
+            vulkan.physical_device_optional_features.extended_dynamic_state3_color_blend = false;
+        }
+        GM_LOG_DEBUG("Graphics pipeline library is [{}]", vulkan.physical_device_optional_features.graphics_pipeline_library ? "used" : "not used");
+        GM_LOG_DEBUG("Shader objects are [{}]", vulkan.physical_device_optional_features.shader_object ? "used" : "not used");
+        GM_LOG_DEBUG("Extended dynamic state is [{}], with polygon mode [{}] and color blend [{}]",
+            vulkan.physical_device_optional_features.extended_dynamic_state ? "used" : "not used",
+            vulkan.physical_device_optional_features.extended_dynamic_state3_polygon_mode ? "used" : "not used",
+            vulkan.physical_device_optional_features.extended_dynamic_state3_color_blend ? "used" : "not used");
+    }
+
+    void log_vulkan_physical_device_reports(const Vulkan& vulkan) {
+        for (const VulkanPhysicalDeviceReport& report : vulkan.physical_device_reports) {
+            GM_LOG_INFO(
+                "Physical device [{}] UUID [{}], type [{}], vendor [{:#06x}], device [{:#06x}], driver [{:#x}], Vulkan [{}.{}.{}]{}{}",
+                report.name,
+                report.uuid,
+                get_physical_device_type_name(report.type),
+                report.vendor_id,
+                report.device_id,
+                report.driver_version,
+                VK_API_VERSION_MAJOR(report.api_version),
+                VK_API_VERSION_MINOR(report.api_version),
+                VK_API_VERSION_PATCH(report.api_version),
+                report.cached ? ", cached" : "",
+                report.picked ? ", picked" : ""
+            );
+            if (!report.unsuitable_reason.empty()) {
+                GM_LOG_INFO("  Not suitable, {}", report.unsuitable_reason);
+                continue;
+            }
+            const VulkanOptionalFeatures& optional_features = report.optional_features;
+            GM_LOG_INFO(
+                "  Score [{}], queue families [{}], graphics and present shared [{}], dedicated transfer [{}], dedicated compute [{}], depth format [{}]",
+                report.score,
+                report.queue_family_count,
+                report.graphics_present_queue_shared,
+                report.dedicated_transfer_queue,
+                report.dedicated_compute_queue,
+                (i32) report.depth_format
+            );
+            GM_LOG_INFO(
+                "  Graphics pipeline library [{}], shader object [{}], extended dynamic state [{}], polygon mode [{}], color blend [{}]",
+                optional_features.graphics_pipeline_library,
+                optional_features.shader_object,
+                optional_features.extended_dynamic_state,
+                optional_features.extended_dynamic_state3_polygon_mode,
+                optional_features.extended_dynamic_state3_color_blend
+            );
+        }
     }
 }
@@ -3,5 +3,10 @@
 #include "vulkan.h"
 
 namespace Game {
+    // Scores every suitable device and picks the highest scoring one, or the one with the UUID in the config. What a
+    // device supports apart from the surface is loaded from the physical device cache if the driver is unchanged.
     void pick_vulkan_physical_device(Vulkan& vulkan);
+
+    // Logs the report of every device from when one was picked.
+    void log_vulkan_physical_device_reports(const Vulkan& vulkan);
 }
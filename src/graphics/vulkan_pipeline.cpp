@@ -1,14 +1,22 @@
 #include "vulkan_pipeline.h"
+#include "embedded_shader.h"
+#include "vulkan_layout_cache.h"
 #include "system/file.h"
+#include "system/hash.h"
+
+#include <fstream>
 
 namespace Game {
-    VkShaderModule create_shader_module(VkDevice device, const std::filesystem::path& shader_path) {
-        std::vector<char> shader_bytes = read_bytes(shader_path);
+    // The driver only reads the code while creating the module, so it can be read straight from a mapped file
+    VkShaderModule create_shader_module(VkDevice device, std::span<const u8> shader_code) {
+        if (shader_code.empty() || shader_code.size() % sizeof(u32) != 0 || (uintptr_t) shader_code.data() % alignof(u32) != 0) {
+            GM_THROW("Invalid SPIR-V shader code of [" << shader_code.size() << "] bytes");
+        }
 
         VkShaderModuleCreateInfo shader_module_create_info{};
         shader_module_create_info.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-        shader_module_create_info.codeSize = shader_bytes.size();
-        shader_module_create_info.pCode = reinterpret_cast<const u32*>(shader_bytes.data());
+        shader_module_create_info.codeSize = shader_code.size();
+        shader_module_create_info.pCode = reinterpret_cast<const u32*>(shader_code.data());
 
         VkShaderModule shader_module;
         if (vkCreateShaderModule(device, &shader_module_create_info, GM_VK_ALLOCATOR, &shader_module) != VK_SUCCESS) {
@@ -18,119 +26,169 @@ namespace Game {
         return shader_module;
     }
 
-    void create_vulkan_pipeline(Vulkan& vulkan, const PipelineConfig& config) {
+    // The viewport and scissor are always dynamic, the rest of the state is dynamic when the device supports it
+    std::vector<VkDynamicState> get_dynamic_states(const VulkanOptionalFeatures& optional_features) {
+        std::vector<VkDynamicState> dynamic_states = {
+            VK_DYNAMIC_STATE_VIEWPORT,
+            VK_DYNAMIC_STATE_SCISSOR
+        };
+        if (optional_features.extended_dynamic_state) {
+            dynamic_states.push_back(VK_DYNAMIC_STATE_CULL_MODE);
+            dynamic_states.push_back(VK_DYNAMIC_STATE_FRONT_FACE);
+            dynamic_states.push_back(VK_DYNAMIC_STATE_PRIMITIVE_TOPOLOGY);
+            dynamic_states.push_back(VK_DYNAMIC_STATE_DEPTH_TEST_ENABLE);
+            dynamic_states.push_back(VK_DYNAMIC_STATE_DEPTH_WRITE_ENABLE);
+            dynamic_states.push_back(VK_DYNAMIC_STATE_DEPTH_COMPARE_OP);
+            dynamic_states.push_back(VK_DYNAMIC_STATE_RASTERIZER_DISCARD_ENABLE);
+            dynamic_states.push_back(VK_DYNAMIC_STATE_DEPTH_BIAS_ENABLE);
+            dynamic_states.push_back(VK_DYNAMIC_STATE_PRIMITIVE_RESTART_ENABLE);
+        }
+        if (optional_features.extended_dynamic_state3_polygon_mode) {
+            dynamic_states.push_back(VK_DYNAMIC_STATE_POLYGON_MODE_EXT);
+        }
+        if (optional_features.extended_dynamic_state3_color_blend) {
+            dynamic_states.push_back(VK_DYNAMIC_STATE_COLOR_BLEND_ENABLE_EXT);
+            dynamic_states.push_back(VK_DYNAMIC_STATE_COLOR_BLEND_EQUATION_EXT);
+        }
+        return dynamic_states;
+    }
+
+    void create_vulkan_pipeline(const Vulkan& vulkan, VulkanPipeline& pipeline, const PipelineConfig& config) {
 
         //
         // Programmable stages
         //
 
-        vulkan.vertex_shader = create_shader_module(vulkan.device, config.vertex_shader_path);
-        vulkan.fragment_shader = create_shader_module(vulkan.device, config.fragment_shader_path);
+        ShaderReflection shader_reflections[2];
+        if (config.shader_reflections.size() == 2) {
+            shader_reflections[0] = config.shader_reflections[0];
+            shader_reflections[1] = config.shader_reflections[1];
+        } else {
+            shader_reflections[0] = reflect_spirv(config.vertex_shader_code);
+            shader_reflections[1] = reflect_spirv(config.fragment_shader_code);
+        }
+        const ShaderReflection& vertex_shader_reflection = shader_reflections[0];
+        if (vertex_shader_reflection.stage != VK_SHADER_STAGE_VERTEX_BIT || shader_reflections[1].stage != VK_SHADER_STAGE_FRAGMENT_BIT) {
+            GM_THROW("[" << config.name << "] needs a vertex shader and a fragment shader");
+        }
 
-        std::string vertex_shader_name = std::format("{} VertexShader", config.name.c_str());
-        set_vulkan_object_name(vulkan.device, vulkan.vertex_shader, VK_OBJECT_TYPE_SHADER_MODULE, vertex_shader_name.c_str());
+        // A library only compiles the shaders of its own parts
+        bool complete = config.library_parts == 0;
+        bool vertex_shader_used = complete || (config.library_parts & VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT) != 0;
+        bool fragment_shader_used = complete || (config.library_parts & VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT) != 0;
 
-        std::string fragment_shader_name = std::format("{} FragmentShader", config.name.c_str());
-        set_vulkan_object_name(vulkan.device, vulkan.fragment_shader, VK_OBJECT_TYPE_SHADER_MODULE, fragment_shader_name.c_str());
+        std::vector<VkPipelineShaderStageCreateInfo> shader_stage_create_infos;
 
-        VkPipelineShaderStageCreateInfo vertex_shader_stage_create_info{};
-        vertex_shader_stage_create_info.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-        vertex_shader_stage_create_info.stage = VK_SHADER_STAGE_VERTEX_BIT;
-        vertex_shader_stage_create_info.module = vulkan.vertex_shader;
-        vertex_shader_stage_create_info.pName = "main";
+        if (vertex_shader_used) {
+            pipeline.vertex_shader = create_shader_module(vulkan.device, config.vertex_shader_code);
 
-        VkPipelineShaderStageCreateInfo fragment_shader_stage_create_info{};
-        fragment_shader_stage_create_info.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-        fragment_shader_stage_create_info.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
-        fragment_shader_stage_create_info.module = vulkan.fragment_shader;
-        fragment_shader_stage_create_info.pName = "main";
+            std::string vertex_shader_name = std::format("{} VertexShader", config.name.c_str());
+            set_vulkan_object_name(vulkan.device, pipeline.vertex_shader, VK_OBJECT_TYPE_SHADER_MODULE, vertex_shader_name.c_str());
 
-        VkPipelineShaderStageCreateInfo shader_stage_create_infos[] = {
-            vertex_shader_stage_create_info,
-            fragment_shader_stage_create_info,
-        };
+            VkPipelineShaderStageCreateInfo& vertex_shader_stage_create_info = shader_stage_create_infos.emplace_back();
+            vertex_shader_stage_create_info.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+            vertex_shader_stage_create_info.stage = VK_SHADER_STAGE_VERTEX_BIT;
+            vertex_shader_stage_create_info.module = pipeline.vertex_shader;
+            vertex_shader_stage_create_info.pName = "main";
+        }
+
+        if (fragment_shader_used) {
+            pipeline.fragment_shader = create_shader_module(vulkan.device, config.fragment_shader_code);
+
+            std::string fragment_shader_name = std::format("{} FragmentShader", config.name.c_str());
+            set_vulkan_object_name(vulkan.device, pipeline.fragment_shader, VK_OBJECT_TYPE_SHADER_MODULE, fragment_shader_name.c_str());
+
+            VkPipelineShaderStageCreateInfo& fragment_shader_stage_create_info = shader_stage_create_infos.emplace_back();
+            fragment_shader_stage_create_info.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+            fragment_shader_stage_create_info.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+            fragment_shader_stage_create_info.module = pipeline.fragment_shader;
+            fragment_shader_stage_create_info.pName = "main";
+        }
 
         //
         // Fixed function stages
         //
 
-        std::vector<VkDynamicState> dynamic_states = {
-            VK_DYNAMIC_STATE_VIEWPORT,
-            VK_DYNAMIC_STATE_SCISSOR
-        };
+        std::vector<VkDynamicState> dynamic_states = get_dynamic_states(vulkan.physical_device_optional_features);
 
         VkPipelineDynamicStateCreateInfo dynamic_state_create_info{};
         dynamic_state_create_info.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
         dynamic_state_create_info.dynamicStateCount = static_cast<u32>(dynamic_states.size());
         dynamic_state_create_info.pDynamicStates = dynamic_states.data();
 
+        std::vector<VkVertexInputAttributeDescription> vertex_attribute_descriptions;
+        VkVertexInputBindingDescription vertex_binding_description{};
+        vertex_binding_description.binding = 0;
+        vertex_binding_description.stride = 0;
+        vertex_binding_description.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+        for (const ReflectedVertexInput& vertex_input : vertex_shader_reflection.vertex_inputs) {
+            VkVertexInputAttributeDescription& vertex_attribute_description = vertex_attribute_descriptions.emplace_back();
+            vertex_attribute_description.location = vertex_input.location;
+            vertex_attribute_description.binding = vertex_binding_description.binding;
+            vertex_attribute_description.format = vertex_input.format;
+            vertex_attribute_description.offset = vertex_binding_description.stride;
+            vertex_binding_description.stride += vertex_input.size;
+        }
+
         VkPipelineVertexInputStateCreateInfo vertex_input_state_create_info{};
         vertex_input_state_create_info.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-        vertex_input_state_create_info.vertexBindingDescriptionCount = 0;
-        vertex_input_state_create_info.pVertexBindingDescriptions = nullptr;
-        vertex_input_state_create_info.vertexAttributeDescriptionCount = 0;
-        vertex_input_state_create_info.pVertexAttributeDescriptions = nullptr;
+        vertex_input_state_create_info.vertexBindingDescriptionCount = vertex_attribute_descriptions.empty() ? 0 : 1;
+        vertex_input_state_create_info.pVertexBindingDescriptions = &vertex_binding_description;
+        vertex_input_state_create_info.vertexAttributeDescriptionCount = static_cast<u32>(vertex_attribute_descriptions.size());
+        vertex_input_state_create_info.pVertexAttributeDescriptions = vertex_attribute_descriptions.data();
 
         VkPipelineInputAssemblyStateCreateInfo input_assembly_state_create_info{};
         input_assembly_state_create_info.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
-        input_assembly_state_create_info.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+        input_assembly_state_create_info.topology = config.state.topology; // Only the class counts if it is dynamic
         input_assembly_state_create_info.primitiveRestartEnable = VK_FALSE;
 
-        VkViewport viewport{};
-        viewport.x = 0.0f;
-        viewport.y = 0.0f;
-        viewport.width = (f32) vulkan.swap_chain_extent.width;
-        viewport.height = (f32) vulkan.swap_chain_extent.height;
-        viewport.minDepth = 0.0f;
-        viewport.maxDepth = 1.0f;
-
-        VkRect2D scissor{};
-        scissor.offset = {0, 0};
-        scissor.extent = vulkan.swap_chain_extent;
-
+        // The viewport and scissor are dynamic state, set when recording, so the pipeline doesn't depend on the swap chain extent
         VkPipelineViewportStateCreateInfo viewport_state_create_info{};
         viewport_state_create_info.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
         viewport_state_create_info.viewportCount = 1;
-        viewport_state_create_info.pViewports = &viewport;
+        viewport_state_create_info.pViewports = nullptr;
         viewport_state_create_info.scissorCount = 1;
-        viewport_state_create_info.pScissors = &scissor;
+        viewport_state_create_info.pScissors = nullptr;
 
         VkPipelineRasterizationStateCreateInfo rasterization_state_create_info{};
         rasterization_state_create_info.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
         rasterization_state_create_info.depthClampEnable = VK_FALSE;
         rasterization_state_create_info.rasterizerDiscardEnable = VK_FALSE;
-        rasterization_state_create_info.polygonMode = VK_POLYGON_MODE_FILL;
+        rasterization_state_create_info.polygonMode = config.state.polygon_mode;
         rasterization_state_create_info.lineWidth = 1.0f;
-        rasterization_state_create_info.cullMode = VK_CULL_MODE_BACK_BIT;
-        rasterization_state_create_info.frontFace = VK_FRONT_FACE_CLOCKWISE;
+        rasterization_state_create_info.cullMode = config.state.cull_mode;
+        rasterization_state_create_info.frontFace = config.state.front_face;
         rasterization_state_create_info.depthBiasEnable = VK_FALSE;
 
         VkPipelineMultisampleStateCreateInfo multisample_state_create_info{};
         multisample_state_create_info.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
         multisample_state_create_info.sampleShadingEnable = VK_FALSE;
-        multisample_state_create_info.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+        multisample_state_create_info.rasterizationSamples = config.state.sample_count;
         multisample_state_create_info.minSampleShading = 1.0f;
         multisample_state_create_info.pSampleMask = nullptr;
         multisample_state_create_info.alphaToCoverageEnable = VK_FALSE;
         multisample_state_create_info.alphaToOneEnable = VK_FALSE;
 
-        // VkPipelineDepthStencilStateCreateInfo depthStencilStateCreateInfo{};
-        // depthStencilStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
-        // depthStencilStateCreateInfo.depthTestEnable = config.depthTestEnabled;
-        // depthStencilStateCreateInfo.depthWriteEnable = config.depthTestEnabled;
-        // depthStencilStateCreateInfo.depthCompareOp = VK_COMPARE_OP_LESS;
-        // depthStencilStateCreateInfo.depthBoundsTestEnable = VK_FALSE;
-        // depthStencilStateCreateInfo.stencilTestEnable = VK_FALSE;
+        bool depth_test_enabled = config.state.depth_format != VK_FORMAT_UNDEFINED;
+
+        VkPipelineDepthStencilStateCreateInfo depth_stencil_state_create_info{};
+        depth_stencil_state_create_info.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO;
+        depth_stencil_state_create_info.depthTestEnable = VK_TRUE;
+        depth_stencil_state_create_info.depthWriteEnable = config.state.depth_write_enabled ? VK_TRUE : VK_FALSE;
+        depth_stencil_state_create_info.depthCompareOp = config.state.depth_compare_op;
+        depth_stencil_state_create_info.depthBoundsTestEnable = VK_FALSE;
+        depth_stencil_state_create_info.stencilTestEnable = VK_FALSE;
 
         VkPipelineColorBlendAttachmentState color_blend_attachment_state{};
         color_blend_attachment_state.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
-        color_blend_attachment_state.blendEnable = VK_TRUE;
-        color_blend_attachment_state.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
-        color_blend_attachment_state.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
-        color_blend_attachment_state.colorBlendOp = VK_BLEND_OP_ADD;
-        color_blend_attachment_state.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
-        color_blend_attachment_state.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
-        color_blend_attachment_state.alphaBlendOp = VK_BLEND_OP_ADD;
+        color_blend_attachment_state.blendEnable = config.state.blend_mode != BlendMode::Opaque ? VK_TRUE : VK_FALSE;
+        VkColorBlendEquationEXT color_blend_equation = get_color_blend_equation(config.state.blend_mode);
+        color_blend_attachment_state.srcColorBlendFactor = color_blend_equation.srcColorBlendFactor;
+        color_blend_attachment_state.dstColorBlendFactor = color_blend_equation.dstColorBlendFactor;
+        color_blend_attachment_state.colorBlendOp = color_blend_equation.colorBlendOp;
+        color_blend_attachment_state.srcAlphaBlendFactor = color_blend_equation.srcAlphaBlendFactor;
+        color_blend_attachment_state.dstAlphaBlendFactor = color_blend_equation.dstAlphaBlendFactor;
+        color_blend_attachment_state.alphaBlendOp = color_blend_equation.alphaBlendOp;
 
         VkPipelineColorBlendStateCreateInfo color_blend_state_create_info{};
         color_blend_state_create_info.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
@@ -147,51 +205,676 @@ namespace Game {
         // Creation
         //
 
-        VkPipelineLayoutCreateInfo pipeline_layout_create_info{};
-        pipeline_layout_create_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-        pipeline_layout_create_info.setLayoutCount = 0;
-        pipeline_layout_create_info.pSetLayouts = nullptr;
-        pipeline_layout_create_info.pushConstantRangeCount = 0;
-        pipeline_layout_create_info.pPushConstantRanges = nullptr;
+        pipeline.layout = get_vulkan_pipeline_layout(vulkan, shader_reflections);
 
-        if (vkCreatePipelineLayout(vulkan.device, &pipeline_layout_create_info, GM_VK_ALLOCATOR, &vulkan.pipeline_layout) != VK_SUCCESS) {
-            GM_THROW("Could not create Vulkan pipeline layout");
-        }
-
-        std::string pipeline_layout_name = std::format("{} Layout", config.name.c_str());
-        set_vulkan_object_name(vulkan.device, vulkan.pipeline_layout, VK_OBJECT_TYPE_PIPELINE_LAYOUT, pipeline_layout_name.c_str());
+        // The state of the parts that are not in a library is ignored
+        VkGraphicsPipelineLibraryCreateInfoEXT library_create_info{};
+        library_create_info.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_LIBRARY_CREATE_INFO_EXT;
+        library_create_info.flags = config.library_parts;
 
         VkGraphicsPipelineCreateInfo pipeline_create_info{};
         pipeline_create_info.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-        pipeline_create_info.stageCount = 2;
-        pipeline_create_info.pStages = shader_stage_create_infos;
+        if (!complete) {
+            pipeline_create_info.pNext = &library_create_info;
+            pipeline_create_info.flags = VK_PIPELINE_CREATE_LIBRARY_BIT_KHR | VK_PIPELINE_CREATE_RETAIN_LINK_TIME_OPTIMIZATION_INFO_BIT_EXT;
+        }
+        pipeline_create_info.stageCount = (u32) shader_stage_create_infos.size();
+        pipeline_create_info.pStages = shader_stage_create_infos.data();
         pipeline_create_info.pVertexInputState = &vertex_input_state_create_info;
         pipeline_create_info.pInputAssemblyState = &input_assembly_state_create_info;
         pipeline_create_info.pViewportState = &viewport_state_create_info;
         pipeline_create_info.pRasterizationState = &rasterization_state_create_info;
         pipeline_create_info.pMultisampleState = &multisample_state_create_info;
-        pipeline_create_info.pDepthStencilState = nullptr;
+        pipeline_create_info.pDepthStencilState = depth_test_enabled ? &depth_stencil_state_create_info : nullptr;
         pipeline_create_info.pColorBlendState = &color_blend_state_create_info;
         pipeline_create_info.pDynamicState = &dynamic_state_create_info;
-        pipeline_create_info.layout = vulkan.pipeline_layout;
+        pipeline_create_info.layout = pipeline.layout;
         pipeline_create_info.renderPass = vulkan.swap_chain_render_pass;
         pipeline_create_info.subpass = 0;
         pipeline_create_info.basePipelineHandle = nullptr;
         pipeline_create_info.basePipelineIndex = -1;
 
         i32 create_info_count = 1;
-        VkPipelineCache pipeline_cache = nullptr;
-        if (vkCreateGraphicsPipelines(vulkan.device, pipeline_cache, create_info_count, &pipeline_create_info, GM_VK_ALLOCATOR, &vulkan.pipeline) != VK_SUCCESS) {
+        if (vkCreateGraphicsPipelines(vulkan.device, config.pipeline_cache, create_info_count, &pipeline_create_info, GM_VK_ALLOCATOR, &pipeline.handle) != VK_SUCCESS) {
             GM_THROW("Could not create pipeline");
         }
 
-        set_vulkan_object_name(vulkan.device, vulkan.pipeline, VK_OBJECT_TYPE_PIPELINE, config.name.c_str());
+        set_vulkan_object_name(vulkan.device, pipeline.handle, VK_OBJECT_TYPE_PIPELINE, config.name.c_str());
+    }
+
+    void destroy_vulkan_pipeline(const Vulkan& vulkan, const VulkanPipeline& pipeline) {
+        vkDestroyPipeline(vulkan.device, pipeline.handle, GM_VK_ALLOCATOR);
+        vkDestroyShaderModule(vulkan.device, pipeline.fragment_shader, GM_VK_ALLOCATOR);
+        vkDestroyShaderModule(vulkan.device, pipeline.vertex_shader, GM_VK_ALLOCATOR);
+    }
+
+    // A dynamic topology must still be of the same class as the topology that the pipeline was created with
+    VkPrimitiveTopology get_primitive_topology_class(VkPrimitiveTopology topology) {
+        switch (topology) {
+            case VK_PRIMITIVE_TOPOLOGY_POINT_LIST:
+                return VK_PRIMITIVE_TOPOLOGY_POINT_LIST;
+            case VK_PRIMITIVE_TOPOLOGY_LINE_LIST:
+            case VK_PRIMITIVE_TOPOLOGY_LINE_STRIP:
+            case VK_PRIMITIVE_TOPOLOGY_LINE_LIST_WITH_ADJACENCY:
+            case VK_PRIMITIVE_TOPOLOGY_LINE_STRIP_WITH_ADJACENCY:
+                return VK_PRIMITIVE_TOPOLOGY_LINE_LIST;
+            case VK_PRIMITIVE_TOPOLOGY_PATCH_LIST:
+                return VK_PRIMITIVE_TOPOLOGY_PATCH_LIST;
+            default:
+                return VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+        }
+    }
+
+    // The state that the pipeline of a state is looked up and created with, where the dynamic fields are reset to
+    // their defaults so that states that only differ in them share a pipeline
+    PipelineState get_pipeline_key_state(const VulkanOptionalFeatures& optional_features, const PipelineState& state) {
+        PipelineState key_state = state;
+        PipelineState default_state{};
+        if (optional_features.extended_dynamic_state) {
+            key_state.topology = get_primitive_topology_class(state.topology);
+            key_state.cull_mode = default_state.cull_mode;
+            key_state.front_face = default_state.front_face;
+            key_state.depth_compare_op = default_state.depth_compare_op;
+            key_state.depth_write_enabled = default_state.depth_write_enabled;
+        }
+        if (optional_features.extended_dynamic_state3_polygon_mode) {
+            key_state.polygon_mode = default_state.polygon_mode;
+        }
+        if (optional_features.extended_dynamic_state3_color_blend) {
+            key_state.blend_mode = default_state.blend_mode;
+        }
+        return key_state;
+    }
+
+    void set_vulkan_pipeline_dynamic_state(const Vulkan& vulkan, VkCommandBuffer command_buffer, const PipelineState& state) {
+        const VulkanOptionalFeatures& optional_features = vulkan.physical_device_optional_features;
+        const VulkanDeviceFunctions& functions = vulkan.device_functions;
+
+        if (optional_features.extended_dynamic_state) {
+            vkCmdSetPrimitiveTopology(command_buffer, state.topology);
+            vkCmdSetPrimitiveRestartEnable(command_buffer, VK_FALSE);
+            vkCmdSetRasterizerDiscardEnable(command_buffer, VK_FALSE);
+            vkCmdSetCullMode(command_buffer, state.cull_mode);
+            vkCmdSetFrontFace(command_buffer, state.front_face);
+            vkCmdSetDepthBiasEnable(command_buffer, VK_FALSE);
+
+            bool depth_test_enabled = state.depth_format != VK_FORMAT_UNDEFINED;
+            vkCmdSetDepthTestEnable(command_buffer, depth_test_enabled ? VK_TRUE : VK_FALSE);
+            vkCmdSetDepthWriteEnable(command_buffer, depth_test_enabled && state.depth_write_enabled ? VK_TRUE : VK_FALSE);
+            vkCmdSetDepthCompareOp(command_buffer, state.depth_compare_op);
+        }
+
+        if (optional_features.extended_dynamic_state3_polygon_mode) {
+            functions.cmd_set_polygon_mode(command_buffer, state.polygon_mode);
+        }
+
+        if (optional_features.extended_dynamic_state3_color_blend) {
+            set_vulkan_color_blend(vulkan, command_buffer, state.blend_mode);
+        }
+    }
+
+    VkColorBlendEquationEXT get_color_blend_equation(BlendMode blend_mode) {
+        VkColorBlendEquationEXT color_blend_equation{};
+        color_blend_equation.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+        color_blend_equation.dstColorBlendFactor = blend_mode == BlendMode::Additive ? VK_BLEND_FACTOR_ONE : VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+        color_blend_equation.colorBlendOp = VK_BLEND_OP_ADD;
+        color_blend_equation.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+        color_blend_equation.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+        color_blend_equation.alphaBlendOp = VK_BLEND_OP_ADD;
+        return color_blend_equation;
+    }
+
+    void set_vulkan_color_blend(const Vulkan& vulkan, VkCommandBuffer command_buffer, BlendMode blend_mode) {
+        const VulkanDeviceFunctions& functions = vulkan.device_functions;
+
+        VkBool32 color_blend_enabled = blend_mode != BlendMode::Opaque ? VK_TRUE : VK_FALSE;
+        functions.cmd_set_color_blend_enable(command_buffer, 0, 1, &color_blend_enabled);
+
+        VkColorBlendEquationEXT color_blend_equation = get_color_blend_equation(blend_mode);
+        functions.cmd_set_color_blend_equation(command_buffer, 0, 1, &color_blend_equation);
+    }
+
+    // FNV-1a of every field
+    u64 PipelineStateHash::operator()(const PipelineState& state) const {
+        u64 hash = fnv1a_offset_basis;
+        hash = hash_combine(hash, state.vertex_shader);
+        hash = hash_combine(hash, state.fragment_shader);
+        hash = hash_combine(hash, (u64) state.color_format);
+        hash = hash_combine(hash, (u64) state.depth_format);
+        hash = hash_combine(hash, (u64) state.sample_count);
+        hash = hash_combine(hash, (u64) state.topology);
+        hash = hash_combine(hash, (u64) state.polygon_mode);
+        hash = hash_combine(hash, (u64) state.cull_mode);
+        hash = hash_combine(hash, (u64) state.front_face);
+        hash = hash_combine(hash, (u64) state.depth_compare_op);
+        hash = hash_combine(hash, (u64) state.blend_mode);
+        hash = hash_combine(hash, (u64) state.depth_write_enabled);
+        return hash;
+    }
+
+    // FNV-1a of the part and the state
+    u64 PipelineLibraryKeyHash::operator()(const PipelineLibraryKey& key) const {
+        return hash_combine(PipelineStateHash{}(key.state), key.part);
+    }
+
+    constexpr VkGraphicsPipelineLibraryFlagsEXT pipeline_library_parts[] = {
+        VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT,
+        VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT,
+        VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT,
+        VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT,
+    };
+
+    constexpr const char* pipeline_library_part_names[] = {
+        "VertexInput",
+        "PreRasterization",
+        "FragmentShader",
+        "FragmentOutput",
+    };
+
+    constexpr u32 pipeline_library_part_count = sizeof(pipeline_library_parts) / sizeof(pipeline_library_parts[0]);
+
+    // The parts with shaders depend on both shaders, since the layout that they are compiled against is reflected from
+    // both. The formats stand in for the render pass, which every part but the vertex input is compiled against.
+    PipelineLibraryKey get_pipeline_library_key(VkGraphicsPipelineLibraryFlagsEXT part, const PipelineState& state) {
+        PipelineLibraryKey key{};
+        key.part = part;
+        switch (part) {
+            case VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT:
+                key.state.vertex_shader = state.vertex_shader;
+                key.state.topology = state.topology;
+                break;
+            case VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT:
+                key.state.vertex_shader = state.vertex_shader;
+                key.state.fragment_shader = state.fragment_shader;
+                key.state.color_format = state.color_format;
+                key.state.depth_format = state.depth_format;
+                key.state.polygon_mode = state.polygon_mode;
+                key.state.cull_mode = state.cull_mode;
+                key.state.front_face = state.front_face;
+                break;
+            case VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT:
+                key.state.vertex_shader = state.vertex_shader;
+                key.state.fragment_shader = state.fragment_shader;
+                key.state.color_format = state.color_format;
+                key.state.depth_format = state.depth_format;
+                key.state.sample_count = state.sample_count;
+                key.state.depth_compare_op = state.depth_compare_op;
+                key.state.depth_write_enabled = state.depth_write_enabled;
+                break;
+            case VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT:
+                key.state.color_format = state.color_format;
+                key.state.depth_format = state.depth_format;
+                key.state.sample_count = state.sample_count;
+                key.state.blend_mode = state.blend_mode;
+                break;
+            default:
+                GM_THROW("Unknown pipeline library part [" << part << "]");
+        }
+        return key;
+    }
+
+    // Creates the libraries of the state that no other state has created yet
+    void create_pipeline_libraries(const Vulkan& vulkan, VulkanPipelineStateCache& cache, u32 thread_index, const PipelineState& state) {
+        for (u32 i = 0; i < pipeline_library_part_count; ++i) {
+            PipelineLibraryKey key = get_pipeline_library_key(pipeline_library_parts[i], state);
+            {
+                std::lock_guard lock(cache.mutex);
+                if (cache.libraries.contains(key)) {
+                    continue;
+                }
+            }
+
+            std::string name = std::format("PipelineLibrary {:016x} {}", PipelineLibraryKeyHash{}(key), pipeline_library_part_names[i]);
+            VulkanPipeline library{};
+            try {
+                ShaderReflection shader_reflections[] = {
+                    get_embedded_shader_reflection(vulkan, state.vertex_shader),
+                    get_embedded_shader_reflection(vulkan, state.fragment_shader),
+                };
+                // The code comes from the full state, since a library without shaders still reflects them for the layout
+                create_vulkan_pipeline(vulkan, library, {
+                    .name = name,
+                    .vertex_shader_code = get_embedded_shader_bytes(get_embedded_shader(state.vertex_shader)),
+                    .fragment_shader_code = get_embedded_shader_bytes(get_embedded_shader(state.fragment_shader)),
+                    .state = key.state,
+                    .pipeline_cache = cache.compiler_pipeline_caches[thread_index],
+                    .library_parts = key.part,
+                    .shader_reflections = shader_reflections,
+                });
+            } catch (const std::exception&) {
+                destroy_vulkan_pipeline(vulkan, library);
+                throw;
+            }
+
+            // Another thread may have created the same library in the meantime
+            bool inserted;
+            {
+                std::lock_guard lock(cache.mutex);
+                inserted = cache.libraries.try_emplace(key, library).second;
+            }
+            if (!inserted) {
+                destroy_vulkan_pipeline(vulkan, library);
+                continue;
+            }
+            GM_LOG_DEBUG("Created [{}] on compiler thread [{}]", name, thread_index);
+        }
+    }
+
+    // Returns false, without creating a pipeline, if a library of the state is missing
+    bool link_pipeline_libraries(const Vulkan& vulkan, VulkanPipelineStateCache& cache, VulkanPipeline& pipeline, const PipelineState& state, bool optimized, VkPipelineCache pipeline_cache, const std::string& name) {
+        // Libraries live until the cache is destroyed, so their handles can be used after unlocking
+        VkPipeline libraries[pipeline_library_part_count];
+        {
+            std::lock_guard lock(cache.mutex);
+            for (u32 i = 0; i < pipeline_library_part_count; ++i) {
+                auto iterator = cache.libraries.find(get_pipeline_library_key(pipeline_library_parts[i], state));
+                if (iterator == cache.libraries.end()) {
+                    return false;
+                }
+                libraries[i] = iterator->second.handle;
+                if (pipeline_library_parts[i] == VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT) {
+                    pipeline.layout = iterator->second.layout;
+                }
+            }
+        }
+
+        VkPipelineLibraryCreateInfoKHR library_create_info{};
+        library_create_info.sType = VK_STRUCTURE_TYPE_PIPELINE_LIBRARY_CREATE_INFO_KHR;
+        library_create_info.libraryCount = pipeline_library_part_count;
+        library_create_info.pLibraries = libraries;
+
+        VkGraphicsPipelineCreateInfo pipeline_create_info{};
+        pipeline_create_info.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+        pipeline_create_info.pNext = &library_create_info;
+        pipeline_create_info.flags = optimized ? VK_PIPELINE_CREATE_LINK_TIME_OPTIMIZATION_BIT_EXT : 0;
+        pipeline_create_info.layout = pipeline.layout;
+        pipeline_create_info.basePipelineIndex = -1;
+
+        if (vkCreateGraphicsPipelines(vulkan.device, pipeline_cache, 1, &pipeline_create_info, GM_VK_ALLOCATOR, &pipeline.handle) != VK_SUCCESS) {
+            GM_THROW("Could not link pipeline libraries of [" << name << "]");
+        }
+
+        set_vulkan_object_name(vulkan.device, pipeline.handle, VK_OBJECT_TYPE_PIPELINE, name.c_str());
+        return true;
     }
 
-    void destroy_vulkan_pipeline(const Vulkan& vulkan) {
-        vkDestroyPipeline(vulkan.device, vulkan.pipeline, GM_VK_ALLOCATOR);
-        vkDestroyPipelineLayout(vulkan.device, vulkan.pipeline_layout, GM_VK_ALLOCATOR);
-        vkDestroyShaderModule(vulkan.device, vulkan.fragment_shader, GM_VK_ALLOCATOR);
-        vkDestroyShaderModule(vulkan.device, vulkan.vertex_shader, GM_VK_ALLOCATOR);
+    // Without the graphics pipeline library the pipeline is compiled in full. With it, the missing libraries are
+    // created and fast linked, and the optimized link is queued to take the place of the fast linked pipeline later.
+    void compile_cached_pipeline(const Vulkan& vulkan, VulkanPipelineStateCache& cache, u32 thread_index, const PipelineCompileRequest& request) {
+        TimePoint start_time = Time::now();
+
+        bool libraries_used = vulkan.physical_device_optional_features.graphics_pipeline_library;
+        VkPipelineCache pipeline_cache = cache.compiler_pipeline_caches[thread_index];
+        std::string name = std::format("Pipeline {:016x}", PipelineStateHash{}(request.state));
+        VulkanPipeline pipeline{};
+        try {
+            if (!libraries_used) {
+                ShaderReflection shader_reflections[] = {
+                    get_embedded_shader_reflection(vulkan, request.state.vertex_shader),
+                    get_embedded_shader_reflection(vulkan, request.state.fragment_shader),
+                };
+                create_vulkan_pipeline(vulkan, pipeline, {
+                    .name = name,
+                    .vertex_shader_code = get_embedded_shader_bytes(get_embedded_shader(request.state.vertex_shader)),
+                    .fragment_shader_code = get_embedded_shader_bytes(get_embedded_shader(request.state.fragment_shader)),
+                    .state = request.state,
+                    .pipeline_cache = pipeline_cache,
+                    .shader_reflections = shader_reflections,
+                });
+            } else {
+                bool optimized = request.linked_pipeline != nullptr;
+                if (!optimized) {
+                    create_pipeline_libraries(vulkan, cache, thread_index, request.state);
+                }
+                if (!link_pipeline_libraries(vulkan, cache, pipeline, request.state, optimized, pipeline_cache, name)) {
+                    GM_THROW("Missing pipeline libraries of [" << name << "]");
+                }
+            }
+        } catch (const std::exception& e) {
+            destroy_vulkan_pipeline(vulkan, pipeline);
+            GM_LOG_ERROR("Could not compile [{}]: {}", name, e.what());
+            {
+                std::lock_guard lock(cache.mutex);
+                cache.failed_count++;
+            }
+            // A failed optimized link leaves the fast linked pipeline in use
+            if (request.linked_pipeline == nullptr) {
+                request.cached_pipeline->status.store(PipelineStatus::Failed, std::memory_order_release);
+            }
+            return;
+        }
+
+        Milliseconds creation_time = Time::as<Milliseconds>(Time::now() - start_time);
+        {
+            std::lock_guard lock(cache.mutex);
+            cache.creation_time += creation_time;
+            cache.slowest_creation_time = std::max(cache.slowest_creation_time, creation_time);
+        }
+
+        if (request.linked_pipeline != nullptr) {
+            {
+                std::lock_guard lock(cache.mutex);
+                cache.optimized_pipelines.push_back({
+                    .cached_pipeline = request.cached_pipeline,
+                    .pipeline = pipeline,
+                    .linked_pipeline = request.linked_pipeline,
+                });
+            }
+            GM_LOG_INFO("Optimized [{}] in [{:.1f}] ms on compiler thread [{}]", name, creation_time.count(), thread_index);
+            return;
+        }
+
+        request.cached_pipeline->pipeline = pipeline;
+        request.cached_pipeline->status.store(PipelineStatus::Ready, std::memory_order_release);
+
+        // Every compile is logged, so that a state that keeps changing shows up as a stream of new pipelines
+        GM_LOG_INFO("Compiled [{}] in [{:.1f}] ms on compiler thread [{}]", name, creation_time.count(), thread_index);
+
+        if (libraries_used) {
+            {
+                std::lock_guard lock(cache.mutex);
+                cache.compile_requests.push_back({
+                    .state = request.state,
+                    .cached_pipeline = request.cached_pipeline,
+                    .linked_pipeline = pipeline.handle,
+                });
+            }
+            cache.condition.notify_one();
+        }
+    }
+
+    // Only reads `vulkan`, the cache is passed separately since it is written
+    void run_pipeline_compiler_thread(const Vulkan& vulkan, VulkanPipelineStateCache& cache, u32 thread_index) {
+        while (true) {
+            PipelineCompileRequest request{};
+            {
+                std::unique_lock lock(cache.mutex);
+                cache.condition.wait(lock, [&cache] {
+                    return !cache.running || !cache.compile_requests.empty();
+                });
+                if (!cache.running) {
+                    return;
+                }
+                request = cache.compile_requests.front();
+                cache.compile_requests.pop_front();
+            }
+            compile_cached_pipeline(vulkan, cache, thread_index, request);
+        }
+    }
+
+    void reflect_embedded_shaders(Vulkan& vulkan) {
+        for (const EmbeddedShader& shader : get_embedded_shaders()) {
+            vulkan.embedded_shader_reflections[shader.hash] = reflect_spirv(get_embedded_shader_bytes(shader));
+        }
+        GM_LOG_DEBUG("Reflected [{}] embedded shaders", vulkan.embedded_shader_reflections.size());
+    }
+
+    ShaderReflection get_embedded_shader_reflection(const Vulkan& vulkan, u64 shader_hash) {
+        auto iterator = vulkan.embedded_shader_reflections.find(shader_hash);
+        if (iterator != vulkan.embedded_shader_reflections.end()) {
+            return iterator->second;
+        }
+        return reflect_spirv(get_embedded_shader_bytes(get_embedded_shader(shader_hash)));
+    }
+
+    void read_vulkan_pipeline_cache_file(Vulkan& vulkan, const std::filesystem::path& path) {
+        if (!std::filesystem::exists(path)) {
+            GM_LOG_DEBUG("Could not find pipeline cache file [{}], pipelines are compiled from scratch", path.string());
+            return;
+        }
+        // The cache only saves compile time, so a file that can't be read is as good as a missing one
+        try {
+            vulkan.pipeline_state_cache.file_data = read_bytes(path);
+        } catch (const std::exception& e) {
+            GM_LOG_WARNING("Could not read pipeline cache file [{}], pipelines are compiled from scratch: {}", path.string(), e.what());
+            vulkan.pipeline_state_cache.file_data.clear();
+            return;
+        }
+        GM_LOG_DEBUG("Read [{}] bytes from pipeline cache file [{}]", vulkan.pipeline_state_cache.file_data.size(), path.string());
+    }
+
+    // The driver checks the data as well, but data from another device or driver version is only dropped silently
+    bool is_pipeline_cache_data_compatible(const Vulkan& vulkan, const std::vector<char>& data) {
+        VkPipelineCacheHeaderVersionOne header{};
+        if (data.size() < sizeof(header)) {
+            return false;
+        }
+        std::memcpy(&header, data.data(), sizeof(header));
+        const VkPhysicalDeviceProperties& properties = vulkan.physical_device_properties;
+        return header.headerVersion == VK_PIPELINE_CACHE_HEADER_VERSION_ONE
+            && header.vendorID == properties.vendorID
+            && header.deviceID == properties.deviceID
+            && std::memcmp(header.pipelineCacheUUID, properties.pipelineCacheUUID, VK_UUID_SIZE) == 0;
+    }
+
+    // Merges the caches of the compiler threads into the first one and writes it, through a temporary file so that a
+    // crash while writing doesn't leave a truncated file behind. Failing to save only costs the next run compile time.
+    void write_vulkan_pipeline_cache_file(const Vulkan& vulkan, const std::filesystem::path& path) {
+        const std::vector<VkPipelineCache>& pipeline_caches = vulkan.pipeline_state_cache.compiler_pipeline_caches;
+        if (pipeline_caches.empty()) {
+            return;
+        }
+        if (pipeline_caches.size() > 1) {
+            if (vkMergePipelineCaches(vulkan.device, pipeline_caches[0], (u32) pipeline_caches.size() - 1, pipeline_caches.data() + 1) != VK_SUCCESS) {
+                GM_LOG_WARNING("Could not merge pipeline caches, pipeline cache file [{}] is not saved", path.string());
+                return;
+            }
+        }
+
+        size_t data_size = 0;
+        if (vkGetPipelineCacheData(vulkan.device, pipeline_caches[0], &data_size, nullptr) != VK_SUCCESS) {
+            GM_LOG_WARNING("Could not get pipeline cache size, pipeline cache file [{}] is not saved", path.string());
+            return;
+        }
+        std::vector<char> data(data_size);
+        if (vkGetPipelineCacheData(vulkan.device, pipeline_caches[0], &data_size, data.data()) != VK_SUCCESS) {
+            GM_LOG_WARNING("Could not get pipeline cache data, pipeline cache file [{}] is not saved", path.string());
+            return;
+        }
+
+        std::filesystem::path temporary_path = path;
+        temporary_path += ".tmp";
+        {
+            std::ofstream file(temporary_path, std::ios::binary | std::ios::trunc);
+            file.write(data.data(), (std::streamsize) data_size);
+            if (!file) {
+                GM_LOG_WARNING("Could not write pipeline cache file [{}]", temporary_path.string());
+                return;
+            }
+        }
+        std::error_code error;
+        std::filesystem::rename(temporary_path, path, error);
+        if (error) {
+            GM_LOG_WARNING("Could not replace pipeline cache file [{}]: {}", path.string(), error.message());
+            return;
+        }
+        GM_LOG_DEBUG("Wrote [{}] bytes to pipeline cache file [{}]", data_size, path.string());
+    }
+
+    void create_vulkan_pipelines(Vulkan& vulkan) {
+        VulkanPipelineStateCache& cache = vulkan.pipeline_state_cache;
+
+        if (!cache.file_data.empty() && !is_pipeline_cache_data_compatible(vulkan, cache.file_data)) {
+            GM_LOG_INFO("Pipeline cache file was saved on another device or driver, pipelines are compiled from scratch");
+            cache.file_data.clear();
+        }
+
+        u32 thread_count = std::max(vulkan.config.pipeline_compiler_thread_count, 1u);
+        for (u32 i = 0; i < thread_count; ++i) {
+            VkPipelineCacheCreateInfo pipeline_cache_create_info{};
+            pipeline_cache_create_info.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+            pipeline_cache_create_info.initialDataSize = cache.file_data.size();
+            pipeline_cache_create_info.pInitialData = cache.file_data.empty() ? nullptr : cache.file_data.data();
+
+            VkPipelineCache pipeline_cache;
+            if (vkCreatePipelineCache(vulkan.device, &pipeline_cache_create_info, GM_VK_ALLOCATOR, &pipeline_cache) != VK_SUCCESS) {
+                GM_THROW("Could not create Vulkan pipeline cache for compiler thread [" << i << "]");
+            }
+            std::string pipeline_cache_name = std::format("PipelineCache {}", i);
+            set_vulkan_object_name(vulkan.device, pipeline_cache, VK_OBJECT_TYPE_PIPELINE_CACHE, pipeline_cache_name.c_str());
+            cache.compiler_pipeline_caches.push_back(pipeline_cache);
+        }
+        cache.file_data.clear();
+        cache.file_data.shrink_to_fit();
+
+        cache.running = true;
+        for (u32 i = 0; i < thread_count; ++i) {
+            cache.compiler_threads.emplace_back(run_pipeline_compiler_thread, std::cref(vulkan), std::ref(cache), i);
+        }
+    }
+
+    // Returns false if a library is missing or the link fails, to fall back to compiling on a compiler thread
+    bool fast_link_cached_pipeline(Vulkan& vulkan, const PipelineState& state, CachedPipeline& cached_pipeline) {
+        VulkanPipelineStateCache& cache = vulkan.pipeline_state_cache;
+        TimePoint start_time = Time::now();
+
+        std::string name = std::format("Pipeline {:016x}", PipelineStateHash{}(state));
+        VulkanPipeline pipeline{};
+        try {
+            if (!link_pipeline_libraries(vulkan, cache, pipeline, state, false, nullptr, name)) {
+                return false;
+            }
+        } catch (const std::exception& e) {
+            GM_LOG_WARNING("Could not fast link [{}]: {}", name, e.what());
+            return false;
+        }
+
+        Milliseconds link_time = Time::as<Milliseconds>(Time::now() - start_time);
+        cache.fast_link_count++;
+        cache.fast_link_time += link_time;
+
+        cached_pipeline.pipeline = pipeline;
+        cached_pipeline.status.store(PipelineStatus::Ready, std::memory_order_release);
+        GM_LOG_INFO("Fast linked [{}] in [{:.3f}] ms", name, link_time.count());
+        return true;
+    }
+
+    const VulkanPipeline* get_vulkan_pipeline(Vulkan& vulkan, const PipelineState& full_state) {
+        VulkanPipelineStateCache& cache = vulkan.pipeline_state_cache;
+        PipelineState state = get_pipeline_key_state(vulkan.physical_device_optional_features, full_state);
+        auto [iterator, inserted] = cache.pipelines.try_emplace(state);
+        CachedPipeline& cached_pipeline = iterator->second;
+        if (!inserted) {
+            cache.hit_count++;
+            return cached_pipeline.status.load(std::memory_order_acquire) == PipelineStatus::Ready ? &cached_pipeline.pipeline : nullptr;
+        }
+        cache.miss_count++;
+
+        // Linking is cheap enough to do in the frame, only the optimized link is left to a compiler thread
+        bool linked = vulkan.physical_device_optional_features.graphics_pipeline_library && fast_link_cached_pipeline(vulkan, state, cached_pipeline);
+        {
+            std::lock_guard lock(cache.mutex);
+            cache.compile_requests.push_back({
+                .state = state,
+                .cached_pipeline = &cached_pipeline,
+                .linked_pipeline = linked ? cached_pipeline.pipeline.handle : nullptr,
+            });
+        }
+        cache.condition.notify_one();
+        return linked ? &cached_pipeline.pipeline : nullptr;
+    }
+
+    void update_vulkan_pipelines(Vulkan& vulkan) {
+        VulkanPipelineStateCache& cache = vulkan.pipeline_state_cache;
+
+        // Every frame that starts has waited for the fence of the frame that last used its slot, so a pipeline is no
+        // longer in flight once as many frames as there are slots have started after it was retired
+        for (RetiredPipeline& retired_pipeline : cache.retired_pipelines) {
+            retired_pipeline.frames_left--;
+            if (retired_pipeline.frames_left == 0) {
+                destroy_vulkan_pipeline(vulkan, retired_pipeline.pipeline);
+            }
+        }
+        std::erase_if(cache.retired_pipelines, [](const RetiredPipeline& retired_pipeline) {
+            return retired_pipeline.frames_left == 0;
+        });
+
+        std::vector<OptimizedPipeline> optimized_pipelines;
+        {
+            std::lock_guard lock(cache.mutex);
+            optimized_pipelines.swap(cache.optimized_pipelines);
+        }
+        for (const OptimizedPipeline& optimized_pipeline : optimized_pipelines) {
+            CachedPipeline& cached_pipeline = *optimized_pipeline.cached_pipeline;
+            // A pipeline that was replaced in the meantime, by a hot reload, is newer than the optimized one
+            if (cached_pipeline.pipeline.handle != optimized_pipeline.linked_pipeline) {
+                destroy_vulkan_pipeline(vulkan, optimized_pipeline.pipeline);
+                continue;
+            }
+            cache.retired_pipelines.push_back({
+                .pipeline = cached_pipeline.pipeline,
+                .frames_left = vulkan.config.max_frames_in_flight,
+            });
+            cached_pipeline.pipeline = optimized_pipeline.pipeline;
+        }
+    }
+
+    bool replace_vulkan_pipeline(Vulkan& vulkan, const PipelineState& full_state, const VulkanPipeline& pipeline) {
+        VulkanPipelineStateCache& cache = vulkan.pipeline_state_cache;
+        PipelineState state = get_pipeline_key_state(vulkan.physical_device_optional_features, full_state);
+        auto [iterator, inserted] = cache.pipelines.try_emplace(state);
+        CachedPipeline& cached_pipeline = iterator->second;
+        if (!inserted && cached_pipeline.status.load(std::memory_order_acquire) == PipelineStatus::Compiling) {
+            return false;
+        }
+        if (cached_pipeline.pipeline.handle != nullptr) {
+            cache.retired_pipelines.push_back({
+                .pipeline = cached_pipeline.pipeline,
+                .frames_left = vulkan.config.max_frames_in_flight,
+            });
+        }
+        cached_pipeline.pipeline = pipeline;
+        cached_pipeline.status.store(PipelineStatus::Ready, std::memory_order_release);
+        return true;
+    }
+
+    void destroy_vulkan_pipelines(Vulkan& vulkan) {
+        VulkanPipelineStateCache& cache = vulkan.pipeline_state_cache;
+
+        // A compile in progress is finished, the requests that are still queued are dropped
+        {
+            std::lock_guard lock(cache.mutex);
+            cache.running = false;
+            cache.compile_requests.clear();
+        }
+        cache.condition.notify_all();
+        for (std::thread& thread : cache.compiler_threads) {
+            thread.join();
+        }
+        cache.compiler_threads.clear();
+
+        GM_LOG_INFO("Pipeline cache had [{}] pipelines, [{}] hits, [{}] misses and [{}] failures, compiling took [{:.1f}] ms, the slowest [{:.1f}] ms",
+            cache.pipelines.size(), cache.hit_count, cache.miss_count, cache.failed_count, cache.creation_time.count(), cache.slowest_creation_time.count());
+        if (cache.fast_link_count > 0) {
+            GM_LOG_INFO("Pipeline cache fast linked [{}] pipelines from [{}] libraries in [{:.3f}] ms on average",
+                cache.fast_link_count, cache.libraries.size(), cache.fast_link_time.count() / (f64) cache.fast_link_count);
+        }
+
+        // Linked pipelines before the libraries they were linked from
+        for (const OptimizedPipeline& optimized_pipeline : cache.optimized_pipelines) {
+            destroy_vulkan_pipeline(vulkan, optimized_pipeline.pipeline);
+        }
+        cache.optimized_pipelines.clear();
+        for (const RetiredPipeline& retired_pipeline : cache.retired_pipelines) {
+            destroy_vulkan_pipeline(vulkan, retired_pipeline.pipeline);
+        }
+        cache.retired_pipelines.clear();
+        for (const auto& [state, cached_pipeline] : cache.pipelines) {
+            if (cached_pipeline.status.load(std::memory_order_acquire) == PipelineStatus::Ready) {
+                destroy_vulkan_pipeline(vulkan, cached_pipeline.pipeline);
+            }
+        }
+        cache.pipelines.clear();
+        for (const auto& [key, library] : cache.libraries) {
+            destroy_vulkan_pipeline(vulkan, library);
+        }
+        cache.libraries.clear();
+        if (!vulkan.config.pipeline_cache_path.empty()) {
+            write_vulkan_pipeline_cache_file(vulkan, vulkan.config.pipeline_cache_path);
+        }
+        for (VkPipelineCache pipeline_cache : cache.compiler_pipeline_caches) {
+            vkDestroyPipelineCache(vulkan.device, pipeline_cache, GM_VK_ALLOCATOR);
+        }
+        cache.compiler_pipeline_caches.clear();
     }
 }
@@ -2,14 +2,71 @@
 
 #include "vulkan.h"
 
+#include <span>
+
 namespace Game {
     struct PipelineConfig {
         std::string name = "Pipeline";
-        std::filesystem::path vertex_shader_path;
-        std::filesystem::path fragment_shader_path;
+        std::span<const u8> vertex_shader_code;   // SPIR-V
+        std::span<const u8> fragment_shader_code; // SPIR-V
+        PipelineState state{}; // Only the fixed function state is read, the code is given above
+        VkPipelineCache pipeline_cache = nullptr; // Optional, must not be used by another thread at the same time
+        VkGraphicsPipelineLibraryFlagsEXT library_parts = 0; // Creates a library of only these parts, if any
+        std::span<const ShaderReflection> shader_reflections; // Of the code above, reflected from the code if empty
     };
 
-    void create_vulkan_pipeline(Vulkan& vulkan, const PipelineConfig& config);
+    // The layout and the vertex input state are reflected from the shaders. Vertex inputs are read from one interleaved
+    // vertex buffer at binding 0, in the order of their locations.
+    // Only reads the device and the render pass from `vulkan`, and the layout cache which has its own lock, so pipelines
+    // can be created on other threads while frames are rendered.
+    // Objects created before a failure are left in `pipeline`, for `destroy_vulkan_pipeline` to clean up.
+    // A library only has the shader modules of its parts, and keeps what is needed for an optimized link.
+    void create_vulkan_pipeline(const Vulkan& vulkan, VulkanPipeline& pipeline, const PipelineConfig& config);
+
+    void destroy_vulkan_pipeline(const Vulkan& vulkan, const VulkanPipeline& pipeline);
+
+    // Reflects every embedded shader, so that compiling pipelines doesn't parse their SPIR-V again. Doesn't need the
+    // device, so it can run on another thread while the device is created, but must be done before it is.
+    void reflect_embedded_shaders(Vulkan& vulkan);
+
+    // Returns the reflection from `reflect_embedded_shaders`, or reflects the shader if it wasn't reflected up front.
+    ShaderReflection get_embedded_shader_reflection(const Vulkan& vulkan, u64 shader_hash);
+
+    // Reads the pipeline cache that an earlier run saved, if there is one. Doesn't need the device, so it can run on
+    // another thread while the device is created, but must be done before the pipelines are created.
+    void read_vulkan_pipeline_cache_file(Vulkan& vulkan, const std::filesystem::path& path);
+
+    // Starts the compiler threads of the pipeline state cache. Their caches start from the pipeline cache file if it
+    // was saved on the same device and driver.
+    void create_vulkan_pipelines(Vulkan& vulkan);
+
+    // Returns null until the pipeline is ready. The first lookup of a state queues the pipeline to be compiled from the
+    // embedded shaders with the hashes in the state, and a pipeline that fails to compile is never ready. The caller
+    // can draw with a fallback pipeline or skip the draw in the meantime. Only call from the thread that renders.
+    // With the graphics pipeline library, a state whose parts all have libraries already is fast linked right away.
+    // States that only differ in fields that are dynamic on the device share a pipeline.
+    const VulkanPipeline* get_vulkan_pipeline(Vulkan& vulkan, const PipelineState& state);
+
+    // Sets the fields of the state that are dynamic on this device, and does nothing when none are.
+    void set_vulkan_pipeline_dynamic_state(const Vulkan& vulkan, VkCommandBuffer command_buffer, const PipelineState& state);
+
+    // The blend equation of a blend mode, the same for pipelines and shader objects. Unused with BlendMode::Opaque,
+    // which disables blending.
+    VkColorBlendEquationEXT get_color_blend_equation(BlendMode blend_mode);
+
+    // Sets the blend enable and the blend equation of the blend mode, with VK_EXT_extended_dynamic_state3.
+    void set_vulkan_color_blend(const Vulkan& vulkan, VkCommandBuffer command_buffer, BlendMode blend_mode);
+
+    // Swaps in the optimized links of fast linked pipelines, and destroys replaced pipelines once no frame in flight can
+    // be using them. Call at the start of every frame, after waiting for the frame's fence.
+    void update_vulkan_pipelines(Vulkan& vulkan);
+
+    // Puts a pipeline rebuilt from changed shaders in place of the pipeline of the state. The replaced pipeline is
+    // destroyed by update_vulkan_pipelines once no frame in flight can be using it. Returns false, without replacing,
+    // while the pipeline of the state is still compiling.
+    bool replace_vulkan_pipeline(Vulkan& vulkan, const PipelineState& state, const VulkanPipeline& pipeline);
 
-    void destroy_vulkan_pipeline(const Vulkan& vulkan);
+    // Stops the compiler threads and destroys the pipelines and the libraries, after saving the caches of the compiler
+    // threads to the pipeline cache file. Call when the device is idle.
+    void destroy_vulkan_pipelines(Vulkan& vulkan);
 }
@@ -0,0 +1,219 @@
+#include "vulkan_shader_object.h"
+#include "embedded_shader.h"
+#include "spirv_reflection.h"
+#include "vulkan_layout_cache.h"
+#include "vulkan_pipeline.h"
+#include "system/hash.h"
+
+namespace Game {
+    // FNV-1a of the shader and the layout
+    u64 ShaderObjectKeyHash::operator()(const ShaderObjectKey& key) const {
+        u64 hash = hash_combine(fnv1a_offset_basis, key.shader);
+        return hash_combine(hash, (u64) (uintptr_t) key.layout);
+    }
+
+    // FNV-1a of both shaders
+    u64 ShaderPairHash::operator()(const ShaderPair& shader_pair) const {
+        u64 hash = hash_combine(fnv1a_offset_basis, shader_pair.first);
+        return hash_combine(hash, shader_pair.second);
+    }
+
+    // Shaders are created unlinked, so that one shader can be bound together with any other that uses the same layout
+    VkShaderEXT get_shader_object(
+        Vulkan& vulkan,
+        u64 shader_hash,
+        std::span<const u8> shader_code,
+        VkShaderStageFlagBits stage,
+        VkShaderStageFlags next_stage,
+        const VulkanPipelineLayoutDescription& layout_description
+    ) {
+        VulkanShaderObjectCache& cache = vulkan.shader_object_cache;
+        ShaderObjectKey key{
+            .shader = shader_hash,
+            .layout = layout_description.layout,
+        };
+        auto iterator = cache.shaders.find(key);
+        if (iterator != cache.shaders.end()) {
+            return iterator->second;
+        }
+
+        VkShaderCreateInfoEXT shader_create_info{};
+        shader_create_info.sType = VK_STRUCTURE_TYPE_SHADER_CREATE_INFO_EXT;
+        shader_create_info.stage = stage;
+        shader_create_info.nextStage = next_stage;
+        shader_create_info.codeType = VK_SHADER_CODE_TYPE_SPIRV_EXT;
+        shader_create_info.codeSize = shader_code.size();
+        shader_create_info.pCode = shader_code.data();
+        shader_create_info.pName = "main";
+        shader_create_info.setLayoutCount = (u32) layout_description.descriptor_set_layouts.size();
+        shader_create_info.pSetLayouts = layout_description.descriptor_set_layouts.data();
+        shader_create_info.pushConstantRangeCount = (u32) layout_description.push_constant_ranges.size();
+        shader_create_info.pPushConstantRanges = layout_description.push_constant_ranges.data();
+
+        VkShaderEXT shader;
+        if (vulkan.device_functions.create_shaders(vulkan.device, 1, &shader_create_info, GM_VK_ALLOCATOR, &shader) != VK_SUCCESS) {
+            GM_THROW("Could not create Vulkan shader object of embedded shader [" << std::hex << shader_hash << std::dec << "]");
+        }
+
+        std::string shader_name = std::format("ShaderObject {:016x} {}", shader_hash, stage == VK_SHADER_STAGE_VERTEX_BIT ? "Vertex" : "Fragment");
+        set_vulkan_object_name(vulkan.device, shader, VK_OBJECT_TYPE_SHADER_EXT, shader_name.c_str());
+
+        cache.shaders.emplace(key, shader);
+        GM_LOG_DEBUG("Created [{}]", shader_name);
+        return shader;
+    }
+
+    void create_shader_objects(Vulkan& vulkan, VulkanShaderObjects& shader_objects, u64 vertex_shader, u64 fragment_shader) {
+        std::span<const u8> vertex_shader_code = get_embedded_shader_bytes(get_embedded_shader(vertex_shader));
+        std::span<const u8> fragment_shader_code = get_embedded_shader_bytes(get_embedded_shader(fragment_shader));
+
+        ShaderReflection shader_reflections[] = {
+            get_embedded_shader_reflection(vulkan, vertex_shader),
+            get_embedded_shader_reflection(vulkan, fragment_shader),
+        };
+        const ShaderReflection& vertex_shader_reflection = shader_reflections[0];
+        if (vertex_shader_reflection.stage != VK_SHADER_STAGE_VERTEX_BIT || shader_reflections[1].stage != VK_SHADER_STAGE_FRAGMENT_BIT) {
+            GM_THROW("Shader objects need a vertex shader and a fragment shader");
+        }
+
+        // The same layout as a pipeline of the same shaders, so that push constants and descriptors are bound the same way
+        VulkanPipelineLayoutDescription layout_description = get_vulkan_pipeline_layout_description(vulkan, shader_reflections);
+        shader_objects.layout = layout_description.layout;
+        shader_objects.vertex_shader = get_shader_object(vulkan, vertex_shader, vertex_shader_code, VK_SHADER_STAGE_VERTEX_BIT, VK_SHADER_STAGE_FRAGMENT_BIT, layout_description);
+        shader_objects.fragment_shader = get_shader_object(vulkan, fragment_shader, fragment_shader_code, VK_SHADER_STAGE_FRAGMENT_BIT, 0, layout_description);
+
+        // Vertex inputs are read from one interleaved vertex buffer at binding 0, like for pipelines
+        VkVertexInputBindingDescription2EXT& vertex_binding = shader_objects.vertex_binding;
+        vertex_binding.sType = VK_STRUCTURE_TYPE_VERTEX_INPUT_BINDING_DESCRIPTION_2_EXT;
+        vertex_binding.binding = 0;
+        vertex_binding.stride = 0;
+        vertex_binding.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+        vertex_binding.divisor = 1;
+        for (const ReflectedVertexInput& vertex_input : vertex_shader_reflection.vertex_inputs) {
+            VkVertexInputAttributeDescription2EXT& vertex_attribute = shader_objects.vertex_attributes.emplace_back();
+            vertex_attribute.sType = VK_STRUCTURE_TYPE_VERTEX_INPUT_ATTRIBUTE_DESCRIPTION_2_EXT;
+            vertex_attribute.location = vertex_input.location;
+            vertex_attribute.binding = vertex_binding.binding;
+            vertex_attribute.format = vertex_input.format;
+            vertex_attribute.offset = vertex_binding.stride;
+            vertex_binding.stride += vertex_input.size;
+        }
+    }
+
+    const VulkanShaderObjects* get_vulkan_shader_objects(Vulkan& vulkan, u64 vertex_shader, u64 fragment_shader) {
+        auto [iterator, inserted] = vulkan.shader_object_cache.shader_pairs.try_emplace(ShaderPair{vertex_shader, fragment_shader});
+        VulkanShaderObjects& shader_objects = iterator->second;
+        if (!inserted) {
+            return shader_objects.failed ? nullptr : &shader_objects;
+        }
+        try {
+            create_shader_objects(vulkan, shader_objects, vertex_shader, fragment_shader);
+        } catch (const std::exception& e) {
+            // Shaders that were created before the failure stay in the cache, to be destroyed with it
+            shader_objects.failed = true;
+            GM_LOG_ERROR("Could not create shader objects of embedded shaders [{:016x}] and [{:016x}]: {}", vertex_shader, fragment_shader, e.what());
+            return nullptr;
+        }
+        return &shader_objects;
+    }
+
+    void bind_vulkan_shader_objects(const Vulkan& vulkan, VkCommandBuffer command_buffer, const VulkanShaderObjects& shader_objects, const PipelineState& state) {
+        const VulkanDeviceFunctions& functions = vulkan.device_functions;
+        // Every supported feature is enabled on the device, and the state of the enabled features must be set as well
+        const VkPhysicalDeviceFeatures& features = vulkan.physical_device_features;
+
+        //
+        // Shaders
+        //
+
+        // Stages that the device supports are bound to nothing when they are not used
+        VkShaderStageFlagBits stages[5];
+        VkShaderEXT shaders[5];
+        u32 stage_count = 0;
+        auto add_stage = [&](VkShaderStageFlagBits stage, VkShaderEXT shader) {
+            stages[stage_count] = stage;
+            shaders[stage_count] = shader;
+            stage_count++;
+        };
+        add_stage(VK_SHADER_STAGE_VERTEX_BIT, shader_objects.vertex_shader);
+        add_stage(VK_SHADER_STAGE_FRAGMENT_BIT, shader_objects.fragment_shader);
+        if (features.tessellationShader) {
+            add_stage(VK_SHADER_STAGE_TESSELLATION_CONTROL_BIT, nullptr);
+            add_stage(VK_SHADER_STAGE_TESSELLATION_EVALUATION_BIT, nullptr);
+        }
+        if (features.geometryShader) {
+            add_stage(VK_SHADER_STAGE_GEOMETRY_BIT, nullptr);
+        }
+        functions.cmd_bind_shaders(command_buffer, stage_count, stages, shaders);
+
+        //
+        // Vertex input and input assembly
+        //
+
+        u32 vertex_binding_count = shader_objects.vertex_attributes.empty() ? 0 : 1;
+        functions.cmd_set_vertex_input(command_buffer, vertex_binding_count, &shader_objects.vertex_binding, (u32) shader_objects.vertex_attributes.size(), shader_objects.vertex_attributes.data());
+        vkCmdSetPrimitiveTopology(command_buffer, state.topology);
+        vkCmdSetPrimitiveRestartEnable(command_buffer, VK_FALSE);
+
+        //
+        // Rasterization
+        //
+
+        vkCmdSetRasterizerDiscardEnable(command_buffer, VK_FALSE);
+        functions.cmd_set_polygon_mode(command_buffer, state.polygon_mode);
+        vkCmdSetCullMode(command_buffer, state.cull_mode);
+        vkCmdSetFrontFace(command_buffer, state.front_face);
+        vkCmdSetDepthBiasEnable(command_buffer, VK_FALSE);
+        vkCmdSetLineWidth(command_buffer, 1.0f);
+        if (features.depthClamp) {
+            functions.cmd_set_depth_clamp_enable(command_buffer, VK_FALSE);
+        }
+
+        //
+        // Multisampling
+        //
+
+        VkSampleMask sample_mask = ~0u; // Covers up to 32 samples
+        functions.cmd_set_rasterization_samples(command_buffer, state.sample_count);
+        functions.cmd_set_sample_mask(command_buffer, state.sample_count, &sample_mask);
+        functions.cmd_set_alpha_to_coverage_enable(command_buffer, VK_FALSE);
+        if (features.alphaToOne) {
+            functions.cmd_set_alpha_to_one_enable(command_buffer, VK_FALSE);
+        }
+
+        //
+        // Depth and stencil
+        //
+
+        bool depth_test_enabled = state.depth_format != VK_FORMAT_UNDEFINED;
+        vkCmdSetDepthTestEnable(command_buffer, depth_test_enabled ? VK_TRUE : VK_FALSE);
+        vkCmdSetDepthWriteEnable(command_buffer, depth_test_enabled && state.depth_write_enabled ? VK_TRUE : VK_FALSE);
+        vkCmdSetDepthCompareOp(command_buffer, state.depth_compare_op);
+        if (features.depthBounds) {
+            vkCmdSetDepthBoundsTestEnable(command_buffer, VK_FALSE);
+        }
+        vkCmdSetStencilTestEnable(command_buffer, VK_FALSE);
+
+        //
+        // Color blending, the same as for pipelines
+        //
+
+        if (features.logicOp) {
+            functions.cmd_set_logic_op_enable(command_buffer, VK_FALSE);
+        }
+
+        set_vulkan_color_blend(vulkan, command_buffer, state.blend_mode);
+
+        VkColorComponentFlags color_write_mask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+        functions.cmd_set_color_write_mask(command_buffer, 0, 1, &color_write_mask);
+    }
+
+    void destroy_vulkan_shader_objects(Vulkan& vulkan) {
+        VulkanShaderObjectCache& cache = vulkan.shader_object_cache;
+        for (const auto& [key, shader] : cache.shaders) {
+            vulkan.device_functions.destroy_shader(vulkan.device, shader, GM_VK_ALLOCATOR);
+        }
+        cache.shaders.clear();
+        cache.shader_pairs.clear();
+    }
+}
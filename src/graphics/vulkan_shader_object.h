@@ -0,0 +1,20 @@
+#pragma once
+
+#include "vulkan.h"
+
+// Draws with VK_EXT_shader_object instead of pipelines, when the device supports it. Shaders are bound individually
+// and the fixed function state of a PipelineState is set when recording, so that drawing with a new combination of
+// shaders or state doesn't create a pipeline. Shader objects are drawn inside dynamic rendering instead of a render pass.
+
+namespace Game {
+    // Creates the shader objects of the embedded shaders on first use, on the calling thread. Returns null if they
+    // could not be created, which is logged once. Only call from the thread that renders.
+    const VulkanShaderObjects* get_vulkan_shader_objects(Vulkan& vulkan, u64 vertex_shader, u64 fragment_shader);
+
+    // Binds the shaders and sets every piece of state that drawing with shader objects needs, apart from the viewport
+    // and the scissor, which are set with vkCmdSetViewportWithCount and vkCmdSetScissorWithCount.
+    void bind_vulkan_shader_objects(const Vulkan& vulkan, VkCommandBuffer command_buffer, const VulkanShaderObjects& shader_objects, const PipelineState& state);
+
+    // Call when the device is idle, before the layout cache is destroyed.
+    void destroy_vulkan_shader_objects(Vulkan& vulkan);
+}
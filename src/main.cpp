@@ -8,11 +8,22 @@ int main() {
         Game::run(config);
     } catch (const Game::Error& e) {
         GM_LOG_CRITICAL("Fatal error");
+        Game::dump_flight_recorder("error", EXIT_FAILURE);
+        Game::shutdown_flight_recorder();
+        Game::shutdown_binary_log();
+        Game::shutdown_log();
         e.printStacktrace();
         return EXIT_FAILURE;
     } catch (const std::exception& e) {
         GM_LOG_CRITICAL("Fatal error: {}", e.what());
+        Game::dump_flight_recorder("error", EXIT_FAILURE);
+        Game::shutdown_flight_recorder();
+        Game::shutdown_binary_log();
+        Game::shutdown_log();
         return EXIT_FAILURE;
     }
+    Game::shutdown_flight_recorder();
+    Game::shutdown_binary_log();
+    Game::shutdown_log();
     return EXIT_SUCCESS;
 }
@@ -1,39 +1,75 @@
 #include "run.h"
 #include "game_loop.h"
-#include "window/key_event.h"
+#include "graphics/vulkan_physical_device.h"
+#include "world/transform.h"
 
 namespace Game {
-    void on_event(App& app, Event& e) {
-        if (e.type == EventType::WindowClose) {
+    bool on_window_close(void* user_data, const Event&) {
+        stop_app(*(App*) user_data);
+        return true;
+    }
+
+    bool on_key_pressed(void* user_data, const Event& event) {
+        App& app = *(App*) user_data;
+        if (event.key.key == Key::Escape) {
             stop_app(app);
-            return;
+            return true;
         }
-        if (e.type == EventType::KeyPressed) {
-            auto& event = (KeyPressedEvent&) e;
-            if (event.key == Key::Escape) {
-                stop_app(app);
-                return;
-            }
+        if (event.key.key == Key::F1) {
+            log_system_timings(app.system_scheduler);
+            return true;
         }
-        handle_renderer_event(app.renderer, e);
+        if (event.key.key == Key::F2) {
+            log_vulkan_physical_device_reports(app.renderer.vulkan);
+            return true;
+        }
+        return false;
+    }
+
+    bool on_renderer_event(void* user_data, const Event& event) {
+        return handle_renderer_event(*(Renderer*) user_data, event);
     }
 
     void update(App& app, f64 timestep) {
+        run_systems(app.system_scheduler, app.world, app.job_system, timestep);
     }
 
-    void render(App& app) {
-        render_frame(app.renderer);
+    void render(App& app, f64 alpha) {
+        get_interpolated_transforms(app.world, (f32) alpha, app.renderer.transforms);
+        bool drew = render_frame(app.renderer);
+        if (drew && !app.first_frame_rendered) {
+            app.first_frame_rendered = true;
+            GM_LOG_INFO("Submitted the first drawn frame [{:.3f} ms] after startup began", Time::as<Microseconds>(Time::now() - app.start_time).count() / 1000.0);
+        }
     }
 
     void init(App& app) {
-        set_window_event_listener(app.window, [&app](Event& event) {
-           on_event(app, event);
+        add_event_listener(app.event_dispatcher, EventType::WindowClose, on_window_close, &app);
+        add_event_listener(app.event_dispatcher, EventType::KeyPressed, on_key_pressed, &app);
+        add_event_listener(app.event_dispatcher, EventType::WindowResize, on_renderer_event, &app.renderer);
+
+        add_transform_snapshot_system(app.system_scheduler);
+
+        create_entity(app.world, Transform{}, PreviousTransform{});
+
+        add_system(app.system_scheduler, {
+            .name = "Spin",
+            .writes = get_component_mask<Transform>(),
+            .on_update = [&app](World& world, JobSystem&, f64 timestep) {
+                // Input is only updated between ticks, so it is safe to poll from systems running on the workers
+                f32 radians_per_second = is_key_down(app.window.input, Key::Space) ? 4.0f : 1.0f;
+                for_each<Transform>(world, [timestep, radians_per_second](Transform& transform) {
+                    transform.rotation += radians_per_second * (f32) timestep;
+                });
+            },
         });
     }
 
     void init(const AppConfig& config) {
         initialize_error_signal_handlers();
-        initialize_log(config.log_level);
+        initialize_log(config.log);
+        initialize_binary_log(config.binary_log);
+        initialize_flight_recorder(config.flight_recorder);
     }
 
     void run(const AppConfig& config) {
@@ -43,12 +79,38 @@ namespace Game {
         create_app(app, config);
         init(app);
 
+        GameLoopStats game_loop_stats{};
+
         start_app(app);
         run_game_loop(app, {
             .on_update = update,
             .on_render = render,
+            .update_rate = 30.0, // Rendering is interpolated, so the simulation doesn't need to run at display rate
+            .max_frame_rate = (f64) get_window_refresh_rate(app.window),
+            .stats = &game_loop_stats,
         });
 
+        if (game_loop_stats.overloaded_frame_count > 0) {
+            GM_LOG_INFO(
+                "Game loop was overloaded in [{}/{}] frames, dropped [{}] ticks ([{:.1f} ms])",
+                game_loop_stats.overloaded_frame_count,
+                game_loop_stats.frame_count,
+                game_loop_stats.dropped_tick_count,
+                game_loop_stats.dropped_time_ms
+            );
+        }
+
+        GM_LOG_INFO(
+            "Frame pacing jitter average [{:.3f} ms], max [{:.3f} ms]",
+            game_loop_stats.frame_pacer.average_jitter_ms,
+            game_loop_stats.frame_pacer.max_jitter_ms
+        );
+
+        u64 dropped_input_event_count = app.window.dropped_input_event_count.load(std::memory_order_relaxed);
+        if (dropped_input_event_count > 0) {
+            GM_LOG_WARNING("Dropped [{}] input events, the input queue was full", dropped_input_event_count);
+        }
+
         destroy_app(app);
     }
 }
\ No newline at end of file
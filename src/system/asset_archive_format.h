@@ -0,0 +1,53 @@
+#pragma once
+
+#include "system/hash.h"
+#include "system/numbers.h"
+
+#include <string_view>
+
+// File format of the asset archive written by the packer tool.
+//
+// An archive starts with an AssetArchiveHeader, followed by the data of every entry, aligned to
+// asset_archive_alignment. The index at `index_offset` is an array of AssetArchiveEntry sorted by path hash, followed
+// by the string table with the paths of the entries (not null-terminated), which is only used to confirm a lookup.
+//
+// Paths are relative to the packed directory and use forward slashes, e.g. "shaders/triangle.vert.spv".
+
+namespace Game {
+    constexpr char asset_archive_magic[8] = {'G', 'M', 'P', 'A', 'K', '0', '0', '1'};
+    constexpr u32 asset_archive_version = 1;
+    constexpr u64 asset_archive_alignment = 16;
+
+    enum class AssetCompression : u32 {
+        None = 0,
+        Lz4 = 1, // LZ4 block
+    };
+
+    struct AssetArchiveHeader {
+        char magic[8];
+        u32 version = asset_archive_version;
+        u32 entry_count = 0;
+        u64 index_offset = 0;
+        u64 string_table_offset = 0;
+        u64 string_table_size = 0;
+    };
+
+    struct AssetArchiveEntry {
+        u64 path_hash = 0;
+        u64 offset = 0;            // Offset of the data from the start of the archive
+        u64 size = 0;              // Size of the data in the archive
+        u64 uncompressed_size = 0;
+        u32 path_offset = 0;       // Offset of the path in the string table
+        u32 path_size = 0;
+        AssetCompression compression = AssetCompression::None;
+        u32 reserved = 0;
+    };
+
+    static_assert(sizeof(AssetArchiveHeader) == 40);
+    static_assert(sizeof(AssetArchiveEntry) == 48);
+
+    // FNV-1a hash of the path
+    constexpr u64 get_asset_path_hash(std::string_view path) {
+        return hash_bytes(fnv1a_offset_basis, path);
+    }
+}
@@ -0,0 +1,224 @@
+#include "async_log_sink.h"
+
+namespace Game {
+    AsyncLogSink::AsyncLogSink(const AsyncLogSinkConfig& config) : config(config) {
+        if (config.queue_size == 0 || (config.queue_size & (config.queue_size - 1)) != 0) {
+            GM_THROW("Async log queue size [" << config.queue_size << "] must be a power of two");
+        }
+        slots = std::make_unique<AsyncLogSlot[]>(config.queue_size);
+        mask = config.queue_size - 1;
+        for (u64 i = 0; i < config.queue_size; ++i) {
+            slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        running.store(true, std::memory_order_release);
+        writer_thread = std::thread(&AsyncLogSink::write_messages, this);
+    }
+
+    AsyncLogSink::~AsyncLogSink() {
+        shutdown();
+    }
+
+    void AsyncLogSink::log(const spdlog::details::log_msg& message) {
+        // Registered before checking whether the sink has stopped, so that shutdown either sees this thread and waits
+        // for its message to be queued, or this thread sees the shutdown and writes the message itself
+        logging_thread_count.fetch_add(1, std::memory_order_seq_cst);
+        if (stopped.load(std::memory_order_seq_cst)) {
+            logging_thread_count.fetch_sub(1, std::memory_order_release);
+            std::lock_guard lock(stopped_mutex);
+            for (const spdlog::sink_ptr& sink : config.sinks) {
+                if (sink->should_log(message.level)) {
+                    sink->log(message);
+                }
+            }
+            return;
+        }
+        while (!try_enqueue(message)) {
+            if (config.overflow_policy == LogOverflowPolicy::DropNewest) {
+                dropped_message_count.fetch_add(1, std::memory_order_relaxed);
+                logging_thread_count.fetch_sub(1, std::memory_order_release);
+                return;
+            }
+            if (config.overflow_policy == LogOverflowPolicy::DropOldest) {
+                AsyncLogMessage dropped_message;
+                if (try_dequeue(dropped_message)) {
+                    dropped_message_count.fetch_add(1, std::memory_order_relaxed);
+                }
+                continue;
+            }
+            std::this_thread::yield();
+        }
+        logging_thread_count.fetch_sub(1, std::memory_order_release);
+        enqueue_generation.fetch_add(1, std::memory_order_release);
+        enqueue_generation.notify_one();
+    }
+
+    void AsyncLogSink::flush() {
+        if (stopped.load(std::memory_order_acquire)) {
+            std::lock_guard lock(stopped_mutex);
+            for (const spdlog::sink_ptr& sink : config.sinks) {
+                sink->flush();
+            }
+            return;
+        }
+        flush_requested.store(true, std::memory_order_relaxed);
+        enqueue_generation.fetch_add(1, std::memory_order_release);
+        enqueue_generation.notify_one();
+    }
+
+    void AsyncLogSink::set_pattern(const std::string& pattern) {
+        for (const spdlog::sink_ptr& sink : config.sinks) {
+            sink->set_pattern(pattern);
+        }
+    }
+
+    void AsyncLogSink::set_formatter(std::unique_ptr<spdlog::formatter> formatter) {
+        for (const spdlog::sink_ptr& sink : config.sinks) {
+            sink->set_formatter(formatter->clone());
+        }
+    }
+
+    void AsyncLogSink::shutdown() {
+        if (!running.exchange(false, std::memory_order_acq_rel)) {
+            return;
+        }
+
+        // Held until the queue is empty, so that messages logged from now on are written after the queued ones
+        std::lock_guard lock(stopped_mutex);
+        stopped.store(true, std::memory_order_seq_cst);
+        enqueue_generation.fetch_add(1, std::memory_order_release);
+        enqueue_generation.notify_one();
+        writer_thread.join();
+
+        // Threads that started logging before the sink stopped may still be enqueueing. Keep draining, since a
+        // thread that blocks on a full queue only finishes once there is room.
+        AsyncLogMessage message;
+        while (true) {
+            bool logging = logging_thread_count.load(std::memory_order_seq_cst) > 0;
+            while (try_dequeue(message)) {
+                write_message(message);
+            }
+            if (!logging) {
+                break;
+            }
+            std::this_thread::yield();
+        }
+        for (const spdlog::sink_ptr& sink : config.sinks) {
+            sink->flush();
+        }
+    }
+
+    u64 AsyncLogSink::get_dropped_message_count() const {
+        return dropped_message_count.load(std::memory_order_relaxed);
+    }
+
+    bool AsyncLogSink::try_enqueue(const spdlog::details::log_msg& message) {
+        u64 position = enqueue_position.load(std::memory_order_relaxed);
+        AsyncLogSlot* slot;
+        while (true) {
+            slot = &slots[position & mask];
+            u64 sequence = slot->sequence.load(std::memory_order_acquire);
+            i64 difference = (i64) sequence - (i64) position;
+            if (difference == 0) {
+                if (enqueue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (difference < 0) {
+                return false; // Full
+            } else {
+                position = enqueue_position.load(std::memory_order_relaxed);
+            }
+        }
+
+        AsyncLogMessage& queued_message = slot->message;
+        queued_message.time = message.time;
+        queued_message.source = message.source;
+        queued_message.logger_name = message.logger_name;
+        queued_message.thread_id = message.thread_id;
+        queued_message.level = message.level;
+        queued_message.payload_size = (u32) std::min<size_t>(message.payload.size(), max_async_log_message_size);
+        std::memcpy(queued_message.payload, message.payload.data(), queued_message.payload_size);
+
+        slot->sequence.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool AsyncLogSink::try_dequeue(AsyncLogMessage& message) {
+        u64 position = dequeue_position.load(std::memory_order_relaxed);
+        AsyncLogSlot* slot;
+        while (true) {
+            slot = &slots[position & mask];
+            u64 sequence = slot->sequence.load(std::memory_order_acquire);
+            i64 difference = (i64) sequence - (i64) (position + 1);
+            if (difference == 0) {
+                if (dequeue_position.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (difference < 0) {
+                return false; // Empty
+            } else {
+                position = dequeue_position.load(std::memory_order_relaxed);
+            }
+        }
+
+        // Only copy the part of the payload that is in use
+        message.time = slot->message.time;
+        message.source = slot->message.source;
+        message.logger_name = slot->message.logger_name;
+        message.thread_id = slot->message.thread_id;
+        message.level = slot->message.level;
+        message.payload_size = slot->message.payload_size;
+        std::memcpy(message.payload, slot->message.payload, message.payload_size);
+
+        slot->sequence.store(position + mask + 1, std::memory_order_release);
+        return true;
+    }
+
+    void AsyncLogSink::write_message(const AsyncLogMessage& message) {
+        spdlog::details::log_msg log_message(
+            message.time,
+            message.source,
+            message.logger_name,
+            message.level,
+            spdlog::string_view_t(message.payload, message.payload_size)
+        );
+        log_message.thread_id = message.thread_id;
+        for (const spdlog::sink_ptr& sink : config.sinks) {
+            if (sink->should_log(message.level)) {
+                sink->log(log_message);
+            }
+        }
+    }
+
+    void AsyncLogSink::write_messages() {
+        AsyncLogMessage message;
+        while (true) {
+            u32 generation = enqueue_generation.load(std::memory_order_acquire);
+
+            bool wrote_messages = false;
+            while (try_dequeue(message)) {
+                write_message(message);
+                wrote_messages = true;
+            }
+
+            if (flush_requested.exchange(false, std::memory_order_relaxed)) {
+                for (const spdlog::sink_ptr& sink : config.sinks) {
+                    sink->flush();
+                }
+            }
+
+            if (!running.load(std::memory_order_acquire)) {
+                // Write whatever was queued while stopping
+                if (!wrote_messages) {
+                    for (const spdlog::sink_ptr& sink : config.sinks) {
+                        sink->flush();
+                    }
+                    return;
+                }
+                continue;
+            }
+            if (!wrote_messages) {
+                enqueue_generation.wait(generation, std::memory_order_acquire);
+            }
+        }
+    }
+}
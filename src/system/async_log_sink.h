@@ -0,0 +1,86 @@
+#pragma once
+
+#include <spdlog/sinks/sink.h>
+
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+namespace Game {
+    struct AsyncLogSinkConfig {
+        std::vector<spdlog::sink_ptr> sinks;
+        u32 queue_size = 8192; // Must be a power of two
+        LogOverflowPolicy overflow_policy = LogOverflowPolicy::DropOldest;
+    };
+
+    // Longer messages are truncated, which keeps the queue slots fixed-size and logging free of allocations
+    constexpr u32 max_async_log_message_size = 952;
+
+    struct AsyncLogMessage {
+        spdlog::log_clock::time_point time;
+        spdlog::source_loc source;
+        spdlog::string_view_t logger_name;
+        size_t thread_id = 0;
+        spdlog::level::level_enum level = spdlog::level::off;
+        u32 payload_size = 0;
+        char payload[max_async_log_message_size];
+    };
+
+    struct AsyncLogSlot {
+        std::atomic<u64> sequence = 0;
+        AsyncLogMessage message;
+    };
+
+    static_assert(sizeof(AsyncLogSlot) <= 1024);
+
+    // Sink that hands the messages to a writer thread, which writes them to the actual sinks. The logging thread
+    // only copies the message into a lock-free bounded multi-producer queue, so it never blocks on terminal or
+    // disk I/O. The queue is the bounded MPMC queue by Dmitry Vyukov, where every slot has a sequence number that
+    // tells producers and consumers whose turn it is, so they only contend on the enqueue and dequeue positions.
+    class AsyncLogSink final : public spdlog::sinks::sink {
+    private:
+        AsyncLogSinkConfig config;
+        std::unique_ptr<AsyncLogSlot[]> slots;
+        u64 mask = 0;
+
+        alignas(64) std::atomic<u64> enqueue_position = 0;
+        alignas(64) std::atomic<u64> dequeue_position = 0;
+        alignas(64) std::atomic<u32> enqueue_generation = 0;
+        std::atomic<u64> dropped_message_count = 0;
+        std::atomic<bool> flush_requested = false;
+        std::atomic<bool> running = false;
+        std::atomic<bool> stopped = false;
+        std::atomic<u32> logging_thread_count = 0; // Threads that are enqueueing, which shutdown waits for
+        std::mutex stopped_mutex; // Serializes the writes to the sinks after shutdown, which may not be thread-safe
+        std::thread writer_thread;
+
+    public:
+        explicit AsyncLogSink(const AsyncLogSinkConfig& config);
+
+        ~AsyncLogSink() override;
+
+        void log(const spdlog::details::log_msg& message) override;
+
+        // Asks the writer thread to flush the sinks once it has written the queued messages.
+        void flush() override;
+
+        void set_pattern(const std::string& pattern) override;
+
+        void set_formatter(std::unique_ptr<spdlog::formatter> formatter) override;
+
+        // Writes all queued messages, flushes the sinks and stops the writer thread.
+        // Messages logged after this are written directly on the logging thread, one thread at a time.
+        void shutdown();
+
+        u64 get_dropped_message_count() const;
+
+    private:
+        bool try_enqueue(const spdlog::details::log_msg& message);
+
+        bool try_dequeue(AsyncLogMessage& message);
+
+        void write_message(const AsyncLogMessage& message);
+
+        void write_messages();
+    };
+}
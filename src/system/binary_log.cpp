@@ -0,0 +1,266 @@
+#include "binary_log.h"
+
+#include <fstream>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+
+namespace Game {
+    // Single-producer, single-consumer byte ring owned by one logging thread and drained by the writer thread.
+    // Positions only ever increase, the offset into the ring is the position masked by the capacity.
+    struct BinaryLogThreadBuffer {
+        std::unique_ptr<u8[]> bytes;
+        u64 capacity = 0;
+        u32 thread_index = 0;
+
+        alignas(64) std::atomic<u64> write_position = 0;
+        u64 cached_read_position = 0;   // Logging thread's copy of the read position
+        u64 pending_write_position = 0; // End of the record that is being written
+
+        alignas(64) std::atomic<u64> read_position = 0;
+    };
+
+    struct BinaryLog {
+        BinaryLogConfig config{};
+        std::ofstream file;
+
+        // Guards the thread buffer list and the sites
+        std::mutex mutex;
+        std::vector<std::unique_ptr<BinaryLogThreadBuffer>> thread_buffers;
+        std::unordered_set<u64> site_ids;
+        std::vector<u8> pending_site_bytes; // Site blocks that have not been written to the file yet
+
+        std::atomic<u64> dropped_record_count = 0;
+        std::atomic<bool> running = false;
+
+        // Threads between begin_binary_log_record and end_binary_log_record, which shutdown waits for
+        std::atomic<u32> logging_thread_count = 0;
+        std::atomic<bool> closed = false;
+        std::thread writer_thread;
+    };
+
+    BinaryLog binary_log{};
+
+    thread_local BinaryLogThreadBuffer* binary_log_thread_buffer = nullptr;
+
+    i64 get_binary_log_time_ns() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    }
+
+    void append_bytes(std::vector<u8>& bytes, const void* data, u64 size) {
+        const u8* begin = static_cast<const u8*>(data);
+        bytes.insert(bytes.end(), begin, begin + size);
+    }
+
+    BinaryLogThreadBuffer* get_binary_log_thread_buffer() {
+        if (binary_log_thread_buffer != nullptr) {
+            return binary_log_thread_buffer;
+        }
+        auto buffer = std::make_unique<BinaryLogThreadBuffer>();
+        buffer->capacity = binary_log.config.thread_buffer_size;
+        buffer->bytes = std::make_unique<u8[]>(buffer->capacity);
+
+        std::lock_guard lock(binary_log.mutex);
+        buffer->thread_index = (u32) binary_log.thread_buffers.size();
+        binary_log_thread_buffer = buffer.get();
+        binary_log.thread_buffers.push_back(std::move(buffer));
+        return binary_log_thread_buffer;
+    }
+
+    bool register_binary_log_site(u64 site_id, LogLevel level, std::string_view format, std::string_view file_name, std::string_view function_name, u32 line_number, std::span<const BinaryLogArgType> arg_types) {
+        std::lock_guard lock(binary_log.mutex);
+
+        // The same site is registered once per template instantiation of the function it's in
+        if (!binary_log.site_ids.insert(site_id).second) {
+            return true;
+        }
+
+        BinaryLogSiteHeader site_header{
+            .site_id = site_id,
+            .line_number = line_number,
+            .level = (u8) level,
+            .arg_count = (u8) arg_types.size(),
+            .format_size = (u16) format.size(),
+            .file_name_size = (u16) file_name.size(),
+            .function_name_size = (u16) function_name.size(),
+        };
+        BinaryLogBlockHeader block_header{
+            .type = BinaryLogBlockType::Site,
+            .size = sizeof(BinaryLogSiteHeader) + arg_types.size() + format.size() + file_name.size() + function_name.size(),
+        };
+
+        std::vector<u8>& bytes = binary_log.pending_site_bytes;
+        append_bytes(bytes, &block_header, sizeof(BinaryLogBlockHeader));
+        append_bytes(bytes, &site_header, sizeof(BinaryLogSiteHeader));
+        append_bytes(bytes, arg_types.data(), arg_types.size());
+        append_bytes(bytes, format.data(), format.size());
+        append_bytes(bytes, file_name.data(), file_name.size());
+        append_bytes(bytes, function_name.data(), function_name.size());
+        return true;
+    }
+
+    u8* begin_binary_log_record(u64 site_id, u32 size) {
+        // Registered before checking whether the log is closed, so that shutdown either sees this thread and waits
+        // for its record, or this thread sees the log closed and counts the record as dropped
+        binary_log.logging_thread_count.fetch_add(1, std::memory_order_seq_cst);
+        if (binary_log.closed.load(std::memory_order_seq_cst)) {
+            binary_log.logging_thread_count.fetch_sub(1, std::memory_order_release);
+            binary_log.dropped_record_count.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        BinaryLogThreadBuffer& buffer = *get_binary_log_thread_buffer();
+
+        u64 record_size = (size + binary_log_record_alignment - 1) & ~(u64) (binary_log_record_alignment - 1);
+        u64 write_position = buffer.write_position.load(std::memory_order_relaxed);
+        u64 offset = write_position & (buffer.capacity - 1);
+
+        // Records are never split across the end of the ring, the rest of the ring is padded instead
+        u64 padding_size = offset + record_size > buffer.capacity ? buffer.capacity - offset : 0;
+        u64 required_size = padding_size + record_size;
+        if (write_position + required_size - buffer.cached_read_position > buffer.capacity) {
+            buffer.cached_read_position = buffer.read_position.load(std::memory_order_acquire);
+            if (write_position + required_size - buffer.cached_read_position > buffer.capacity) {
+                binary_log.logging_thread_count.fetch_sub(1, std::memory_order_release);
+                binary_log.dropped_record_count.fetch_add(1, std::memory_order_relaxed);
+                return nullptr;
+            }
+        }
+
+        if (padding_size > 0) {
+            u32 padding_header[2] = {(u32) padding_size, binary_log_padding_flag};
+            std::memcpy(&buffer.bytes[offset], padding_header, sizeof(padding_header));
+            offset = 0;
+        }
+
+        BinaryLogRecordHeader record_header{
+            .size = (u32) record_size,
+            .site_id = site_id,
+            .time_ns = get_binary_log_time_ns(),
+        };
+        std::memcpy(&buffer.bytes[offset], &record_header, sizeof(BinaryLogRecordHeader));
+
+        buffer.pending_write_position = write_position + required_size;
+        return &buffer.bytes[offset + sizeof(BinaryLogRecordHeader)];
+    }
+
+    void end_binary_log_record() {
+        BinaryLogThreadBuffer& buffer = *binary_log_thread_buffer;
+        buffer.write_position.store(buffer.pending_write_position, std::memory_order_release);
+        binary_log.logging_thread_count.fetch_sub(1, std::memory_order_release);
+    }
+
+    void write_binary_log_buffers() {
+        std::vector<BinaryLogThreadBuffer*> buffers;
+        {
+            std::lock_guard lock(binary_log.mutex);
+            for (const std::unique_ptr<BinaryLogThreadBuffer>& buffer : binary_log.thread_buffers) {
+                buffers.push_back(buffer.get());
+            }
+        }
+
+        // Read the write positions before taking the sites, every site used by a record up to these positions
+        // was registered before the record was written, so it is guaranteed to be in the pending sites.
+        std::vector<u64> write_positions;
+        for (BinaryLogThreadBuffer* buffer : buffers) {
+            write_positions.push_back(buffer->write_position.load(std::memory_order_acquire));
+        }
+
+        std::vector<u8> site_bytes;
+        {
+            std::lock_guard lock(binary_log.mutex);
+            std::swap(site_bytes, binary_log.pending_site_bytes);
+        }
+        binary_log.file.write((const char*) site_bytes.data(), (std::streamsize) site_bytes.size());
+
+        for (u32 i = 0; i < buffers.size(); ++i) {
+            BinaryLogThreadBuffer& buffer = *buffers[i];
+            u64 read_position = buffer.read_position.load(std::memory_order_relaxed);
+            u64 write_position = write_positions[i];
+            if (read_position == write_position) {
+                continue;
+            }
+
+            BinaryLogBlockHeader block_header{
+                .type = BinaryLogBlockType::Records,
+                .thread_index = buffer.thread_index,
+                .size = write_position - read_position,
+            };
+            binary_log.file.write((const char*) &block_header, sizeof(BinaryLogBlockHeader));
+
+            // The readable bytes wrap around the end of the ring at most once
+            u64 offset = read_position & (buffer.capacity - 1);
+            u64 first_size = std::min(block_header.size, buffer.capacity - offset);
+            binary_log.file.write((const char*) &buffer.bytes[offset], (std::streamsize) first_size);
+            binary_log.file.write((const char*) &buffer.bytes[0], (std::streamsize) (block_header.size - first_size));
+
+            buffer.read_position.store(write_position, std::memory_order_release);
+        }
+        binary_log.file.flush();
+    }
+
+    void run_binary_log_writer() {
+        while (binary_log.running.load(std::memory_order_acquire)) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(binary_log.config.flush_interval_ms));
+            write_binary_log_buffers();
+        }
+        write_binary_log_buffers();
+    }
+
+    void initialize_binary_log(const BinaryLogConfig& config) {
+        if (config.file_path.empty()) {
+            return;
+        }
+        if (config.thread_buffer_size == 0 || (config.thread_buffer_size & (config.thread_buffer_size - 1)) != 0) {
+            GM_THROW("Binary log thread buffer size [" << config.thread_buffer_size << "] must be a power of two");
+        }
+        binary_log.config = config;
+
+        if (config.file_path.has_parent_path()) {
+            std::filesystem::create_directories(config.file_path.parent_path());
+        }
+        binary_log.file.open(config.file_path, std::ios::binary | std::ios::trunc);
+        if (!binary_log.file.is_open()) {
+            GM_THROW("Could not open binary log file [" << config.file_path << "]");
+        }
+
+        BinaryLogFileHeader file_header{
+            .start_time_ns = get_binary_log_time_ns(),
+        };
+        std::memcpy(file_header.magic, binary_log_magic, sizeof(binary_log_magic));
+        binary_log.file.write((const char*) &file_header, sizeof(BinaryLogFileHeader));
+
+        binary_log.running.store(true, std::memory_order_release);
+        binary_log.writer_thread = std::thread(run_binary_log_writer);
+        binary_log_level.store(config.level, std::memory_order_relaxed);
+
+        GM_LOG_INFO("Writing binary log to [{}]", config.file_path.string());
+    }
+
+    void shutdown_binary_log() {
+        if (!binary_log.running.load(std::memory_order_acquire)) {
+            return;
+        }
+        binary_log_level.store(LogLevel::off, std::memory_order_relaxed);
+
+        // Threads that passed the level check before it was turned off may still be writing a record. Wait for them,
+        // so that the final write of the writer thread includes their records.
+        binary_log.closed.store(true, std::memory_order_seq_cst);
+        while (binary_log.logging_thread_count.load(std::memory_order_seq_cst) > 0) {
+            std::this_thread::yield();
+        }
+
+        binary_log.running.store(false, std::memory_order_release);
+        binary_log.writer_thread.join();
+        binary_log.file.close();
+
+        u64 dropped_record_count = get_dropped_binary_log_record_count();
+        if (dropped_record_count > 0) {
+            GM_LOG_WARNING("Dropped [{}] binary log records, the thread buffers were full or the log was shut down", dropped_record_count);
+        }
+    }
+
+    u64 get_dropped_binary_log_record_count() {
+        return binary_log.dropped_record_count.load(std::memory_order_relaxed);
+    }
+}
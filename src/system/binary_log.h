@@ -0,0 +1,152 @@
+#pragma once
+
+#include "system/binary_log_format.h"
+#include "system/hash.h"
+#include "system/log.h"
+
+#include <atomic>
+#include <cstring>
+#include <span>
+#include <string_view>
+
+// Binary logging defers formatting to the decoder tool. Each call site gets a compile-time ID from its format string
+// and source location, and is described once in the log. The logging thread only copies the raw argument bytes into
+// its own buffer, which a background thread writes to disk, so trace-level logs are cheap enough to keep on the render path.
+//
+// Arguments must be numbers, booleans, characters, pointers or strings. Format strings use the same syntax as GM_LOG.
+
+#define GM_BINARY_LOG(level, format, ...) \
+    do { \
+        if (::Game::is_binary_log_enabled(level)) { \
+            static constexpr u64 gm_binary_log_site_id = ::Game::get_binary_log_site_id(format, GM_FILE_NAME, GM_LINE_NUMBER); \
+            static const bool gm_binary_log_site_registered = ::Game::register_binary_log_site(gm_binary_log_site_id, level, format, GM_FILE_NAME, GM_FUNCTION_NAME, GM_LINE_NUMBER, ##__VA_ARGS__); \
+            (void) gm_binary_log_site_registered; \
+            ::Game::write_binary_log(gm_binary_log_site_id, ##__VA_ARGS__); \
+        } \
+    } while (false)
+
+#define GM_BINARY_LOG_TRACE(format, ...) GM_BINARY_LOG(::Game::LogLevel::trace, format, ##__VA_ARGS__)
+#define GM_BINARY_LOG_DEBUG(format, ...) GM_BINARY_LOG(::Game::LogLevel::debug, format, ##__VA_ARGS__)
+#define GM_BINARY_LOG_INFO(format, ...) GM_BINARY_LOG(::Game::LogLevel::info, format, ##__VA_ARGS__)
+#define GM_BINARY_LOG_WARNING(format, ...) GM_BINARY_LOG(::Game::LogLevel::warn, format, ##__VA_ARGS__)
+#define GM_BINARY_LOG_ERROR(format, ...) GM_BINARY_LOG(::Game::LogLevel::err, format, ##__VA_ARGS__)
+
+namespace Game {
+    struct BinaryLogConfig {
+        // Binary logging is disabled when no path is set
+        std::filesystem::path file_path;
+        LogLevel level = LogLevel::trace;
+
+        // Size of the buffer of every logging thread, must be a power of two. Records that don't fit are dropped.
+        u32 thread_buffer_size = 1024 * 1024;
+
+        // How often the buffers are written to disk
+        u32 flush_interval_ms = 10;
+    };
+
+    void initialize_binary_log(const BinaryLogConfig& config);
+
+    // Waits for records that are being written, then writes all buffered records and closes the log file.
+    void shutdown_binary_log();
+
+    // Records dropped because a thread buffer was full or the log was shut down.
+    u64 get_dropped_binary_log_record_count();
+
+    // Set by initialize_binary_log and turned off by shutdown_binary_log, while other threads may be logging.
+    inline std::atomic<LogLevel> binary_log_level = LogLevel::off;
+
+    inline bool is_binary_log_enabled(LogLevel level) {
+        LogLevel enabled_level = binary_log_level.load(std::memory_order_relaxed);
+        return level >= enabled_level && enabled_level != LogLevel::off;
+    }
+
+    // FNV-1a hash of the format string and source location
+    constexpr u64 get_binary_log_site_id(std::string_view format, std::string_view file_name, u32 line_number) {
+        u64 hash = hash_bytes(fnv1a_offset_basis, format);
+        hash = hash_bytes(hash, file_name);
+        return hash_combine(hash, line_number);
+    }
+
+    template<typename T>
+    constexpr BinaryLogArgType get_binary_log_arg_type() {
+        typedef std::remove_cvref_t<T> Type;
+        if constexpr (std::is_same_v<Type, bool>) {
+            return BinaryLogArgType::Bool;
+        } else if constexpr (std::is_same_v<Type, char>) {
+            return BinaryLogArgType::Char;
+        } else if constexpr (std::is_enum_v<Type>) {
+            return get_binary_log_arg_type<std::underlying_type_t<Type>>();
+        } else if constexpr (std::is_integral_v<Type> && std::is_signed_v<Type>) {
+            return BinaryLogArgType::I64;
+        } else if constexpr (std::is_integral_v<Type>) {
+            return BinaryLogArgType::U64;
+        } else if constexpr (std::is_floating_point_v<Type>) {
+            return BinaryLogArgType::F64;
+        } else if constexpr (std::is_convertible_v<const Type&, std::string_view>) {
+            return BinaryLogArgType::String;
+        } else if constexpr (std::is_pointer_v<Type>) {
+            return BinaryLogArgType::Pointer;
+        } else {
+            static_assert(sizeof(Type) == 0, "Unsupported binary log argument type");
+        }
+    }
+
+    bool register_binary_log_site(u64 site_id, LogLevel level, std::string_view format, std::string_view file_name, std::string_view function_name, u32 line_number, std::span<const BinaryLogArgType> arg_types);
+
+    template<typename... Args>
+    bool register_binary_log_site(u64 site_id, LogLevel level, std::string_view format, std::string_view file_name, std::string_view function_name, u32 line_number, const Args&...) {
+        static_assert(sizeof...(Args) <= max_binary_log_arg_count, "Too many binary log arguments");
+        static constexpr BinaryLogArgType arg_types[sizeof...(Args) + 1] = {get_binary_log_arg_type<Args>()..., BinaryLogArgType::I64};
+        return register_binary_log_site(site_id, level, format, file_name, function_name, line_number, std::span<const BinaryLogArgType>(arg_types, sizeof...(Args)));
+    }
+
+    // Reserves space for a record in the buffer of the calling thread. Returns nullptr if the buffer is full or the
+    // log was shut down, otherwise end_binary_log_record must be called once the arguments are written.
+    u8* begin_binary_log_record(u64 site_id, u32 size);
+
+    void end_binary_log_record();
+
+    template<typename T>
+    u32 get_binary_log_arg_size(const T& arg) {
+        if constexpr (get_binary_log_arg_type<T>() == BinaryLogArgType::String) {
+            return sizeof(u32) + (u32) std::min<size_t>(std::string_view(arg).size(), max_binary_log_string_size);
+        } else {
+            return sizeof(u64);
+        }
+    }
+
+    template<typename T>
+    u8* write_binary_log_arg(u8* destination, const T& arg) {
+        constexpr BinaryLogArgType arg_type = get_binary_log_arg_type<T>();
+        if constexpr (arg_type == BinaryLogArgType::String) {
+            std::string_view string(arg);
+            u32 size = (u32) std::min<size_t>(string.size(), max_binary_log_string_size);
+            std::memcpy(destination, &size, sizeof(u32));
+            std::memcpy(destination + sizeof(u32), string.data(), size);
+            return destination + sizeof(u32) + size;
+        } else {
+            u64 bits = 0;
+            if constexpr (arg_type == BinaryLogArgType::F64) {
+                f64 value = (f64) arg;
+                std::memcpy(&bits, &value, sizeof(f64));
+            } else if constexpr (arg_type == BinaryLogArgType::Pointer) {
+                bits = (u64) (uintptr_t) arg;
+            } else {
+                bits = (u64) arg;
+            }
+            std::memcpy(destination, &bits, sizeof(u64));
+            return destination + sizeof(u64);
+        }
+    }
+
+    template<typename... Args>
+    void write_binary_log(u64 site_id, const Args&... args) {
+        u32 size = (u32) sizeof(BinaryLogRecordHeader) + (0 + ... + get_binary_log_arg_size(args));
+        u8* destination = begin_binary_log_record(site_id, size);
+        if (destination == nullptr) {
+            return;
+        }
+        ((destination = write_binary_log_arg(destination, args)), ...);
+        end_binary_log_record();
+    }
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include "system/numbers.h"
+
+// File format of the binary log, shared by the game and the decoder tool.
+//
+// A binary log file starts with a BinaryLogFileHeader, followed by blocks. Every block starts with a
+// BinaryLogBlockHeader. Site blocks describe a log call site (format string, source location and argument types),
+// and are always written before the first record of that site. Record blocks hold the raw records of one thread,
+// each record starts with a BinaryLogRecordHeader followed by the encoded arguments.
+//
+// Arguments are encoded in the order of the call, numbers as 8 bytes, strings as a u32 size followed by the
+// characters. Records are padded to 8 bytes.
+
+namespace Game {
+    constexpr char binary_log_magic[8] = {'G', 'M', 'B', 'L', 'O', 'G', '0', '1'};
+    constexpr u32 binary_log_version = 1;
+    constexpr u32 binary_log_record_alignment = 8;
+    constexpr u32 max_binary_log_arg_count = 16;
+    constexpr u32 max_binary_log_string_size = 256;
+
+    enum class BinaryLogBlockType : u32 {
+        Site = 1,
+        Records = 2,
+    };
+
+    enum class BinaryLogArgType : u8 {
+        I64 = 0,
+        U64,
+        F64,
+        Bool,
+        Char,
+        String,
+        Pointer,
+    };
+
+    struct BinaryLogFileHeader {
+        char magic[8];
+        u32 version = binary_log_version;
+        u32 reserved = 0;
+        i64 start_time_ns = 0; // Nanoseconds since the system clock epoch
+    };
+
+    struct BinaryLogBlockHeader {
+        BinaryLogBlockType type = BinaryLogBlockType::Site;
+        u32 thread_index = 0;
+        u64 size = 0; // Size of the block, excluding this header
+    };
+
+    // Followed by the argument types, then the format string, file name and function name (not null-terminated).
+    struct BinaryLogSiteHeader {
+        u64 site_id = 0;
+        u32 line_number = 0;
+        u8 level = 0;
+        u8 arg_count = 0;
+        u16 format_size = 0;
+        u16 file_name_size = 0;
+        u16 function_name_size = 0;
+        u32 reserved = 0;
+    };
+
+    // Padding records fill the end of a thread buffer when the next record doesn't fit, and are skipped by the decoder.
+    constexpr u32 binary_log_padding_flag = 1;
+
+    struct BinaryLogRecordHeader {
+        u32 size = 0; // Size of the record, including this header
+        u32 flags = 0;
+        u64 site_id = 0;
+        i64 time_ns = 0; // Nanoseconds since the system clock epoch
+    };
+
+    static_assert(sizeof(BinaryLogFileHeader) == 24);
+    static_assert(sizeof(BinaryLogBlockHeader) == 16);
+    static_assert(sizeof(BinaryLogSiteHeader) == 24);
+    static_assert(sizeof(BinaryLogRecordHeader) == 24);
+}
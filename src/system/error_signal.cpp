@@ -1,7 +1,17 @@
 #include "error_signal.h"
+#include "flight_recorder.h"
+
+#include <cerrno>
+#include <cstring>
 
 namespace Game {
     void initialize_error_signal_handlers() {
+#if defined(GM_PRINT_UNIX_STACKTRACE)
+        // The first call to backtrace() loads the unwinder, which allocates. Do it now instead of in the handler.
+        void* stack[1];
+        backtrace(stack, 1);
+#endif
+
         signal(SIGHUP, handle_error_signal);  // Hangup
         signal(SIGILL, handle_error_signal);  // Illegal instruction
         signal(SIGABRT, handle_error_signal); // Abort
@@ -18,26 +28,52 @@ namespace Game {
     }
 
     void handle_error_signal(int signal) {
+        // Dump first, the flight recorder is more useful than the stacktrace if the crash left the stack unreadable
+        dump_flight_recorder("signal", signal);
         print_stacktrace(signal);
-        exit(signal);
+
+        // Skip the exit handlers and static destructors, they are not safe to run from a signal handler and
+        // would raise a second signal if the crash left the program in a bad state
+        std::_Exit(signal);
+    }
+
+    // Async-signal-safe, unlike stdio, which may hold a lock or allocate when the signal arrives
+    void write_error_text(const char* text) {
+#if defined(GM_PRINT_UNIX_STACKTRACE)
+        size_t size = std::strlen(text);
+        while (size > 0) {
+            ssize_t written = write(STDERR_FILENO, text, size);
+            if (written > 0) {
+                text += written;
+                size -= (size_t) written;
+            } else if (written < 0 && errno == EINTR) {
+                continue;
+            } else {
+                return;
+            }
+        }
+#else
+        fputs(text, stderr);
+#endif
     }
 
     void print_stacktrace(int signal) {
-        std::string name = get_signal_name(signal);
-        std::string description = get_signal_description(signal);
-        fprintf(stderr, "--------------------------------------------------------------------------------------------------------------\n");
-        fprintf(stderr, "[%s] %s\n", name.c_str(), description.c_str());
-        fprintf(stderr, "--------------------------------------------------------------------------------------------------------------\n");
+        write_error_text("--------------------------------------------------------------------------------------------------------------\n");
+        write_error_text("[");
+        write_error_text(get_signal_name(signal));
+        write_error_text("] ");
+        write_error_text(get_signal_description(signal));
+        write_error_text("\n--------------------------------------------------------------------------------------------------------------\n");
 #if defined(GM_PRINT_UNIX_STACKTRACE)
         print_unix_stacktrace();
 #elif defined(GM_PRINT_WINDOWS_STACKTRACE)
-        fprintf(stderr, "Could not print stacktrace for Windows, not implemented\n");
+        write_error_text("Could not print stacktrace for Windows, not implemented\n");
 #else
-        fprintf(stderr, "Could not print stacktrace, unsupported platform\n");
+        write_error_text("Could not print stacktrace, unsupported platform\n");
 #endif
     }
 
-    std::string get_signal_name(const int signal) {
+    const char* get_signal_name(const int signal) {
         switch (signal) {
             case SIGHUP:
                 return "SIGHUP";
@@ -76,7 +112,7 @@ namespace Game {
         }
     }
 
-    std::string get_signal_description(int signal) {
+    const char* get_signal_description(int signal) {
         switch (signal) {
             case SIGHUP:
                 return "Hangup. Typically sent to a process when its controlling terminal is closed. Often used to reload configurations.";
@@ -130,96 +166,11 @@ namespace Game {
         void* stack[maxStackSize];
         int stackSize = backtrace(stack, maxStackSize);
 
-        // Given the set of addresses returned by backtrace() in buffer,
-        // backtrace_symbols() translates the addresses into an array of strings that describe the addresses symbolically
-        char** stacktrace = backtrace_symbols(stack, stackSize);
-        if (stacktrace == nullptr) {
-            fprintf(stderr, "Could not resolve stacktrace\n");
-            return;
-        }
-
-        // Iterate over the backtrace and...
-        // 1. Convert the line to a std::string
-        // 2. Demangle the line
-        // 3. Print the line
-        //
-        // At this point, the top of the stack will look something like this
-        // 0 [...] printUnixStacktrace()
-        // 1 [...] printStacktrace(int)
-        // 2 [...] handleErrorSignal(int)
-        // 3 [...] _sigtramp
-        // 4 [...] functionThatCausedTheSignal()
-        //
-        // The "_sigtramp" line means that the application has received a Unix signal. We are only interested in what
-        // happened _before_ the signal occurred, so we want to ignore that line and any lines above it on the stack.
-        //
-        bool sigtrampLineFound = false;
-        for (int i = 0; i < stackSize; i++) {
-            ::std::string stacktraceLine(stacktrace[i]);
-            demangle_unix_stacktrace_line(&stacktraceLine);
-            if (sigtrampLineFound) {
-                fprintf(stderr, "%s\n", stacktraceLine.c_str());
-            } else if (stacktraceLine.find("_sigtramp") != ::std::string::npos) {
-                sigtrampLineFound = true;
-            }
-        }
-
-        // This array is malloced by backtrace_symbols(), and must be freed by the caller
-        free(stacktrace);
-    }
-
-    // "Mangling" is a technique used by compilers to encode additional information into symbol names in compiled code.
-    // This additional information includes things like function names, namespaces, argument types, and template parameters.
-    // We want to "demangle" (i.e. decode) this information to make it human-readable.
-    //
-    // Mangled stacktrace line:
-    //   10  blink  0x0000000102cbfe5c  _ZN5Blink3App10initializeEv + 1960
-    //
-    // Demangled stacktrace line:
-    //   10  blink  0x00000001028b3e50  Blink::App::initialize() + 1960
-    //
-    // Segments:
-    //   [stack index]  [binary name]  [return address (in hexadecimal)]  [function name] + [offset into the function (in hexadecimal)]
-    void demangle_unix_stacktrace_line(::std::string* stacktraceLine) {
-
-        // Find segment before the mangled function name
-        size_t returnAddressStartIndex = stacktraceLine->find("0x");
-        size_t returnAddressEndIndex = returnAddressStartIndex + 18; // 18 = return address length
-
-        // Find function name start and end
-        size_t functionNameStartIndex = returnAddressEndIndex + 1; // 1 = space
-        size_t functionNameEndIndex = stacktraceLine->find(" + ");
-        size_t functionNameLength = functionNameEndIndex - functionNameStartIndex;
-
-        // Extract the mangled function name
-        ::std::string functionName = stacktraceLine->substr(functionNameStartIndex, functionNameLength);
-
-        // Demangling status:
-        // [0] The demangling operation succeeded
-        // [-1] A memory allocation failiure occurred
-        // [-2] mangled_name is not a valid name under the C++ ABI mangling rules
-        // [-3] One of the arguments is invalid
-        int demanglingStatus = -1;
-
-        // A region of memory, allocated with malloc, of *length bytes, into which the demangled name is stored.
-        // May be NULL; in that case, the demangled name is placed in a region of memory allocated with malloc.
-        char* outputBuffer = nullptr;
-
-        // If length is non-NULL, the length of the buffer containing the demangled name is placed in *length.
-        size_t* length = nullptr;
-
-        // https://gcc.gnu.org/onlinedocs/libstdc++/libstdc++-html-USERS-4.3/a01696.html
-        char* demangledFunctionName = abi::__cxa_demangle(functionName.c_str(), outputBuffer, length, &demanglingStatus);
-
-        // Replace the mangled function name with the demangled one in the stacktrace line
-        bool successfullyDemangled = demanglingStatus == 0 && demangledFunctionName != nullptr;
-        if (successfullyDemangled) {
-            stacktraceLine->replace(functionNameStartIndex, functionNameLength, demangledFunctionName);
-        }
-
-        // If the output buffer is NULL, the demangled name is placed in a region of memory allocated with malloc.
-        // The caller is responsible for deallocating this memory using free.
-        free(demangledFunctionName);
+        // backtrace_symbols_fd() writes the symbols straight to the file descriptor, where backtrace_symbols() would
+        // malloc them, which isn't safe in a signal handler. The names are left mangled for the same reason, pipe the
+        // output through c++filt to read them. The top lines are the signal handler and the trampoline that called it,
+        // the lines below them are where the signal was raised.
+        backtrace_symbols_fd(stack, stackSize, STDERR_FILENO);
     }
 #endif
 }
@@ -1,29 +1,167 @@
 #include "file.h"
 
+#include <cerrno>
+#include <cstring>
 #include <fstream>
 
+#if defined(GM_PLATFORM_MACOS) || defined(GM_PLATFORM_LINUX)
+    #define GM_MAP_FILES
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <unistd.h>
+#endif
+
+#if defined(GM_PLATFORM_MACOS)
+    #include <mach-o/dyld.h>
+#elif defined(GM_PLATFORM_WINDOWS)
+    #include <windows.h>
+#endif
+
 namespace Game {
-    std::vector<char> read_bytes(const std::filesystem::path& path) {
-        if (!std::filesystem::exists(path)) {
-            GM_THROW("Could not find file [" << path << "]");
+    MappedFile::~MappedFile() {
+        unmap();
+    }
+
+    MappedFile::MappedFile(MappedFile&& other) noexcept
+        : bytes(std::exchange(other.bytes, nullptr)),
+          size(std::exchange(other.size, 0)),
+          mapped(std::exchange(other.mapped, false)),
+          buffer(std::move(other.buffer)) {
+    }
+
+    MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+        if (this != &other) {
+            unmap();
+            bytes = std::exchange(other.bytes, nullptr);
+            size = std::exchange(other.size, 0);
+            mapped = std::exchange(other.mapped, false);
+            buffer = std::move(other.buffer);
+        }
+        return *this;
+    }
+
+    const u8* MappedFile::data() const {
+        return bytes;
+    }
+
+    u64 MappedFile::get_size() const {
+        return size;
+    }
+
+    std::span<const u8> MappedFile::get_bytes() const {
+        return {bytes, (size_t) size};
+    }
+
+    bool MappedFile::is_mapped() const {
+        return mapped;
+    }
+
+    void MappedFile::unmap() {
+#ifdef GM_MAP_FILES
+        if (mapped) {
+            munmap((void*) bytes, (size_t) size);
         }
+#endif
+        bytes = nullptr;
+        size = 0;
+        mapped = false;
+        buffer.clear();
+    }
 
-        // ate: Start reading at the end of the file
-        // binary: Read the file as binary file (avoid text transformations)
-        std::ifstream file{path.c_str(), std::ios::ate | std::ios::binary};
+    // Reads the whole file in chunks, a single read of several gigabytes is not reliably supported by every stream implementation
+    void read_file(const std::filesystem::path& path, u64 file_size, u8* destination) {
+        std::ifstream file{path, std::ios::binary};
         if (!file.is_open()) {
             GM_THROW("Could not open file with path [" << path << "]");
         }
+        constexpr u64 chunk_size = 256 * 1024 * 1024;
+        for (u64 offset = 0; offset < file_size; offset += chunk_size) {
+            u64 read_size = std::min(chunk_size, file_size - offset);
+            if (!file.read((char*) destination + offset, (std::streamsize) read_size)) {
+                GM_THROW("Could not read [" << read_size << "] bytes at offset [" << offset << "] from file [" << path << "]");
+            }
+        }
+    }
+
+    MappedFile map_file(const std::filesystem::path& path, FileAccess access) {
+        std::error_code error;
+        u64 file_size = std::filesystem::file_size(path, error);
+        if (error) {
+            GM_THROW("Could not find file [" << path << "]: " << error.message());
+        }
+        if (file_size > std::numeric_limits<size_t>::max()) {
+            GM_THROW("File [" << path << "] of [" << file_size << "] bytes is too large for the address space");
+        }
+
+        MappedFile mapped_file{};
+        if (file_size == 0) {
+            return mapped_file;
+        }
+
+#ifdef GM_MAP_FILES
+        i32 file_descriptor = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (file_descriptor >= 0) {
+            void* address = mmap(nullptr, (size_t) file_size, PROT_READ, MAP_PRIVATE, file_descriptor, 0);
 
-        // Starting to read at the end of the file means we can use the read position to determine the size of the file.
-        auto file_size = (u32) file.tellg();
-        std::vector<char> buffer(file_size);
+            // The mapping keeps its own reference to the file
+            close(file_descriptor);
 
-        // Seek back to the beginning of the file and read all bytes.
-        file.seekg(0);
-        file.read(buffer.data(), file_size);
+            if (address != MAP_FAILED) {
+                if (access == FileAccess::Sequential) {
+                    madvise(address, (size_t) file_size, MADV_SEQUENTIAL);
+                    madvise(address, (size_t) file_size, MADV_WILLNEED);
+                } else {
+                    madvise(address, (size_t) file_size, MADV_RANDOM);
+                }
+                mapped_file.bytes = (const u8*) address;
+                mapped_file.size = file_size;
+                mapped_file.mapped = true;
+                return mapped_file;
+            }
+        }
+        GM_LOG_WARNING("Could not memory-map file [{}], reading it instead: {}", path.string(), std::strerror(errno));
+#else
+        (void) access;
+#endif
+
+        mapped_file.buffer.resize((size_t) file_size);
+        read_file(path, file_size, mapped_file.buffer.data());
+        mapped_file.bytes = mapped_file.buffer.data();
+        mapped_file.size = file_size;
+        return mapped_file;
+    }
 
-        file.close();
+    std::vector<char> read_bytes(const std::filesystem::path& path) {
+        std::error_code error;
+        u64 file_size = std::filesystem::file_size(path, error);
+        if (error) {
+            GM_THROW("Could not find file [" << path << "]: " << error.message());
+        }
+        std::vector<char> buffer((size_t) file_size);
+        read_file(path, file_size, (u8*) buffer.data());
         return buffer;
     }
+
+    std::filesystem::path get_executable_directory() {
+        std::error_code error;
+#if defined(GM_PLATFORM_LINUX)
+        std::filesystem::path executable_path = std::filesystem::read_symlink("/proc/self/exe", error);
+#elif defined(GM_PLATFORM_MACOS)
+        char buffer[4096];
+        u32 buffer_size = sizeof(buffer);
+        std::filesystem::path executable_path;
+        if (_NSGetExecutablePath(buffer, &buffer_size) == 0) {
+            executable_path = std::filesystem::weakly_canonical(buffer, error);
+        }
+#elif defined(GM_PLATFORM_WINDOWS)
+        wchar_t buffer[MAX_PATH];
+        DWORD length = GetModuleFileNameW(nullptr, buffer, MAX_PATH);
+        std::filesystem::path executable_path = length > 0 && length < MAX_PATH ? std::filesystem::path(buffer) : std::filesystem::path();
+#endif
+        if (error || executable_path.empty()) {
+            GM_LOG_WARNING("Could not find the directory of the executable, using the working directory instead");
+            return std::filesystem::current_path();
+        }
+        return executable_path.parent_path();
+    }
 }
@@ -1,5 +1,56 @@
 #pragma once
 
+#include <span>
+
 namespace Game {
+    // How the contents of a mapped file are going to be read, passed on to the OS as a paging hint
+    enum class FileAccess {
+        Sequential, // Read once from start to end, pages are read ahead aggressively
+        Random,     // Read in no particular order, pages are only read when touched
+    };
+
+    // Read-only view of the contents of a file. The file is memory-mapped when the platform supports it, so that
+    // the contents are paged in on demand and consumed without copying. Otherwise, or if mapping fails, the contents
+    // are read into a buffer owned by the view. The contents stay valid for as long as the view is alive.
+    class MappedFile {
+    private:
+        const u8* bytes = nullptr;
+        u64 size = 0;
+        bool mapped = false;
+        std::vector<u8> buffer; // Contents when the file could not be mapped
+
+    public:
+        MappedFile() = default;
+
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+
+        MappedFile& operator=(const MappedFile&) = delete;
+
+        MappedFile(MappedFile&& other) noexcept;
+
+        MappedFile& operator=(MappedFile&& other) noexcept;
+
+        const u8* data() const;
+
+        u64 get_size() const;
+
+        std::span<const u8> get_bytes() const;
+
+        bool is_mapped() const;
+
+        friend MappedFile map_file(const std::filesystem::path& path, FileAccess access);
+
+    private:
+        void unmap();
+    };
+
+    MappedFile map_file(const std::filesystem::path& path, FileAccess access = FileAccess::Sequential);
+
     std::vector<char> read_bytes(const std::filesystem::path& path);
-}
\ No newline at end of file
+
+    // Directory of the running executable, for files that belong next to it regardless of the working directory.
+    // Falls back to the working directory if the platform can't tell.
+    std::filesystem::path get_executable_directory();
+}
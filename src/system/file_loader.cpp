@@ -0,0 +1,464 @@
+#include "file_loader.h"
+
+#include <fstream>
+
+#ifdef GM_IO_URING
+    #include <fcntl.h>
+    #include <sys/eventfd.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+#endif
+
+namespace Game {
+    // Largest single read, the read length of io_uring is 32-bit
+    constexpr u64 max_file_read_size = 1024 * 1024 * 1024;
+
+    void add_read_loads(FileLoader& loader, const std::vector<FileLoad*>& loads) {
+        if (loads.empty()) {
+            return;
+        }
+        std::lock_guard lock(loader.mutex);
+        loader.read_loads.insert(loader.read_loads.end(), loads.begin(), loads.end());
+    }
+
+    //
+    // Thread pool backend
+    //
+
+    void read_file_load(FileLoad& load) {
+        std::error_code error;
+        u64 file_size = std::filesystem::file_size(load.path, error);
+        if (error) {
+            load.error = std::format("Could not find file: {}", error.message());
+            return;
+        }
+        load.size = file_size;
+
+        std::ifstream file{load.path, std::ios::binary};
+        if (!file.is_open()) {
+            load.error = "Could not open file";
+            return;
+        }
+        load.bytes.resize(load.size);
+        while (load.read_size < load.size) {
+            u64 read_size = std::min(max_file_read_size, load.size - load.read_size);
+            if (!file.read((char*) load.bytes.data() + load.read_size, (std::streamsize) read_size)) {
+                load.error = std::format("Could not read [{}] bytes at offset [{}]", read_size, load.read_size);
+                return;
+            }
+            load.read_size += read_size;
+        }
+    }
+
+    void run_file_loader_thread(FileLoader& loader) {
+        while (true) {
+            FileLoad* load = nullptr;
+            {
+                std::unique_lock lock(loader.mutex);
+                loader.condition.wait(lock, [&loader] {
+                    return !loader.running || !loader.pending_loads.empty();
+                });
+                if (!loader.running) {
+                    return;
+                }
+                load = loader.pending_loads.front();
+                loader.pending_loads.pop_front();
+            }
+            read_file_load(*load);
+            add_read_loads(loader, {load});
+        }
+    }
+
+    //
+    // io_uring backend. The rings are set up with raw system calls, liburing is not needed for the handful of
+    // operations used here. One thread keeps up to `queue_depth` reads in flight and sleeps in the kernel until one
+    // of them completes, or until new loads arrive, which is signaled through a read of an eventfd that is always
+    // in flight.
+    //
+
+#ifdef GM_IO_URING
+    constexpr u64 io_uring_wake_user_data = 0;
+
+    bool create_io_uring(IoUring& ring, u32 entry_count) {
+        io_uring_params params{};
+        i32 file_descriptor = (i32) syscall(__NR_io_uring_setup, entry_count, &params);
+        if (file_descriptor < 0) {
+            return false;
+        }
+        ring.file_descriptor = file_descriptor;
+
+        // Fast poll was added shortly after plain reads (5.7 and 5.6), so it tells that the kernel supports IORING_OP_READ
+        if ((params.features & IORING_FEAT_FAST_POLL) == 0) {
+            close(file_descriptor);
+            ring.file_descriptor = -1;
+            return false;
+        }
+
+        ring.entry_count = params.sq_entries;
+        ring.submission_ring_size = params.sq_off.array + params.sq_entries * sizeof(u32);
+        ring.completion_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+        ring.submission_entries_size = params.sq_entries * sizeof(io_uring_sqe);
+
+        bool single_mapping = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (single_mapping) {
+            ring.submission_ring_size = std::max(ring.submission_ring_size, ring.completion_ring_size);
+            ring.completion_ring_size = ring.submission_ring_size;
+        }
+        ring.submission_ring = mmap(nullptr, ring.submission_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, file_descriptor, IORING_OFF_SQ_RING);
+        ring.completion_ring = single_mapping
+            ? ring.submission_ring
+            : mmap(nullptr, ring.completion_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, file_descriptor, IORING_OFF_CQ_RING);
+        void* submission_entries = mmap(nullptr, ring.submission_entries_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, file_descriptor, IORING_OFF_SQES);
+        if (ring.submission_ring == MAP_FAILED || ring.completion_ring == MAP_FAILED || submission_entries == MAP_FAILED) {
+            GM_THROW("Could not map io_uring rings: " << std::strerror(errno));
+        }
+
+        u8* submission_ring = (u8*) ring.submission_ring;
+        ring.submission_head = (u32*) (submission_ring + params.sq_off.head);
+        ring.submission_tail = (u32*) (submission_ring + params.sq_off.tail);
+        ring.submission_mask = (u32*) (submission_ring + params.sq_off.ring_mask);
+        ring.submission_array = (u32*) (submission_ring + params.sq_off.array);
+        ring.submission_entries = (io_uring_sqe*) submission_entries;
+
+        u8* completion_ring = (u8*) ring.completion_ring;
+        ring.completion_head = (u32*) (completion_ring + params.cq_off.head);
+        ring.completion_tail = (u32*) (completion_ring + params.cq_off.tail);
+        ring.completion_mask = (u32*) (completion_ring + params.cq_off.ring_mask);
+        ring.completion_entries = (io_uring_cqe*) (completion_ring + params.cq_off.cqes);
+        return true;
+    }
+
+    void destroy_io_uring(IoUring& ring) {
+        if (ring.file_descriptor < 0) {
+            return;
+        }
+        munmap(ring.submission_entries, ring.submission_entries_size);
+        if (ring.completion_ring != ring.submission_ring) {
+            munmap(ring.completion_ring, ring.completion_ring_size);
+        }
+        munmap(ring.submission_ring, ring.submission_ring_size);
+        close(ring.file_descriptor);
+        ring = {};
+    }
+
+    void submit_io_uring_read(IoUring& ring, i32 file_descriptor, void* destination, u32 size, u64 offset, u64 user_data) {
+        u32 tail = *ring.submission_tail;
+        u32 head = std::atomic_ref(*ring.submission_head).load(std::memory_order_acquire);
+        if (tail - head >= ring.entry_count) {
+            GM_THROW("io_uring submission queue is full");
+        }
+        u32 index = tail & *ring.submission_mask;
+
+        io_uring_sqe& entry = ring.submission_entries[index];
+        std::memset(&entry, 0, sizeof(io_uring_sqe));
+        entry.opcode = IORING_OP_READ;
+        entry.fd = file_descriptor;
+        entry.addr = (u64) (uintptr_t) destination;
+        entry.len = size;
+        entry.off = offset;
+        entry.user_data = user_data;
+
+        ring.submission_array[index] = index;
+        std::atomic_ref(*ring.submission_tail).store(tail + 1, std::memory_order_release);
+        ring.pending_submission_count++;
+    }
+
+    // Submits the queued reads and blocks until at least one read has completed
+    void submit_and_wait_io_uring(IoUring& ring) {
+        i32 result = (i32) syscall(__NR_io_uring_enter, ring.file_descriptor, ring.pending_submission_count, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+        if (result >= 0) {
+            ring.pending_submission_count -= (u32) result;
+        } else if (errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+            GM_THROW("Could not submit io_uring reads: " << std::strerror(errno));
+        }
+    }
+
+    void submit_file_load_read(FileLoader& loader, FileLoad& load) {
+        u32 read_size = (u32) std::min(max_file_read_size, load.size - load.read_size);
+        submit_io_uring_read(loader.io_uring, load.file_descriptor, load.bytes.data() + load.read_size, read_size, load.read_size, (u64) (uintptr_t) &load);
+    }
+
+    void arm_file_loader_wake_event(FileLoader& loader) {
+        submit_io_uring_read(loader.io_uring, loader.wake_event_descriptor, &loader.wake_event_value, sizeof(u64), 0, io_uring_wake_user_data);
+    }
+
+    void wake_file_loader(FileLoader& loader) {
+        u64 value = 1;
+        ssize_t result = write(loader.wake_event_descriptor, &value, sizeof(u64));
+        (void) result;
+    }
+
+    // Returns false if the load is done, either because it failed or because there is nothing to read
+    bool open_file_load(FileLoad& load) {
+        load.file_descriptor = open(load.path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (load.file_descriptor < 0) {
+            load.error = std::format("Could not open file: {}", std::strerror(errno));
+            return false;
+        }
+        struct stat file_status{};
+        if (fstat(load.file_descriptor, &file_status) != 0) {
+            load.error = std::format("Could not get file size: {}", std::strerror(errno));
+            return false;
+        }
+        load.size = (u64) file_status.st_size;
+        load.bytes.resize(load.size);
+        return load.size > 0;
+    }
+
+    void close_file_load(FileLoad& load) {
+        if (load.file_descriptor >= 0) {
+            close(load.file_descriptor);
+            load.file_descriptor = -1;
+        }
+    }
+
+    void run_io_uring_file_loader_thread(FileLoader& loader) {
+        IoUring& ring = loader.io_uring;
+        u32 in_flight_count = 0;
+        std::vector<FileLoad*> started_loads;
+        std::vector<FileLoad*> finished_loads;
+
+        arm_file_loader_wake_event(loader);
+
+        while (true) {
+            bool running;
+            {
+                std::lock_guard lock(loader.mutex);
+                running = loader.running;
+                while (running && in_flight_count + started_loads.size() < loader.config.queue_depth && !loader.pending_loads.empty()) {
+                    started_loads.push_back(loader.pending_loads.front());
+                    loader.pending_loads.pop_front();
+                }
+            }
+
+            // Opening is synchronous, but it only touches file metadata
+            for (FileLoad* load : started_loads) {
+                if (open_file_load(*load)) {
+                    submit_file_load_read(loader, *load);
+                    in_flight_count++;
+                } else {
+                    close_file_load(*load);
+                    finished_loads.push_back(load);
+                }
+            }
+            started_loads.clear();
+            add_read_loads(loader, finished_loads);
+            finished_loads.clear();
+
+            // Pending loads are dropped on shutdown, but the reads that are in flight write into the loads and must finish
+            if (!running && in_flight_count == 0) {
+                return;
+            }
+
+            submit_and_wait_io_uring(ring);
+
+            u32 head = *ring.completion_head;
+            u32 tail = std::atomic_ref(*ring.completion_tail).load(std::memory_order_acquire);
+            for (; head != tail; ++head) {
+                const io_uring_cqe& completion = ring.completion_entries[head & *ring.completion_mask];
+                if (completion.user_data == io_uring_wake_user_data) {
+                    arm_file_loader_wake_event(loader);
+                    continue;
+                }
+
+                FileLoad& load = *(FileLoad*) (uintptr_t) completion.user_data;
+                if (completion.res == -EINTR || completion.res == -EAGAIN) {
+                    submit_file_load_read(loader, load);
+                    continue;
+                }
+                if (completion.res < 0) {
+                    load.error = std::format("Could not read file: {}", std::strerror(-completion.res));
+                } else if (completion.res == 0) {
+                    load.error = std::format("Unexpected end of file after [{}] of [{}] bytes", load.read_size, load.size);
+                } else {
+                    load.read_size += (u64) completion.res;
+                    if (load.read_size < load.size) {
+                        submit_file_load_read(loader, load);
+                        continue;
+                    }
+                }
+                close_file_load(load);
+                finished_loads.push_back(&load);
+                in_flight_count--;
+            }
+            std::atomic_ref(*ring.completion_head).store(head, std::memory_order_release);
+
+            add_read_loads(loader, finished_loads);
+            finished_loads.clear();
+        }
+    }
+#endif
+
+    //
+    // Loader
+    //
+
+    void create_file_loader(FileLoader& loader, JobSystem& job_system, const FileLoaderConfig& config) {
+        loader.config = config;
+        loader.job_system = &job_system;
+        loader.running = true;
+
+#ifdef GM_IO_URING
+        if (config.io_uring_enabled) {
+            // One extra entry for the wake event
+            if (create_io_uring(loader.io_uring, config.queue_depth + 1)) {
+                loader.wake_event_descriptor = eventfd(0, EFD_CLOEXEC);
+                if (loader.wake_event_descriptor < 0) {
+                    GM_THROW("Could not create file loader wake event: " << std::strerror(errno));
+                }
+                loader.io_uring_used = true;
+                loader.threads.emplace_back(run_io_uring_file_loader_thread, std::ref(loader));
+                GM_LOG_DEBUG("Created file loader with io_uring, queue depth [{}]", config.queue_depth);
+                return;
+            }
+            GM_LOG_WARNING("Could not set up io_uring, falling back to file loader threads");
+        }
+#endif
+
+        u32 thread_count = std::max(config.fallback_thread_count, 1u);
+        for (u32 i = 0; i < thread_count; ++i) {
+            loader.threads.emplace_back(run_file_loader_thread, std::ref(loader));
+        }
+        GM_LOG_DEBUG("Created file loader with [{}] threads", thread_count);
+    }
+
+    void destroy_file_loader(FileLoader& loader) {
+        if (loader.job_system == nullptr) {
+            return;
+        }
+        {
+            std::lock_guard lock(loader.mutex);
+            loader.running = false;
+        }
+        loader.condition.notify_all();
+#ifdef GM_IO_URING
+        if (loader.io_uring_used) {
+            wake_file_loader(loader);
+        }
+#endif
+        for (std::thread& thread : loader.threads) {
+            thread.join();
+        }
+        loader.threads.clear();
+
+        // The processing jobs write into the loads
+        wait_for_counter(*loader.job_system, loader.processing_counter);
+
+        for (FileLoad* load : loader.pending_loads) {
+            delete load;
+        }
+        for (FileLoad* load : loader.read_loads) {
+            delete load;
+        }
+        for (FileLoad* load : loader.ready_loads) {
+            delete load;
+        }
+        loader.pending_loads.clear();
+        loader.read_loads.clear();
+        loader.ready_loads.clear();
+        loader.load_count.store(0, std::memory_order_relaxed);
+
+#ifdef GM_IO_URING
+        destroy_io_uring(loader.io_uring);
+        if (loader.wake_event_descriptor >= 0) {
+            close(loader.wake_event_descriptor);
+            loader.wake_event_descriptor = -1;
+        }
+        loader.io_uring_used = false;
+#endif
+    }
+
+    void queue_file_load(FileLoader& loader, FileLoad* load) {
+        loader.load_count.fetch_add(1, std::memory_order_relaxed);
+        {
+            std::lock_guard lock(loader.mutex);
+            loader.pending_loads.push_back(load);
+        }
+#ifdef GM_IO_URING
+        if (loader.io_uring_used) {
+            wake_file_loader(loader);
+            return;
+        }
+#endif
+        loader.condition.notify_one();
+    }
+
+    void load_file(FileLoader& loader, const std::filesystem::path& path, FileLoadCallback on_ready, FileLoadCallback on_process) {
+        queue_file_load(loader, new FileLoad{
+            .path = path,
+            .on_process = std::move(on_process),
+            .on_ready = std::move(on_ready),
+        });
+    }
+
+    void process_file_load(FileLoader& loader, FileLoad& load) {
+        // Exceptions can't leave a job, so they fail the load instead
+        if (load.on_process) {
+            try {
+                load.on_process(load);
+            } catch (const std::exception& e) {
+                load.error = e.what();
+            }
+        }
+
+        std::lock_guard lock(loader.mutex);
+        loader.ready_loads.push_back(&load);
+    }
+
+    void update_file_loader(FileLoader& loader) {
+        std::vector<FileLoad*> read_loads;
+        {
+            std::lock_guard lock(loader.mutex);
+            std::swap(read_loads, loader.read_loads);
+        }
+        std::vector<FileLoad*> failed_loads;
+        for (FileLoad* load : read_loads) {
+            if (!load->error.empty()) {
+                failed_loads.push_back(load);
+                continue;
+            }
+            FileLoader* loader_pointer = &loader;
+            run_job(*loader.job_system, [loader_pointer, load] {
+                process_file_load(*loader_pointer, *load);
+            }, &loader.processing_counter);
+        }
+
+        std::vector<FileLoad*> ready_loads;
+        {
+            std::lock_guard lock(loader.mutex);
+            loader.ready_loads.insert(loader.ready_loads.end(), failed_loads.begin(), failed_loads.end());
+
+            u64 ready_count = loader.ready_loads.size();
+            if (loader.config.max_ready_per_update > 0) {
+                ready_count = std::min<u64>(ready_count, loader.config.max_ready_per_update);
+            }
+            ready_loads.assign(loader.ready_loads.begin(), loader.ready_loads.begin() + (i64) ready_count);
+            loader.ready_loads.erase(loader.ready_loads.begin(), loader.ready_loads.begin() + (i64) ready_count);
+        }
+        for (FileLoad* load : ready_loads) {
+            std::unique_ptr<FileLoad> owned_load{load};
+            loader.load_count.fetch_sub(1, std::memory_order_relaxed);
+            if (!load->error.empty()) {
+                GM_LOG_ERROR("Could not load [{}]: {}", load->path.string(), load->error);
+            }
+            if (load->on_ready) {
+                load->on_ready(*load);
+            }
+        }
+    }
+
+    void wait_for_file_loads(FileLoader& loader) {
+        while (get_file_load_count(loader) > 0) {
+            update_file_loader(loader);
+            // Runs the processing jobs here too, in case there are no other workers to pick them up
+            wait_for_counter(*loader.job_system, loader.processing_counter);
+            std::this_thread::yield();
+        }
+    }
+
+    u32 get_file_load_count(const FileLoader& loader) {
+        return loader.load_count.load(std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,122 @@
+#pragma once
+
+#include "system/job_system.h"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+// Asynchronous file loading in three stages, so that loading never blocks the game loop:
+//
+//   1. Read: the file is read on the loader's own I/O thread(s). On Linux the reads are batched through io_uring,
+//      elsewhere, or when io_uring is unavailable, a small pool of threads does blocking reads.
+//   2. Process: `on_process` is called on the job system workers, for work like parsing that turns the file into
+//      GPU-ready data.
+//   3. Ready: `on_ready` is called on the main thread from `update_file_loader`, at a frame boundary, where the data
+//      can be uploaded or handed to the renderer. A budget per update keeps a burst of loads from causing a hitch.
+//
+// Failed loads skip processing and go straight to `on_ready` with the error set.
+
+#if defined(GM_PLATFORM_LINUX) && __has_include(<linux/io_uring.h>)
+    #define GM_IO_URING
+    #include <linux/io_uring.h>
+#endif
+
+namespace Game {
+    struct FileLoad;
+
+    typedef std::function<void(FileLoad& load)> FileLoadCallback;
+
+    struct FileLoad {
+        std::filesystem::path path;
+
+        std::vector<u8> bytes;    // Contents of the whole file
+        std::string error;        // Empty if the load succeeded
+
+        FileLoadCallback on_process; // Called on a job system worker, optional
+        FileLoadCallback on_ready;   // Called on the main thread
+
+        // I/O state
+        i32 file_descriptor = -1;
+        u64 size = 0;
+        u64 read_size = 0;
+    };
+
+    struct FileLoaderConfig {
+        // Maximum number of reads in flight at the same time
+        u32 queue_depth = 64;
+
+        bool io_uring_enabled = true;
+
+        // Threads doing blocking reads, when io_uring is not used
+        u32 fallback_thread_count = 2;
+
+        // Loads handed to `on_ready` per update, 0 for no limit
+        u32 max_ready_per_update = 16;
+    };
+
+#ifdef GM_IO_URING
+    // Submission and completion rings shared with the kernel
+    struct IoUring {
+        i32 file_descriptor = -1;
+        u32 entry_count = 0;
+        u32* submission_head = nullptr;
+        u32* submission_tail = nullptr;
+        u32* submission_mask = nullptr;
+        u32* submission_array = nullptr;
+        io_uring_sqe* submission_entries = nullptr;
+        u32* completion_head = nullptr;
+        u32* completion_tail = nullptr;
+        u32* completion_mask = nullptr;
+        io_uring_cqe* completion_entries = nullptr;
+        void* submission_ring = nullptr;
+        u64 submission_ring_size = 0;
+        void* completion_ring = nullptr;
+        u64 completion_ring_size = 0;
+        u64 submission_entries_size = 0;
+        u32 pending_submission_count = 0;
+    };
+#endif
+
+    struct FileLoader {
+        FileLoaderConfig config{};
+        JobSystem* job_system = nullptr;
+
+        // Guards the queues and the running flag
+        std::mutex mutex;
+        std::condition_variable condition;
+        std::deque<FileLoad*> pending_loads;  // Waiting to be read
+        std::vector<FileLoad*> read_loads;    // Read, waiting to be processed
+        std::vector<FileLoad*> ready_loads;   // Processed, waiting for the main thread
+        bool running = false;
+
+        std::vector<std::thread> threads;
+        JobCounter processing_counter{};
+        std::atomic<u32> load_count = 0; // Loads that have not been handed to `on_ready` yet
+
+#ifdef GM_IO_URING
+        IoUring io_uring{};
+        i32 wake_event_descriptor = -1;
+        u64 wake_event_value = 0;
+#endif
+        bool io_uring_used = false;
+    };
+
+    void create_file_loader(FileLoader& loader, JobSystem& job_system, const FileLoaderConfig& config = {});
+
+    // Finishes the reads in flight, then drops the loads that have not been handed to `on_ready`.
+    void destroy_file_loader(FileLoader& loader);
+
+    // Can be called from any thread.
+    void load_file(FileLoader& loader, const std::filesystem::path& path, FileLoadCallback on_ready, FileLoadCallback on_process = nullptr);
+
+    // Moves loads between stages and calls `on_ready` for loads that are ready. Call once per frame from the main thread.
+    void update_file_loader(FileLoader& loader);
+
+    // Updates the loader until every load has been handed to `on_ready`. Call from the main thread, for example before
+    // destroying what the callbacks write into.
+    void wait_for_file_loads(FileLoader& loader);
+
+    // Number of loads that have not been handed to `on_ready` yet.
+    u32 get_file_load_count(const FileLoader& loader);
+}
@@ -0,0 +1,168 @@
+#include "file_watcher.h"
+
+#ifdef GM_INOTIFY
+    #include <poll.h>
+    #include <sys/eventfd.h>
+    #include <sys/inotify.h>
+    #include <unistd.h>
+#endif
+
+namespace Game {
+    void report_changed_files(FileWatcher& watcher, std::set<std::filesystem::path>& changed_paths) {
+        std::vector<std::filesystem::path> paths(changed_paths.begin(), changed_paths.end());
+        changed_paths.clear();
+        try {
+            watcher.on_change(paths);
+        } catch (const std::exception& e) {
+            GM_LOG_ERROR("Could not handle changes in [{}]: {}", watcher.config.directory.string(), e.what());
+        }
+    }
+
+#ifdef GM_INOTIFY
+    void run_file_watcher_thread(FileWatcher& watcher) {
+        std::set<std::filesystem::path> changed_paths;
+        alignas(inotify_event) char buffer[4096];
+
+        while (true) {
+            pollfd descriptors[2] = {
+                {.fd = watcher.inotify_descriptor, .events = POLLIN},
+                {.fd = watcher.wake_event_descriptor, .events = POLLIN},
+            };
+            // Sleep until something happens, or until the pending changes have settled
+            i32 timeout_ms = changed_paths.empty() ? -1 : (i32) watcher.config.debounce_ms;
+            i32 result = poll(descriptors, 2, timeout_ms);
+            if (result < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                GM_LOG_ERROR("Could not poll for changes in [{}]: {}", watcher.config.directory.string(), std::strerror(errno));
+                return;
+            }
+            if (descriptors[1].revents & POLLIN) {
+                return;
+            }
+            if (result == 0) {
+                report_changed_files(watcher, changed_paths);
+                continue;
+            }
+
+            while (true) {
+                ssize_t size = read(watcher.inotify_descriptor, buffer, sizeof(buffer));
+                if (size <= 0) {
+                    break;
+                }
+                for (char* position = buffer; position < buffer + size;) {
+                    const inotify_event* event = (const inotify_event*) position;
+                    position += sizeof(inotify_event) + event->len;
+                    if (event->mask & IN_Q_OVERFLOW) {
+                        GM_LOG_WARNING("Missed changes in [{}], too many at once", watcher.config.directory.string());
+                    }
+                    if (event->len > 0 && (event->mask & IN_ISDIR) == 0) {
+                        changed_paths.insert(watcher.config.directory / event->name);
+                    }
+                }
+            }
+        }
+    }
+#else
+    // Collects the files that have been written since the previous scan
+    void scan_directory(FileWatcher& watcher, std::set<std::filesystem::path>& changed_paths, bool& changed) {
+        std::error_code error;
+        for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(watcher.config.directory, error)) {
+            if (!entry.is_regular_file(error)) {
+                continue;
+            }
+            std::filesystem::file_time_type write_time = entry.last_write_time(error);
+            if (error) {
+                continue;
+            }
+            auto [it, inserted] = watcher.write_times.try_emplace(entry.path().string(), write_time);
+            if (inserted || it->second != write_time) {
+                it->second = write_time;
+                changed_paths.insert(entry.path());
+                changed = true;
+            }
+        }
+    }
+
+    void run_file_watcher_thread(FileWatcher& watcher) {
+        std::set<std::filesystem::path> changed_paths;
+        while (true) {
+            {
+                std::unique_lock lock(watcher.mutex);
+                watcher.condition.wait_for(lock, std::chrono::milliseconds(watcher.config.poll_interval_ms), [&watcher] {
+                    return !watcher.running;
+                });
+                if (!watcher.running) {
+                    return;
+                }
+            }
+            // Changes are reported by the first scan that finds nothing new, so that they have had time to settle
+            bool changed = false;
+            scan_directory(watcher, changed_paths, changed);
+            if (!changed && !changed_paths.empty()) {
+                report_changed_files(watcher, changed_paths);
+            }
+        }
+    }
+#endif
+
+    void create_file_watcher(FileWatcher& watcher, const FileWatcherConfig& config, FileWatchCallback on_change) {
+        if (!std::filesystem::is_directory(config.directory)) {
+            GM_THROW("Could not find directory [" << config.directory << "] to watch");
+        }
+        watcher.config = config;
+        watcher.on_change = std::move(on_change);
+        watcher.running = true;
+
+#ifdef GM_INOTIFY
+        watcher.inotify_descriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (watcher.inotify_descriptor < 0) {
+            GM_THROW("Could not initialize inotify: " << std::strerror(errno));
+        }
+        // Editors either write the file in place or write a temporary file and rename it over the old one
+        if (inotify_add_watch(watcher.inotify_descriptor, config.directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+            GM_THROW("Could not watch directory [" << config.directory << "]: " << std::strerror(errno));
+        }
+        watcher.wake_event_descriptor = eventfd(0, EFD_CLOEXEC);
+        if (watcher.wake_event_descriptor < 0) {
+            GM_THROW("Could not create file watcher wake event: " << std::strerror(errno));
+        }
+#else
+        std::set<std::filesystem::path> changed_paths;
+        bool changed = false;
+        scan_directory(watcher, changed_paths, changed);
+#endif
+
+        watcher.thread = std::thread(run_file_watcher_thread, std::ref(watcher));
+        GM_LOG_DEBUG("Watching [{}] for changes", config.directory.string());
+    }
+
+    void destroy_file_watcher(FileWatcher& watcher) {
+        {
+            std::lock_guard lock(watcher.mutex);
+            watcher.running = false;
+        }
+        watcher.condition.notify_all();
+#ifdef GM_INOTIFY
+        if (watcher.wake_event_descriptor >= 0) {
+            u64 value = 1;
+            ssize_t result = write(watcher.wake_event_descriptor, &value, sizeof(u64));
+            (void) result;
+        }
+#endif
+        if (watcher.thread.joinable()) {
+            watcher.thread.join();
+        }
+#ifdef GM_INOTIFY
+        if (watcher.inotify_descriptor >= 0) {
+            close(watcher.inotify_descriptor);
+            watcher.inotify_descriptor = -1;
+        }
+        if (watcher.wake_event_descriptor >= 0) {
+            close(watcher.wake_event_descriptor);
+            watcher.wake_event_descriptor = -1;
+        }
+#endif
+    }
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+
+// Watches a directory for files that are written, and reports them in batches on the watcher's own thread.
+// Editors tend to save in several steps (truncate, write, rename), so changes are collected until the directory
+// has been quiet for `debounce_ms` before they are reported. Only the directory itself is watched, not its subdirectories.
+
+#if defined(GM_PLATFORM_LINUX)
+    #define GM_INOTIFY
+#endif
+
+namespace Game {
+    typedef std::function<void(const std::vector<std::filesystem::path>& paths)> FileWatchCallback;
+
+    struct FileWatcherConfig {
+        std::filesystem::path directory;
+        u32 debounce_ms = 100;
+
+        // How often the directory is scanned for changes, when the platform can't notify about them
+        u32 poll_interval_ms = 250;
+    };
+
+    struct FileWatcher {
+        FileWatcherConfig config{};
+        FileWatchCallback on_change;
+        std::thread thread;
+
+        // Guards the running flag
+        std::mutex mutex;
+        std::condition_variable condition;
+        bool running = false;
+
+#ifdef GM_INOTIFY
+        i32 inotify_descriptor = -1;
+        i32 wake_event_descriptor = -1;
+#else
+        std::unordered_map<std::string, std::filesystem::file_time_type> write_times;
+#endif
+    };
+
+    // Calls `on_change` on the watcher thread with the paths of the files that have been written.
+    void create_file_watcher(FileWatcher& watcher, const FileWatcherConfig& config, FileWatchCallback on_change);
+
+    // Waits for a running `on_change` to return.
+    void destroy_file_watcher(FileWatcher& watcher);
+}
@@ -0,0 +1,354 @@
+#include "flight_recorder.h"
+#include "system/file.h"
+
+#include <cerrno>
+#include <condition_variable>
+#include <ctime>
+#include <mutex>
+#include <thread>
+
+#if defined(GM_PLATFORM_MACOS) || defined(GM_PLATFORM_LINUX)
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+namespace Game {
+    constexpr u32 max_flight_recorder_path_size = 512;
+
+    struct FlightRecorder {
+        FlightRecorderRing frames{
+            .title = "Frames",
+            .value_names = {"frame", "ticks", "events_us", "update_us", "render_us", "pacing_us"},
+        };
+        FlightRecorderRing input{
+            .title = "Input events",
+            .value_names = {"a", "b"},
+        };
+        FlightRecorderRing vulkan_results{
+            .title = "Vulkan results",
+            .value_names = {"result"},
+        };
+
+        // Copied out of the config up front, the dump cannot allocate
+        char dump_directory[max_flight_recorder_path_size]{};
+        i64 start_time_ns = 0;
+        std::atomic<bool> dumping = false;
+
+        // Stall watchdog
+        u32 stall_threshold_ms = 0;
+        std::atomic<i64> last_frame_time_ns = 0;
+        std::atomic<bool> watchdog_paused = false;
+        std::mutex watchdog_mutex;
+        std::condition_variable watchdog_condition;
+        bool watchdog_running = false;
+        std::thread watchdog_thread;
+    };
+
+    FlightRecorder flight_recorder{};
+
+    i64 get_flight_recorder_time_ns() {
+        return Time::as<Nanoseconds>(Time::now().time_since_epoch()).count();
+    }
+
+    // Returns the time of the record
+    i64 write_flight_record(FlightRecorderRing& ring, const char* name, const std::array<i64, flight_record_value_count>& values) {
+        u64 index = ring.record_count.fetch_add(1, std::memory_order_relaxed);
+        FlightRecord& record = ring.records[index % flight_recorder_capacity];
+
+        // Invalidate the slot first, a dump skips it until the sequence is published again
+        record.sequence.store(0, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        i64 time_ns = get_flight_recorder_time_ns();
+        record.time_ns.store(time_ns, std::memory_order_relaxed);
+        record.name.store(name, std::memory_order_relaxed);
+        for (u32 i = 0; i < flight_record_value_count; ++i) {
+            record.values[i].store(values[i], std::memory_order_relaxed);
+        }
+        record.sequence.store(index + 1, std::memory_order_release);
+        return time_ns;
+    }
+
+    void record_flight_frame(const FlightFrameTiming& timing) {
+        i64 time_ns = write_flight_record(flight_recorder.frames, "Frame", {
+            (i64) timing.frame_index,
+            (i64) timing.tick_count,
+            timing.events_duration.count(),
+            timing.update_duration.count(),
+            timing.render_duration.count(),
+            timing.pacing_duration.count(),
+        });
+        flight_recorder.last_frame_time_ns.store(time_ns, std::memory_order_relaxed);
+    }
+
+    void set_flight_recorder_watchdog_paused(bool paused) {
+        // Restart the stall from when the pause ended, and only if a frame has been recorded, before that nothing is stalled
+        if (!paused) {
+            i64 last_frame_time_ns = flight_recorder.last_frame_time_ns.load(std::memory_order_relaxed);
+            if (last_frame_time_ns != 0) {
+                flight_recorder.last_frame_time_ns.compare_exchange_strong(last_frame_time_ns, get_flight_recorder_time_ns(), std::memory_order_relaxed);
+            }
+        }
+        flight_recorder.watchdog_paused.store(paused, std::memory_order_relaxed);
+    }
+
+    void record_flight_input(const char* event_name, i64 value_a, i64 value_b) {
+        write_flight_record(flight_recorder.input, event_name, {value_a, value_b});
+    }
+
+    void record_flight_vulkan_result(const char* call_name, i32 result) {
+        write_flight_record(flight_recorder.vulkan_results, call_name, {result});
+    }
+
+    //
+    // Dumping. Everything below until the watchdog must be async-signal-safe: no allocations, locks, stdio or
+    // formatting from the standard library. The text is built in a fixed buffer and written with write(2).
+    //
+
+    struct FlightRecorderWriter {
+        i32 file_descriptor = -1;
+        u32 size = 0;
+        bool failed = false;
+        char buffer[4096];
+    };
+
+    void flush_flight_recorder_writer(FlightRecorderWriter& writer) {
+#if defined(GM_PLATFORM_MACOS) || defined(GM_PLATFORM_LINUX)
+        u32 offset = 0;
+        while (offset < writer.size && !writer.failed) {
+            ssize_t written = write(writer.file_descriptor, writer.buffer + offset, writer.size - offset);
+            if (written > 0) {
+                offset += (u32) written;
+            } else if (written < 0 && errno == EINTR) {
+                continue;
+            } else {
+                writer.failed = true;
+            }
+        }
+#endif
+        writer.size = 0;
+    }
+
+    void write_flight_recorder_text(FlightRecorderWriter& writer, const char* text) {
+        if (text == nullptr) {
+            text = "?";
+        }
+        for (; *text != '\0'; ++text) {
+            if (writer.size == sizeof(writer.buffer)) {
+                flush_flight_recorder_writer(writer);
+            }
+            writer.buffer[writer.size++] = *text;
+        }
+    }
+
+    // Formats into the caller's buffer, which must hold at least 21 characters
+    const char* format_flight_recorder_integer(i64 value, char* buffer, u32 buffer_size) {
+        char* end = buffer + buffer_size - 1;
+        char* begin = end;
+        *end = '\0';
+        u64 magnitude = value < 0 ? ~(u64) value + 1 : (u64) value;
+        do {
+            *--begin = (char) ('0' + magnitude % 10);
+            magnitude /= 10;
+        } while (magnitude > 0);
+        if (value < 0) {
+            *--begin = '-';
+        }
+        return begin;
+    }
+
+    void write_flight_recorder_integer(FlightRecorderWriter& writer, i64 value) {
+        char buffer[24];
+        write_flight_recorder_text(writer, format_flight_recorder_integer(value, buffer, sizeof(buffer)));
+    }
+
+    // Milliseconds with three decimals, relative to when the recorder was initialized
+    void write_flight_recorder_time(FlightRecorderWriter& writer, i64 time_ns) {
+        i64 time_us = (time_ns - flight_recorder.start_time_ns) / 1000;
+        if (time_us < 0) {
+            write_flight_recorder_text(writer, "-");
+            time_us = -time_us;
+        }
+        write_flight_recorder_integer(writer, time_us / 1000);
+        write_flight_recorder_text(writer, ".");
+        i64 fraction = time_us % 1000;
+        write_flight_recorder_text(writer, fraction < 100 ? (fraction < 10 ? "00" : "0") : "");
+        write_flight_recorder_integer(writer, fraction);
+    }
+
+    void write_flight_recorder_ring(FlightRecorderWriter& writer, const FlightRecorderRing& ring) {
+        u64 record_count = ring.record_count.load(std::memory_order_acquire);
+        u64 first_index = record_count > flight_recorder_capacity ? record_count - flight_recorder_capacity : 0;
+
+        write_flight_recorder_text(writer, "\n[");
+        write_flight_recorder_text(writer, ring.title);
+        write_flight_recorder_text(writer, "] last ");
+        write_flight_recorder_integer(writer, (i64) (record_count - first_index));
+        write_flight_recorder_text(writer, " of ");
+        write_flight_recorder_integer(writer, (i64) record_count);
+        write_flight_recorder_text(writer, "\n");
+
+        for (u64 index = first_index; index < record_count; ++index) {
+            const FlightRecord& record = ring.records[index % flight_recorder_capacity];
+
+            // Seqlock read, a record that is overwritten or unfinished while it's being read is skipped
+            if (record.sequence.load(std::memory_order_acquire) != index + 1) {
+                continue;
+            }
+            i64 time_ns = record.time_ns.load(std::memory_order_relaxed);
+            const char* name = record.name.load(std::memory_order_relaxed);
+            i64 values[flight_record_value_count];
+            for (u32 i = 0; i < flight_record_value_count; ++i) {
+                values[i] = record.values[i].load(std::memory_order_relaxed);
+            }
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (record.sequence.load(std::memory_order_relaxed) != index + 1) {
+                continue;
+            }
+
+            write_flight_recorder_time(writer, time_ns);
+            write_flight_recorder_text(writer, " ms ");
+            write_flight_recorder_text(writer, name);
+            for (u32 i = 0; i < flight_record_value_count; ++i) {
+                if (ring.value_names[i] == nullptr) {
+                    continue;
+                }
+                write_flight_recorder_text(writer, " ");
+                write_flight_recorder_text(writer, ring.value_names[i]);
+                write_flight_recorder_text(writer, "=");
+                write_flight_recorder_integer(writer, values[i]);
+            }
+            write_flight_recorder_text(writer, "\n");
+        }
+    }
+
+    bool dump_flight_recorder(const char* reason, i64 code) {
+#if defined(GM_PLATFORM_MACOS) || defined(GM_PLATFORM_LINUX)
+        if (flight_recorder.dump_directory[0] == '\0') {
+            return false;
+        }
+        if (flight_recorder.dumping.exchange(true, std::memory_order_acquire)) {
+            return false;
+        }
+
+        // <directory>/flight_recorder_<unix time>_<reason>_<code>.txt
+        char path[max_flight_recorder_path_size + 96];
+        u32 path_size = 0;
+        auto append_path = [&](const char* text) {
+            for (; *text != '\0' && path_size < sizeof(path) - 1; ++text) {
+                path[path_size++] = *text;
+            }
+        };
+        char integer_buffer[24];
+        append_path(flight_recorder.dump_directory);
+        append_path("/flight_recorder_");
+        append_path(format_flight_recorder_integer((i64) time(nullptr), integer_buffer, sizeof(integer_buffer)));
+        append_path("_");
+        append_path(reason);
+        append_path("_");
+        append_path(format_flight_recorder_integer(code, integer_buffer, sizeof(integer_buffer)));
+        append_path(".txt");
+        path[path_size] = '\0';
+
+        FlightRecorderWriter writer{};
+        writer.file_descriptor = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (writer.file_descriptor < 0) {
+            flight_recorder.dumping.store(false, std::memory_order_release);
+            return false;
+        }
+
+        write_flight_recorder_text(writer, "Flight recorder dump, reason [");
+        write_flight_recorder_text(writer, reason);
+        write_flight_recorder_text(writer, "] code [");
+        write_flight_recorder_integer(writer, code);
+        write_flight_recorder_text(writer, "] at ");
+        write_flight_recorder_time(writer, get_flight_recorder_time_ns());
+        write_flight_recorder_text(writer, " ms\n");
+
+        write_flight_recorder_ring(writer, flight_recorder.frames);
+        write_flight_recorder_ring(writer, flight_recorder.input);
+        write_flight_recorder_ring(writer, flight_recorder.vulkan_results);
+        flush_flight_recorder_writer(writer);
+        close(writer.file_descriptor);
+
+        flight_recorder.dumping.store(false, std::memory_order_release);
+        return !writer.failed;
+#else
+        (void) reason;
+        (void) code;
+        return false;
+#endif
+    }
+
+    //
+    // Stall watchdog
+    //
+
+    void run_flight_recorder_watchdog() {
+        // Check several times per threshold, so that a stall is caught close to when it crosses the threshold
+        auto check_interval = std::chrono::milliseconds(std::max(flight_recorder.stall_threshold_ms / 4, 1u));
+        i64 stall_threshold_ns = (i64) flight_recorder.stall_threshold_ms * 1000000;
+        i64 dumped_frame_time_ns = 0;
+
+        std::unique_lock lock(flight_recorder.watchdog_mutex);
+        while (flight_recorder.watchdog_running) {
+            flight_recorder.watchdog_condition.wait_for(lock, check_interval);
+
+            if (flight_recorder.watchdog_paused.load(std::memory_order_relaxed)) {
+                continue;
+            }
+
+            // Not stalled before the first frame, loading may take a while
+            i64 last_frame_time_ns = flight_recorder.last_frame_time_ns.load(std::memory_order_relaxed);
+            if (last_frame_time_ns == 0 || last_frame_time_ns == dumped_frame_time_ns) {
+                continue;
+            }
+            i64 stall_duration_ns = get_flight_recorder_time_ns() - last_frame_time_ns;
+            if (stall_duration_ns < stall_threshold_ns) {
+                continue;
+            }
+
+            // Dump once per stall
+            dumped_frame_time_ns = last_frame_time_ns;
+            i64 stall_duration_ms = stall_duration_ns / 1000000;
+            if (dump_flight_recorder("stall", stall_duration_ms)) {
+                GM_LOG_ERROR("No frame completed in [{} ms], dumped flight recorder to [{}]", stall_duration_ms, flight_recorder.dump_directory);
+            } else {
+                GM_LOG_ERROR("No frame completed in [{} ms], could not dump flight recorder", stall_duration_ms);
+            }
+        }
+    }
+
+    void initialize_flight_recorder(const FlightRecorderConfig& config) {
+        flight_recorder.start_time_ns = get_flight_recorder_time_ns();
+
+        std::string dump_directory;
+        if (!config.dump_directory.empty()) {
+            dump_directory = (get_executable_directory() / config.dump_directory).string();
+        }
+        if (dump_directory.size() >= max_flight_recorder_path_size) {
+            GM_THROW("Flight recorder dump directory [" << dump_directory << "] is too long");
+        }
+        if (!dump_directory.empty()) {
+            std::filesystem::create_directories(dump_directory);
+        }
+        std::memcpy(flight_recorder.dump_directory, dump_directory.c_str(), dump_directory.size() + 1);
+
+        flight_recorder.stall_threshold_ms = config.stall_threshold_ms;
+        if (config.stall_threshold_ms > 0) {
+            flight_recorder.watchdog_running = true;
+            flight_recorder.watchdog_thread = std::thread(run_flight_recorder_watchdog);
+        }
+    }
+
+    void shutdown_flight_recorder() {
+        {
+            std::lock_guard lock(flight_recorder.watchdog_mutex);
+            flight_recorder.watchdog_running = false;
+        }
+        flight_recorder.watchdog_condition.notify_all();
+        if (flight_recorder.watchdog_thread.joinable()) {
+            flight_recorder.watchdog_thread.join();
+        }
+    }
+}
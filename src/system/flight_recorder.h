@@ -0,0 +1,67 @@
+#pragma once
+
+#include "system/time.h"
+
+#include <array>
+#include <atomic>
+
+// The flight recorder keeps the recent history of the game in preallocated rings that are always on: the timings of
+// the last frames, the last input events and the last Vulkan results. Nothing is written until the game crashes or
+// stalls, then the rings are dumped to a text file with write(2) only, so the dump is safe to make from a signal handler.
+
+namespace Game {
+    constexpr u32 flight_recorder_capacity = 512;
+    constexpr u32 flight_record_value_count = 6;
+
+    struct FlightRecorderConfig {
+        // Dumps are written here, relative to the directory of the executable. Nothing is dumped when empty.
+        std::filesystem::path dump_directory = "logs";
+
+        // Dump when no frame has completed for this long, 0 to disable the stall watchdog
+        u32 stall_threshold_ms = 2000;
+    };
+
+    // Every field is atomic, so that a dump can read records that are being written by another thread. A relaxed
+    // atomic store is a plain store on the platforms we target.
+    struct FlightRecord {
+        std::atomic<u64> sequence = 0; // Index of the record plus one, 0 while it's being written
+        std::atomic<i64> time_ns = 0;
+        std::atomic<const char*> name = nullptr; // Must have static storage duration
+        std::atomic<i64> values[flight_record_value_count]{};
+    };
+
+    struct FlightRecorderRing {
+        const char* title = "";
+        std::array<const char*, flight_record_value_count> value_names{}; // Values without a name are not dumped
+        std::atomic<u64> record_count = 0;
+        FlightRecord records[flight_recorder_capacity];
+    };
+
+    struct FlightFrameTiming {
+        u64 frame_index = 0;
+        u32 tick_count = 0;
+        Microseconds events_duration{};
+        Microseconds update_duration{};
+        Microseconds render_duration{};
+        Microseconds pacing_duration{};
+    };
+
+    void initialize_flight_recorder(const FlightRecorderConfig& config);
+
+    // Stops the stall watchdog.
+    void shutdown_flight_recorder();
+
+    void record_flight_frame(const FlightFrameTiming& timing);
+
+    // Pauses the stall watchdog while no frames are expected, like while the window is minimized. The time spent
+    // paused doesn't count towards a stall.
+    void set_flight_recorder_watchdog_paused(bool paused);
+
+    void record_flight_input(const char* event_name, i64 value_a, i64 value_b);
+
+    void record_flight_vulkan_result(const char* call_name, i32 result);
+
+    // Writes the rings to a dump file in the dump directory. Async-signal-safe.
+    // Returns false if the dump could not be written, or if another dump is in progress.
+    bool dump_flight_recorder(const char* reason, i64 code);
+}
@@ -0,0 +1,57 @@
+#include "frame_pacer.h"
+
+#include <cmath>
+#include <thread>
+
+namespace Game {
+    constexpr f64 sleep_slice_ms = 1.0;
+
+    // Weight of the latest sample in the rolling sleep estimate
+    constexpr f64 sleep_estimate_weight = 0.1;
+
+    // Weight of the latest sample in the average jitter
+    constexpr f64 jitter_average_weight = 0.05;
+
+    f64 get_elapsed_ms(TimePoint from, TimePoint to) {
+        return Time::as<Nanoseconds>(to - from).count() / 1000000.0;
+    }
+
+    void update_sleep_estimate(FramePacer& pacer, f64 sleep_ms) {
+        f64 delta_ms = sleep_ms - pacer.sleep_mean_ms;
+        pacer.sleep_mean_ms += delta_ms * sleep_estimate_weight;
+        pacer.sleep_variance_ms = (1.0 - sleep_estimate_weight) * (pacer.sleep_variance_ms + delta_ms * delta_ms * sleep_estimate_weight);
+    }
+
+    void wait_for_next_frame(FramePacer& pacer, f64 frame_time_ms) {
+        TimePoint now = Time::now();
+        TimePoint deadline = pacer.frame_deadline + Time::as<Nanoseconds>(Milliseconds(frame_time_ms));
+
+        // Start over when a whole frame behind, instead of rushing through frames to catch up with old deadlines
+        if (get_elapsed_ms(deadline, now) > frame_time_ms) {
+            pacer.frame_deadline = now;
+            return;
+        }
+
+        // Sleep while there is more time left than a sleep is expected to take, including a margin for its variance
+        f64 remaining_ms = get_elapsed_ms(now, deadline);
+        while (remaining_ms > pacer.sleep_mean_ms + std::sqrt(pacer.sleep_variance_ms)) {
+            TimePoint sleep_start_time = now;
+            std::this_thread::sleep_for(Milliseconds(sleep_slice_ms));
+            now = Time::now();
+            update_sleep_estimate(pacer, get_elapsed_ms(sleep_start_time, now));
+            remaining_ms = get_elapsed_ms(now, deadline);
+        }
+
+        // Spin-wait the last fraction of a millisecond
+        while (now < deadline) {
+            now = Time::now();
+        }
+
+        FramePacerStats& stats = pacer.stats;
+        stats.last_jitter_ms = get_elapsed_ms(deadline, now);
+        stats.average_jitter_ms += (stats.last_jitter_ms - stats.average_jitter_ms) * jitter_average_weight;
+        stats.max_jitter_ms = std::max(stats.max_jitter_ms, stats.last_jitter_ms);
+
+        pacer.frame_deadline = deadline;
+    }
+}
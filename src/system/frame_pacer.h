@@ -0,0 +1,28 @@
+#pragma once
+
+#include "system/time.h"
+
+namespace Game {
+    struct FramePacerStats {
+        f64 last_jitter_ms = 0.0;    // How late the last frame started, relative to its deadline
+        f64 average_jitter_ms = 0.0;
+        f64 max_jitter_ms = 0.0;
+    };
+
+    // Paces frames to a target frame time. Sleeping alone is not precise enough, the OS commonly wakes the thread
+    // up a millisecond or more too late, and spinning alone burns a full core. The pacer sleeps in short slices
+    // while the remaining time is larger than the expected sleep overshoot, and spin-waits the rest.
+    struct FramePacer {
+        TimePoint frame_deadline = Time::zero();
+
+        // Rolling estimate of how long a sleep of `sleep_slice_ms` actually takes
+        f64 sleep_mean_ms = 1.0;
+        f64 sleep_variance_ms = 0.0;
+
+        FramePacerStats stats{};
+    };
+
+    // Blocks until `frame_time_ms` has passed since the previous frame deadline.
+    // If the frame took longer than that, it returns immediately and the deadlines start over from now.
+    void wait_for_next_frame(FramePacer& pacer, f64 frame_time_ms);
+}
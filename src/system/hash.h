@@ -0,0 +1,34 @@
+#pragma once
+
+#include "system/numbers.h"
+
+#include <string_view>
+#include <type_traits>
+
+// FNV-1a, for hashes that must be cheap and the same on every run and platform, like log call sites and cache keys.
+// Start from fnv1a_offset_basis and feed every part of the key in order.
+
+namespace Game {
+    constexpr u64 fnv1a_offset_basis = 14695981039346656037ull;
+    constexpr u64 fnv1a_prime = 1099511628211ull;
+
+    constexpr u64 hash_byte(u64 hash, u8 byte) {
+        return (hash ^ byte) * fnv1a_prime;
+    }
+
+    constexpr u64 hash_bytes(u64 hash, std::string_view bytes) {
+        for (char c : bytes) {
+            hash = hash_byte(hash, (u8) c);
+        }
+        return hash;
+    }
+
+    // Hashes the bytes of the value from the least significant, so the hash doesn't depend on the byte order
+    template<typename T> requires std::is_integral_v<T>
+    constexpr u64 hash_combine(u64 hash, T value) {
+        for (u32 i = 0; i < sizeof(T); ++i) {
+            hash = hash_byte(hash, (u8) ((u64) value >> (i * 8)));
+        }
+        return hash;
+    }
+}
@@ -0,0 +1,269 @@
+#include "job_system.h"
+
+namespace Game {
+    constexpr u32 invalid_worker_index = UINT32_MAX;
+
+    // Number of failed attempts to find a job before an idle worker goes to sleep.
+    constexpr u32 max_idle_spin_count = 256;
+
+    thread_local u32 current_worker_index = invalid_worker_index;
+
+    //
+    // Queue
+    //
+
+    void create_job_queue(JobQueue& queue, u32 capacity) {
+        queue.jobs = std::vector<std::atomic<Job*>>(capacity);
+        queue.mask = capacity - 1;
+    }
+
+    // Only called by the owning worker.
+    bool push_job(JobQueue& queue, Job* job) {
+        i64 bottom = queue.bottom.load(std::memory_order_relaxed);
+        i64 top = queue.top.load(std::memory_order_acquire);
+        if (bottom - top >= (i64) queue.jobs.size()) {
+            return false;
+        }
+        queue.jobs[bottom & queue.mask].store(job, std::memory_order_relaxed);
+
+        // Release the job (and the contents of the job) to any thief that observes the new bottom
+        queue.bottom.store(bottom + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Only called by the owning worker.
+    Job* pop_job(JobQueue& queue) {
+        i64 bottom = queue.bottom.load(std::memory_order_relaxed) - 1;
+        queue.bottom.store(bottom, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        i64 top = queue.top.load(std::memory_order_relaxed);
+
+        if (top > bottom) {
+            // The queue is empty
+            queue.bottom.store(bottom + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+
+        Job* job = queue.jobs[bottom & queue.mask].load(std::memory_order_relaxed);
+        if (top != bottom) {
+            // There are still more jobs left in the queue, no need to race the thieves for this one
+            return job;
+        }
+
+        // This is the last job in the queue, and a thief might be trying to steal it at the same time
+        if (!queue.top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            job = nullptr;
+        }
+        queue.bottom.store(bottom + 1, std::memory_order_relaxed);
+        return job;
+    }
+
+    // Called by any worker other than the owner.
+    Job* steal_job(JobQueue& queue) {
+        i64 top = queue.top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        i64 bottom = queue.bottom.load(std::memory_order_acquire);
+        if (top >= bottom) {
+            return nullptr;
+        }
+        Job* job = queue.jobs[top & queue.mask].load(std::memory_order_relaxed);
+        if (!queue.top.compare_exchange_strong(top, top + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            // Lost the race against the owner or another thief
+            return nullptr;
+        }
+        return job;
+    }
+
+    //
+    // Workers
+    //
+
+    u32 get_random_worker_index(JobWorker& worker, u32 worker_count) {
+        // Xorshift, good enough to spread out the victims of work stealing
+        u32 x = worker.random_state;
+        x ^= x << 13;
+        x ^= x >> 17;
+        x ^= x << 5;
+        worker.random_state = x;
+        return x % worker_count;
+    }
+
+    Job* get_job(JobSystem& job_system, u32 worker_index) {
+        JobWorker& worker = job_system.workers[worker_index];
+        if (Job* job = pop_job(worker.queue)) {
+            return job;
+        }
+        u32 victim_index = get_random_worker_index(worker, job_system.worker_count);
+        for (u32 i = 0; i < job_system.worker_count; ++i) {
+            u32 index = (victim_index + i) % job_system.worker_count;
+            if (index == worker_index) {
+                continue;
+            }
+            if (Job* job = steal_job(job_system.workers[index].queue)) {
+                return job;
+            }
+        }
+        return nullptr;
+    }
+
+    // Runs a copy of the job, so that its slot can be reused as soon as it has started
+    void execute_job(Job& job) {
+        Job local_job;
+        local_job.function = job.function;
+        local_job.counter = job.counter;
+        std::memcpy(local_job.data, job.data, sizeof(job.data));
+        job.started.store(true, std::memory_order_release);
+
+        local_job.function(local_job);
+        if (local_job.counter) {
+            local_job.counter->value.fetch_sub(1, std::memory_order_acq_rel);
+        }
+    }
+
+    void wake_workers(JobSystem& job_system, u32 job_count) {
+        job_system.wake_generation.fetch_add(1, std::memory_order_release);
+        if (job_count == 1) {
+            job_system.wake_generation.notify_one();
+        } else {
+            job_system.wake_generation.notify_all();
+        }
+    }
+
+    void run_worker(JobSystem& job_system, u32 worker_index) {
+        current_worker_index = worker_index;
+        u32 idle_spin_count = 0;
+        while (job_system.running.load(std::memory_order_acquire)) {
+            // Read the generation before looking for jobs, so that a job submitted after a failed search changes the
+            // generation and prevents the worker from going to sleep.
+            u32 wake_generation = job_system.wake_generation.load(std::memory_order_acquire);
+
+            if (Job* job = get_job(job_system, worker_index)) {
+                execute_job(*job);
+                idle_spin_count = 0;
+                continue;
+            }
+
+            // Spin for a while before going to sleep, since jobs tend to arrive in bursts within a frame
+            if (++idle_spin_count < max_idle_spin_count) {
+                std::this_thread::yield();
+                continue;
+            }
+
+            job_system.wake_generation.wait(wake_generation, std::memory_order_acquire);
+            idle_spin_count = 0;
+        }
+        current_worker_index = invalid_worker_index;
+    }
+
+    //
+    // Job system
+    //
+
+    void create_job_system(JobSystem& job_system, const JobSystemConfig& config) {
+        job_system.config = config;
+
+        u32 max_jobs_per_worker = config.max_jobs_per_worker;
+        if (max_jobs_per_worker == 0 || (max_jobs_per_worker & (max_jobs_per_worker - 1)) != 0) {
+            GM_THROW("Max jobs per worker [" << max_jobs_per_worker << "] must be a power of two");
+        }
+
+        u32 worker_count = config.worker_count;
+        if (worker_count == 0) {
+            worker_count = std::max(std::thread::hardware_concurrency(), 1u);
+        }
+
+        job_system.worker_count = worker_count;
+        job_system.workers = std::make_unique<JobWorker[]>(worker_count);
+        for (u32 i = 0; i < worker_count; ++i) {
+            JobWorker& worker = job_system.workers[i];
+            create_job_queue(worker.queue, max_jobs_per_worker);
+            worker.jobs = std::make_unique<Job[]>(max_jobs_per_worker);
+            worker.random_state = i + 1;
+        }
+
+        // The calling thread is worker 0 and executes jobs whenever it waits for a counter.
+        current_worker_index = 0;
+
+        job_system.running.store(true, std::memory_order_release);
+        for (u32 i = 1; i < worker_count; ++i) {
+            job_system.workers[i].thread = std::thread(run_worker, std::ref(job_system), i);
+        }
+
+        GM_LOG_DEBUG("Created job system with [{}] workers", worker_count);
+    }
+
+    void destroy_job_system(JobSystem& job_system) {
+        if (!job_system.workers) {
+            return;
+        }
+        job_system.running.store(false, std::memory_order_release);
+        wake_workers(job_system, job_system.worker_count);
+        for (u32 i = 1; i < job_system.worker_count; ++i) {
+            if (job_system.workers[i].thread.joinable()) {
+                job_system.workers[i].thread.join();
+            }
+        }
+        job_system.workers.reset();
+        job_system.worker_count = 0;
+        current_worker_index = invalid_worker_index;
+    }
+
+    u32 get_job_worker_index() {
+        return current_worker_index;
+    }
+
+    Job& allocate_job(JobSystem& job_system) {
+        u32 worker_index = current_worker_index;
+        if (worker_index == invalid_worker_index) {
+            GM_THROW("Jobs can only be created from job system worker threads");
+        }
+        JobWorker& worker = job_system.workers[worker_index];
+        u32 job_index = worker.allocated_job_count++ & (job_system.config.max_jobs_per_worker - 1);
+        Job& job = worker.jobs[job_index];
+
+        // The ring has wrapped around to a job that is still queued, run queued jobs until it has been picked up
+        while (!job.started.load(std::memory_order_acquire)) {
+            if (Job* queued_job = get_job(job_system, worker_index)) {
+                execute_job(*queued_job);
+            } else {
+                std::this_thread::yield();
+            }
+        }
+        job.started.store(false, std::memory_order_relaxed);
+        return job;
+    }
+
+    void submit_job(JobSystem& job_system, Job& job) {
+        Job* jobs[] = { &job };
+        submit_jobs(job_system, jobs, 1);
+    }
+
+    void submit_jobs(JobSystem& job_system, Job** jobs, u32 job_count) {
+        u32 worker_index = current_worker_index;
+        if (worker_index == invalid_worker_index) {
+            GM_THROW("Jobs can only be submitted from job system worker threads");
+        }
+        JobWorker& worker = job_system.workers[worker_index];
+        for (u32 i = 0; i < job_count; ++i) {
+            // If our own queue is full, execute the job right away instead of dropping it.
+            if (!push_job(worker.queue, jobs[i])) {
+                execute_job(*jobs[i]);
+            }
+        }
+        wake_workers(job_system, job_count);
+    }
+
+    void wait_for_counter(JobSystem& job_system, const JobCounter& counter) {
+        u32 worker_index = current_worker_index;
+        if (worker_index == invalid_worker_index) {
+            GM_THROW("Only job system worker threads can wait for a job counter");
+        }
+        while (counter.value.load(std::memory_order_acquire) > 0) {
+            if (Job* job = get_job(job_system, worker_index)) {
+                execute_job(*job);
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    }
+}
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <atomic>
+#include <cstring>
+#include <thread>
+
+namespace Game {
+    // Tracks the number of unfinished jobs in a group of jobs. Incremented when jobs are submitted and decremented when
+    // they finish, so waiting for the counter to reach zero joins all the jobs that were forked with it.
+    struct JobCounter {
+        std::atomic<u32> value = 0;
+    };
+
+    // A job is a function pointer and a small inline payload, padded to a cache line so that jobs allocated next to
+    // each other by the same worker don't cause false sharing when they are executed on different threads.
+    struct alignas(64) Job {
+        void (*function)(Job& job) = nullptr;
+        JobCounter* counter = nullptr;
+        u8 data[44]{};
+        std::atomic<bool> started = true; // Cleared when allocated, the slot can be reused once the job has started
+    };
+
+    static_assert(sizeof(Job) == 64);
+
+    // Chase-Lev work-stealing deque with a fixed capacity.
+    // The owning worker pushes and pops jobs at the bottom (LIFO, cache-friendly), while other workers steal from the top (FIFO).
+    // https://www.di.ens.fr/~zappa/readings/ppopp13.pdf
+    struct JobQueue {
+        std::atomic<i64> top = 0;
+        std::atomic<i64> bottom = 0;
+        std::vector<std::atomic<Job*>> jobs;
+        u32 mask = 0;
+    };
+
+    struct JobWorker {
+        JobQueue queue{};
+        std::unique_ptr<Job[]> jobs; // Ring buffer of preallocated jobs, recycled when the worker wraps around
+        u32 allocated_job_count = 0;
+        u32 random_state = 0;
+        std::thread thread;
+    };
+
+    struct JobSystemConfig {
+        // Number of worker threads, including the main thread. Zero means one worker per hardware thread.
+        u32 worker_count = 0;
+
+        // Maximum number of jobs a single worker can have allocated that have not started yet. Must be a power of two.
+        // Allocating more makes the worker run queued jobs until the oldest one has started.
+        u32 max_jobs_per_worker = 4096;
+    };
+
+    struct JobSystem {
+        JobSystemConfig config{};
+        std::unique_ptr<JobWorker[]> workers;
+        u32 worker_count = 0;
+        std::atomic<bool> running = false;
+        std::atomic<u32> wake_generation = 0;
+    };
+
+    void create_job_system(JobSystem& job_system, const JobSystemConfig& config = {});
+
+    void destroy_job_system(JobSystem& job_system);
+
+    // Index of the calling worker, where the thread that created the job system is worker 0.
+    u32 get_job_worker_index();
+
+    // The job must be submitted before the worker allocates another max_jobs_per_worker jobs, since its slot is only
+    // reused after it has started.
+    Job& allocate_job(JobSystem& job_system);
+
+    void submit_job(JobSystem& job_system, Job& job);
+
+    void submit_jobs(JobSystem& job_system, Job** jobs, u32 job_count);
+
+    // Blocks until the counter reaches zero. The calling thread executes queued jobs while it waits, which means that
+    // jobs can fork and join other jobs without tying up a worker.
+    void wait_for_counter(JobSystem& job_system, const JobCounter& counter);
+
+    template<typename Function>
+    Job& create_job(JobSystem& job_system, const Function& function, JobCounter* counter = nullptr) {
+        static_assert(sizeof(Function) <= sizeof(Job::data), "Job function captures do not fit in the job payload");
+        static_assert(std::is_trivially_copyable_v<Function>, "Job function captures must be trivially copyable");
+
+        Job& job = allocate_job(job_system);
+        job.counter = counter;
+        job.function = [](Job& job) {
+            (*reinterpret_cast<Function*>(job.data))();
+        };
+        std::memcpy(job.data, &function, sizeof(Function));
+        return job;
+    }
+
+    template<typename Function>
+    void run_job(JobSystem& job_system, const Function& function, JobCounter* counter = nullptr) {
+        if (counter) {
+            counter->value.fetch_add(1, std::memory_order_relaxed);
+        }
+        submit_job(job_system, create_job(job_system, function, counter));
+    }
+
+    // Splits the index range [0, count) into batches of `batch_size` and calls `function(begin, end)` for every batch on the worker threads.
+    // Returns when all batches have been processed.
+    template<typename Function>
+    void parallel_for(JobSystem& job_system, u32 count, u32 batch_size, const Function& function) {
+        if (count == 0) {
+            return;
+        }
+        batch_size = std::max(batch_size, 1u);
+
+        // Jobs are recycled from a ring buffer per worker, so grow the batches if the range would otherwise need more
+        // jobs than half of what a worker can have in flight.
+        u32 max_batch_count = job_system.config.max_jobs_per_worker / 2;
+        batch_size = std::max(batch_size, (count + max_batch_count - 1) / max_batch_count);
+
+        // Run small ranges inline, there's no point paying for scheduling when there is only a single batch.
+        if (count <= batch_size || job_system.worker_count <= 1) {
+            function(0u, count);
+            return;
+        }
+
+        // The jobs only capture a pointer to the function, which is safe since we wait for all jobs before returning.
+        const Function* function_ptr = &function;
+
+        // Submit jobs in chunks so that other workers can start stealing while the remaining batches are being created.
+        constexpr u32 max_jobs_per_submit = 64;
+        Job* jobs[max_jobs_per_submit];
+
+        JobCounter counter{};
+        u32 batch_count = (count + batch_size - 1) / batch_size;
+        counter.value.store(batch_count, std::memory_order_relaxed);
+
+        u32 job_count = 0;
+        for (u32 begin = 0; begin < count; begin += batch_size) {
+            u32 end = std::min(begin + batch_size, count);
+            jobs[job_count++] = &create_job(job_system, [function_ptr, begin, end] {
+                (*function_ptr)(begin, end);
+            }, &counter);
+            if (job_count == max_jobs_per_submit) {
+                submit_jobs(job_system, jobs, job_count);
+                job_count = 0;
+            }
+        }
+        if (job_count > 0) {
+            submit_jobs(job_system, jobs, job_count);
+        }
+
+        wait_for_counter(job_system, counter);
+    }
+}
@@ -1,15 +1,64 @@
 #include "log.h"
+#include "async_log_sink.h"
+
+#include <spdlog/sinks/rotating_file_sink.h>
+#include <spdlog/sinks/stdout_color_sinks.h>
 
 namespace Game {
-    void initialize_log(LogLevel level) {
+    std::shared_ptr<AsyncLogSink> async_log_sink = nullptr;
+
+    void initialize_log(const LogConfig& config) {
+        // The sinks are only used by one thread when logging asynchronously, so they don't need their own locks
+        std::vector<spdlog::sink_ptr> sinks;
+        if (config.async_enabled) {
+            sinks.push_back(std::make_shared<spdlog::sinks::stdout_color_sink_st>());
+        } else {
+            sinks.push_back(std::make_shared<spdlog::sinks::stdout_color_sink_mt>());
+        }
+        if (!config.file_path.empty()) {
+            if (config.async_enabled) {
+                sinks.push_back(std::make_shared<spdlog::sinks::rotating_file_sink_st>(config.file_path.string(), config.max_file_size, config.max_file_count));
+            } else {
+                sinks.push_back(std::make_shared<spdlog::sinks::rotating_file_sink_mt>(config.file_path.string(), config.max_file_size, config.max_file_count));
+            }
+        }
+
+        std::shared_ptr<spdlog::logger> logger;
+        if (config.async_enabled) {
+            async_log_sink = std::make_shared<AsyncLogSink>(AsyncLogSinkConfig{
+                .sinks = sinks,
+                .queue_size = config.async_queue_size,
+                .overflow_policy = config.overflow_policy,
+            });
+            logger = std::make_shared<spdlog::logger>("Game", async_log_sink);
+        } else {
+            logger = std::make_shared<spdlog::logger>("Game", sinks.begin(), sinks.end());
+        }
+
+        // Messages that are about to end the app should not be left behind in the queue
+        logger->flush_on(LogLevel::err);
+
+        spdlog::set_default_logger(logger);
+
         // Set runtime log-level. This determines which log statements are actually printed at runtime.
         // This does nothing if the compile-time log-level is higher which will cause the log statements to be compiled away.
-        spdlog::set_level(level);
+        spdlog::set_level(config.level);
 
         // https://github.com/gabime/spdlog/wiki/Custom-formatting#pattern-flags
         spdlog::set_pattern("[%Y-%m-%d %H:%M:%S:%e] [%^%l%$] [%s:%#] [%!] %v");
     }
 
+    void shutdown_log() {
+        if (async_log_sink != nullptr) {
+            async_log_sink->shutdown();
+        }
+        spdlog::default_logger()->flush();
+    }
+
+    u64 get_dropped_log_message_count() {
+        return async_log_sink != nullptr ? async_log_sink->get_dropped_message_count() : 0;
+    }
+
     std::string tag(const char* file_name, const char* function_name, const int line_number) {
         std::stringstream ss;
         ss << file_name << ":" << line_number << " (" << function_name << ")";
@@ -21,4 +70,4 @@ namespace Game {
         ss << "[" << file_name << ":" << line_number << "] [" << function_name << "] " << message;
         return ss.str();
     }
-}
\ No newline at end of file
+}
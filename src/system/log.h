@@ -3,6 +3,8 @@
 // Set compile-time log-level. This determines which log statements are included in the compiled code.
 #define SPDLOG_ACTIVE_LEVEL SPDLOG_LEVEL_TRACE
 
+#include "system/numbers.h"
+
 #include <spdlog/spdlog.h>
 
 #define GM_FILE_NAME __FILE_NAME__
@@ -28,7 +30,34 @@
 namespace Game {
     typedef spdlog::level::level_enum LogLevel;
 
-    void initialize_log(LogLevel level);
+    // What logging does when the async log queue is full
+    enum class LogOverflowPolicy {
+        Block,      // Wait for the writer thread to make room
+        DropNewest, // Drop the message being logged
+        DropOldest, // Drop the oldest queued message to make room
+    };
+
+    struct LogConfig {
+        LogLevel level = LogLevel::trace;
+
+        // Write log messages on a background thread, so that logging never blocks on terminal or disk I/O.
+        bool async_enabled = true;
+        u32 async_queue_size = 8192;
+        LogOverflowPolicy overflow_policy = LogOverflowPolicy::DropOldest;
+
+        // Also log to rotating files when set.
+        std::filesystem::path file_path;
+        u64 max_file_size = 5 * 1024 * 1024;
+        u32 max_file_count = 3;
+    };
+
+    void initialize_log(const LogConfig& config);
+
+    // Writes all pending log messages. Must be called before exiting when async logging is enabled.
+    void shutdown_log();
+
+    // Messages dropped because the async log queue was full.
+    u64 get_dropped_log_message_count();
 
     std::string tag(const char* file_name, const char* function_name, int line_number);
 }
@@ -0,0 +1,196 @@
+#include "lz4.h"
+
+#include <cstring>
+
+namespace Game {
+    constexpr u32 lz4_min_match_size = 4;
+
+    // The last match must start at least this many bytes before the end of the block
+    constexpr u32 lz4_match_start_limit = 12;
+
+    // The last bytes of a block are always literals
+    constexpr u32 lz4_last_literal_size = 5;
+
+    constexpr u32 lz4_max_offset = 65535;
+    constexpr u32 lz4_hash_bits = 12;
+
+    u32 read_lz4_u32(const u8* bytes) {
+        u32 value;
+        std::memcpy(&value, bytes, sizeof(u32));
+        return value;
+    }
+
+    u32 get_lz4_hash(u32 sequence) {
+        return (sequence * 2654435761u) >> (32 - lz4_hash_bits);
+    }
+
+    // Lengths that don't fit in the 4 bits of the token continue in bytes of 255, ended by a smaller byte
+    void write_lz4_length(std::vector<u8>& destination, u64 length) {
+        while (length >= 255) {
+            destination.push_back(255);
+            length -= 255;
+        }
+        destination.push_back((u8) length);
+    }
+
+    void write_lz4_sequence(std::vector<u8>& destination, const u8* literals, u64 literal_size, u32 offset, u64 match_size) {
+        bool has_match = match_size > 0;
+        u64 match_length = has_match ? match_size - lz4_min_match_size : 0;
+
+        u8 token = (u8) (std::min<u64>(literal_size, 15) << 4);
+        if (has_match) {
+            token |= (u8) std::min<u64>(match_length, 15);
+        }
+        destination.push_back(token);
+        if (literal_size >= 15) {
+            write_lz4_length(destination, literal_size - 15);
+        }
+        destination.insert(destination.end(), literals, literals + literal_size);
+
+        if (has_match) {
+            destination.push_back((u8) offset);
+            destination.push_back((u8) (offset >> 8));
+            if (match_length >= 15) {
+                write_lz4_length(destination, match_length - 15);
+            }
+        }
+    }
+
+    void compress_lz4(std::span<const u8> source, std::vector<u8>& destination) {
+        const u8* begin = source.data();
+        const u8* end = begin + source.size();
+        const u8* literals = begin;
+
+        if (source.size() > lz4_match_start_limit) {
+            // Last position where a match may start, and last position a match may extend to
+            const u8* match_start_limit = end - lz4_match_start_limit;
+            const u8* match_end_limit = end - lz4_last_literal_size;
+
+            // Positions of the last occurrence of every hashed 4-byte sequence, relative to the start of the source
+            std::vector<u32> positions(1u << lz4_hash_bits, 0);
+
+            const u8* position = begin + 1;
+            positions[get_lz4_hash(read_lz4_u32(begin))] = 0;
+            while (position <= match_start_limit) {
+                u32 sequence = read_lz4_u32(position);
+                u32 hash = get_lz4_hash(sequence);
+                const u8* candidate = begin + positions[hash];
+                positions[hash] = (u32) (position - begin);
+
+                if (position - candidate > lz4_max_offset || candidate >= position || read_lz4_u32(candidate) != sequence) {
+                    ++position;
+                    continue;
+                }
+
+                // Extend the match backwards over the pending literals, then forwards
+                while (position > literals && candidate > begin && position[-1] == candidate[-1]) {
+                    --position;
+                    --candidate;
+                }
+                const u8* match_end = position + lz4_min_match_size;
+                const u8* candidate_end = candidate + lz4_min_match_size;
+                while (match_end < match_end_limit && *match_end == *candidate_end) {
+                    ++match_end;
+                    ++candidate_end;
+                }
+
+                write_lz4_sequence(destination, literals, (u64) (position - literals), (u32) (position - candidate), (u64) (match_end - position));
+                literals = match_end;
+                position = match_end;
+
+                // Index a position inside the match, so that repeats of the matched data are found sooner
+                if (position - 2 > begin && position <= match_start_limit) {
+                    positions[get_lz4_hash(read_lz4_u32(position - 2))] = (u32) (position - 2 - begin);
+                }
+            }
+        }
+
+        write_lz4_sequence(destination, literals, (u64) (end - literals), 0, 0);
+    }
+
+    bool decompress_lz4(std::span<const u8> source, std::span<u8> destination) {
+        const u8* input = source.data();
+        const u8* input_end = input + source.size();
+        u8* output = destination.data();
+        u8* output_begin = output;
+        u8* output_end = output + destination.size();
+
+        auto read_length = [&](u64& length) {
+            u8 byte;
+            do {
+                if (input >= input_end) {
+                    return false;
+                }
+                byte = *input++;
+                length += byte;
+            } while (byte == 255);
+            return true;
+        };
+
+        while (input < input_end) {
+            u8 token = *input++;
+
+            u64 literal_size = token >> 4;
+            if (literal_size == 15 && !read_length(literal_size)) {
+                return false;
+            }
+            if (literal_size > (u64) (input_end - input) || literal_size > (u64) (output_end - output)) {
+                return false;
+            }
+
+            // Short runs are copied with a fixed size when there is room to overshoot, which is a lot faster than an
+            // exact copy of a variable size. The bytes past the run are overwritten by what comes next anyway.
+            if (literal_size <= 16 && input_end - input >= 16 && output_end - output >= 16) {
+                std::memcpy(output, input, 16);
+            } else if (literal_size > 0) {
+                std::memcpy(output, input, literal_size);
+            }
+            input += literal_size;
+            output += literal_size;
+
+            // The last sequence has no match
+            if (input == input_end) {
+                break;
+            }
+
+            if (input_end - input < 2) {
+                return false;
+            }
+            u32 offset = (u32) input[0] | ((u32) input[1] << 8);
+            input += 2;
+            if (offset == 0 || offset > (u64) (output - output_begin)) {
+                return false;
+            }
+
+            u64 match_size = token & 15;
+            if (match_size == 15 && !read_length(match_size)) {
+                return false;
+            }
+            match_size += lz4_min_match_size;
+            if (match_size > (u64) (output_end - output)) {
+                return false;
+            }
+
+            // Matches may overlap the output they produce (offset smaller than size), which repeats the pattern.
+            // Copies in chunks of 8 bytes are still correct when the offset is at least 8.
+            const u8* match = output - offset;
+            if (offset >= 8 && (u64) (output_end - output) >= match_size + 8) {
+                u8* match_end = output + match_size;
+                while (output < match_end) {
+                    std::memcpy(output, match, 8);
+                    output += 8;
+                    match += 8;
+                }
+                output = match_end;
+            } else if (offset >= match_size) {
+                std::memcpy(output, match, match_size);
+                output += match_size;
+            } else {
+                for (u64 i = 0; i < match_size; ++i) {
+                    *output++ = match[i];
+                }
+            }
+        }
+        return output == output_end;
+    }
+}
@@ -0,0 +1,22 @@
+#pragma once
+
+#include "system/numbers.h"
+
+#include <span>
+#include <vector>
+
+// Compression in the LZ4 block format (https://github.com/lz4/lz4/blob/dev/doc/lz4_Block_format.md). Blocks are
+// compatible with the reference implementation, but the compressor is a plain greedy one, it favors a small amount
+// of code over ratio. Decompression is as fast as the format allows.
+
+namespace Game {
+    // Largest input the block format supports
+    constexpr u64 max_lz4_input_size = 0x7E000000;
+
+    // Appends the compressed block to the destination.
+    void compress_lz4(std::span<const u8> source, std::vector<u8>& destination);
+
+    // Decompresses a block into a destination of exactly the uncompressed size.
+    // Returns false if the block is malformed or doesn't decompress to the destination size.
+    bool decompress_lz4(std::span<const u8> source, std::span<u8> destination);
+}
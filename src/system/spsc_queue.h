@@ -0,0 +1,58 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+
+namespace Game {
+    // Bounded lock-free queue for exactly one producer thread and one consumer thread.
+    // The producer only writes the tail and the consumer only writes the head, and both keep a cached copy of
+    // the other side's index so that they only touch the other side's cache line when the cache runs out.
+    template<typename T, u32 Capacity>
+    struct SpscQueue {
+        static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Capacity must be a power of two");
+        static_assert(std::is_trivially_copyable_v<T>, "Items must be trivially copyable");
+
+        alignas(64) std::atomic<u32> head = 0;
+        u32 cached_tail = 0; // Consumer's copy of the tail
+
+        alignas(64) std::atomic<u32> tail = 0;
+        u32 cached_head = 0; // Producer's copy of the head
+
+        alignas(64) std::array<T, Capacity> items{};
+    };
+
+    // Producer only. Returns false if the queue is full.
+    template<typename T, u32 Capacity>
+    bool push_spsc_queue(SpscQueue<T, Capacity>& queue, const T& item) {
+        u32 tail = queue.tail.load(std::memory_order_relaxed);
+        if (tail - queue.cached_head == Capacity) {
+            queue.cached_head = queue.head.load(std::memory_order_acquire);
+            if (tail - queue.cached_head == Capacity) {
+                return false;
+            }
+        }
+        queue.items[tail & (Capacity - 1)] = item;
+        queue.tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer only. Returns the oldest item without removing it, or nullptr if the queue is empty.
+    template<typename T, u32 Capacity>
+    const T* peek_spsc_queue(SpscQueue<T, Capacity>& queue) {
+        u32 head = queue.head.load(std::memory_order_relaxed);
+        if (head == queue.cached_tail) {
+            queue.cached_tail = queue.tail.load(std::memory_order_acquire);
+            if (head == queue.cached_tail) {
+                return nullptr;
+            }
+        }
+        return &queue.items[head & (Capacity - 1)];
+    }
+
+    // Consumer only. Removes the oldest item, the queue must not be empty.
+    template<typename T, u32 Capacity>
+    void pop_spsc_queue(SpscQueue<T, Capacity>& queue) {
+        u32 head = queue.head.load(std::memory_order_relaxed);
+        queue.head.store(head + 1, std::memory_order_release);
+    }
+}
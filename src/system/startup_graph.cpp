@@ -0,0 +1,167 @@
+#include "startup_graph.h"
+
+namespace Game {
+    f64 get_startup_ms(const StartupGraph& graph, TimePoint time_point) {
+        return Time::as<Microseconds>(time_point - graph.start_time).count() / 1000.0;
+    }
+
+    void submit_startup_phase(StartupGraph& graph, u32 phase_index);
+
+    void run_startup_phase(StartupGraph& graph, u32 phase_index) {
+        StartupPhase& phase = graph.phases[phase_index];
+
+        // Phases that depend on a failed phase could be missing what they need
+        if (graph.failed.load(std::memory_order_acquire)) {
+            phase.skipped = true;
+        } else {
+            TimePoint start_time = Time::now();
+            try {
+                phase.config.on_run();
+            } catch (...) {
+                std::lock_guard lock(graph.mutex);
+                if (!graph.exception) {
+                    graph.exception = std::current_exception();
+                }
+                graph.failed.store(true, std::memory_order_release);
+            }
+            TimePoint end_time = Time::now();
+            phase.start_ms = get_startup_ms(graph, start_time);
+            phase.duration_ms = get_startup_ms(graph, end_time) - phase.start_ms;
+        }
+
+        // Start every dependent phase whose last dependency just finished
+        for (u32 dependent_index : phase.dependents) {
+            if (graph.remaining_dependency_counts[dependent_index].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                submit_startup_phase(graph, dependent_index);
+            }
+        }
+
+        {
+            std::lock_guard lock(graph.mutex);
+            graph.finished_phase_count++;
+        }
+        graph.condition.notify_all();
+    }
+
+    void submit_startup_phase(StartupGraph& graph, u32 phase_index) {
+        // Without other workers the main thread runs every phase, in the order they become ready
+        if (graph.phases[phase_index].config.main_thread || graph.job_system->worker_count <= 1) {
+            {
+                std::lock_guard lock(graph.mutex);
+                graph.main_thread_phases.push_back(phase_index);
+            }
+            graph.condition.notify_all();
+            return;
+        }
+        StartupGraph* graph_ptr = &graph;
+        run_job(*graph.job_system, [graph_ptr, phase_index] {
+            run_startup_phase(*graph_ptr, phase_index);
+        }, &graph.running_phase_counter);
+    }
+
+    void log_startup_timings(const StartupGraph& graph, f64 total_ms) {
+        // Dependencies always come before the phases that depend on them, so a single pass in order finds the longest chain
+        std::vector<f64> path_lengths_ms(graph.phases.size(), 0.0);
+        f64 total_phase_ms = 0.0;
+        f64 critical_path_ms = 0.0;
+        for (u32 i = 0; i < graph.phases.size(); ++i) {
+            const StartupPhase& phase = graph.phases[i];
+            for (u32 dependency_index : phase.config.dependencies) {
+                path_lengths_ms[i] = std::max(path_lengths_ms[i], path_lengths_ms[dependency_index]);
+            }
+            path_lengths_ms[i] += phase.duration_ms;
+            total_phase_ms += phase.duration_ms;
+            critical_path_ms = std::max(critical_path_ms, path_lengths_ms[i]);
+        }
+
+        GM_LOG_INFO(
+            "Startup took [{:.3f} ms], total phase time [{:.3f} ms], critical path [{:.3f} ms], parallelism [{:.2f}]",
+            total_ms,
+            total_phase_ms,
+            critical_path_ms,
+            total_ms > 0.0 ? total_phase_ms / total_ms : 0.0
+        );
+
+        std::vector<const StartupPhase*> phases;
+        for (const StartupPhase& phase : graph.phases) {
+            phases.push_back(&phase);
+        }
+        std::sort(phases.begin(), phases.end(), [](const StartupPhase* a, const StartupPhase* b) {
+            return a->start_ms < b->start_ms;
+        });
+        for (const StartupPhase* phase : phases) {
+            if (phase->skipped) {
+                GM_LOG_INFO("  [{}] skipped", phase->config.name);
+                continue;
+            }
+            GM_LOG_INFO(
+                "  [{}] started at [{:.3f} ms], took [{:.3f} ms]{}",
+                phase->config.name,
+                phase->start_ms,
+                phase->duration_ms,
+                phase->config.main_thread ? " on the main thread" : ""
+            );
+        }
+    }
+
+    u32 add_startup_phase(StartupGraph& graph, const StartupPhaseConfig& config) {
+        if (!config.on_run) {
+            GM_THROW("Startup phase [" << config.name << "] does not have a run function");
+        }
+        u32 phase_index = (u32) graph.phases.size();
+        for (u32 dependency_index : config.dependencies) {
+            if (dependency_index >= phase_index) {
+                GM_THROW("Startup phase [" << config.name << "] depends on a phase that was not added before it");
+            }
+        }
+        graph.phases.push_back({
+            .config = config,
+        });
+        for (u32 dependency_index : config.dependencies) {
+            graph.phases[dependency_index].dependents.push_back(phase_index);
+        }
+        return phase_index;
+    }
+
+    void run_startup_graph(StartupGraph& graph, JobSystem& job_system) {
+        u32 phase_count = (u32) graph.phases.size();
+        graph.job_system = &job_system;
+        graph.start_time = Time::now();
+        graph.finished_phase_count = 0;
+        graph.remaining_dependency_counts = std::make_unique<std::atomic<u32>[]>(phase_count);
+        for (u32 i = 0; i < phase_count; ++i) {
+            graph.remaining_dependency_counts[i].store((u32) graph.phases[i].config.dependencies.size(), std::memory_order_relaxed);
+        }
+        for (u32 i = 0; i < phase_count; ++i) {
+            if (graph.phases[i].config.dependencies.empty()) {
+                submit_startup_phase(graph, i);
+            }
+        }
+
+        // The main thread runs its own phases as they become ready, and otherwise waits for the workers
+        {
+            std::unique_lock lock(graph.mutex);
+            while (graph.finished_phase_count < phase_count) {
+                graph.condition.wait(lock, [&graph, phase_count] {
+                    return !graph.main_thread_phases.empty() || graph.finished_phase_count == phase_count;
+                });
+                if (graph.main_thread_phases.empty()) {
+                    continue;
+                }
+                u32 phase_index = graph.main_thread_phases.front();
+                graph.main_thread_phases.pop_front();
+                lock.unlock();
+                run_startup_phase(graph, phase_index);
+                lock.lock();
+            }
+        }
+        // The jobs still touch the counter after their phase has finished
+        wait_for_counter(job_system, graph.running_phase_counter);
+
+        log_startup_timings(graph, get_startup_ms(graph, Time::now()));
+
+        if (graph.exception) {
+            std::rethrow_exception(graph.exception);
+        }
+    }
+}
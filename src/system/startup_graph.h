@@ -0,0 +1,63 @@
+#pragma once
+
+#include "system/job_system.h"
+#include "system/time.h"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+
+namespace Game {
+    struct StartupPhaseConfig {
+        std::string name = "Phase";
+
+        // Phases that must have finished before this one starts. They must have been added before it.
+        std::vector<u32> dependencies;
+
+        // Runs on the thread that runs the graph instead of on a worker, for work that the platform ties to the
+        // main thread, like creating the window.
+        bool main_thread = false;
+
+        std::function<void()> on_run;
+    };
+
+    struct StartupPhase {
+        StartupPhaseConfig config{};
+        std::vector<u32> dependents; // Phases that can only start after this one has finished
+        f64 start_ms = 0.0;          // Relative to the start of the graph
+        f64 duration_ms = 0.0;
+        bool skipped = false;        // Not run because an earlier phase failed
+    };
+
+    // Phases of startup that run on the job system as soon as the phases they depend on have finished, so that
+    // independent work like loading files, initializing the window and loading the Vulkan drivers overlaps.
+    struct StartupGraph {
+        std::vector<StartupPhase> phases;
+
+        // State used while the graph is running
+        std::unique_ptr<std::atomic<u32>[]> remaining_dependency_counts;
+        JobCounter running_phase_counter{};
+        JobSystem* job_system = nullptr;
+        TimePoint start_time{};
+        std::mutex mutex;
+        std::condition_variable condition;
+        std::deque<u32> main_thread_phases; // Ready to run on the main thread, guarded by the mutex
+        u32 finished_phase_count = 0;       // Guarded by the mutex
+        std::exception_ptr exception;       // Of the first phase that failed, guarded by the mutex
+        std::atomic<bool> failed = false;
+    };
+
+    u32 add_startup_phase(StartupGraph& graph, const StartupPhaseConfig& config);
+
+    // Runs every phase once and logs the wall time of each. Returns when every phase has finished. If a phase throws,
+    // the phases that have not started yet are skipped and the exception is rethrown once the running phases have finished.
+    void run_startup_graph(StartupGraph& graph, JobSystem& job_system);
+
+    // Runs a step of a phase on the calling thread and logs its wall time, for phases that are sequences of steps.
+    template<typename Function>
+    void run_startup_step(std::string_view name, const Function& function) {
+        TimePoint start_time = Time::now();
+        function();
+        GM_LOG_INFO("Startup step [{}] took [{:.3f} ms]", name, Time::as<Microseconds>(Time::now() - start_time).count() / 1000.0);
+    }
+}
@@ -1,48 +1,64 @@
 #include "event.h"
 
 namespace Game {
-    Event::Event(EventType type) : type(type), name(getName(type)) {
-    }
+    constexpr std::array<const char*, event_type_count> event_names = {
+        "None",
+        "KeyPressedEvent",
+        "KeyReleasedEvent",
+        "KeyRepeatedEvent",
+        "KeyTypedEvent",
+        "MouseMovedEvent",
+        "MouseScrolledEvent",
+        "MouseButtonPressedEvent",
+        "MouseButtonReleasedEvent",
+        "WindowCloseEvent",
+        "WindowMinimizeEvent",
+        "WindowResizeEvent",
+        "WindowFocusEvent",
+    };
 
-    std::string Event::toString() const {
-        std::stringstream ss;
-        ss << name << "{}";
-        return ss.str();
+    const char* get_event_name(EventType type) {
+        u32 index = (u32) type;
+        return index < event_type_count ? event_names[index] : "";
     }
 
-    std::string Event::getName(EventType eventType) {
-        switch (eventType) {
+    std::ostream& operator<<(std::ostream& os, const Event& event) {
+        os << get_event_name(event.type) << "{";
+        switch (event.type) {
             case EventType::KeyPressed:
-                return "KeyPressedEvent";
             case EventType::KeyReleased:
-                return "KeyReleasedEvent";
             case EventType::KeyRepeated:
-                return "KeyRepeatedEvent";
+                os << "key=" << get_key_name(event.key.key);
+                os << ", keyCode=" << event.key.key_code;
+                os << ", mods=" << event.key.mods;
+                os << ", scanCode=" << event.key.scan_code;
+                break;
             case EventType::KeyTyped:
-                return "KeyTypedEvent";
+                os << "codepoint=" << event.key_typed.codepoint;
+                break;
             case EventType::MouseMoved:
-                return "MouseMovedEvent";
+                os << "x=" << event.mouse_moved.x << ", y=" << event.mouse_moved.y;
+                break;
             case EventType::MouseScrolled:
-                return "MouseScrolledEvent";
+                os << "xOffset=" << event.mouse_scrolled.x_offset << ", yOffset=" << event.mouse_scrolled.y_offset;
+                break;
             case EventType::MouseButtonPressed:
-                return "MouseButtonPressedEvent";
             case EventType::MouseButtonReleased:
-                return "MouseButtonReleasedEvent";
-            case EventType::WindowClose:
-                return "WindowCloseEvent";
+                os << "button=" << event.mouse_button.button << ", mods=" << event.mouse_button.mods;
+                break;
             case EventType::WindowMinimize:
-                return "WindowMinimizeEvent";
+                os << "minimized=" << event.window_minimize.minimized;
+                break;
             case EventType::WindowResize:
-                return "WindowResizeEvent";
+                os << "width=" << event.window_resize.width << ", height=" << event.window_resize.height;
+                break;
+            case EventType::WindowFocus:
+                os << "focused=" << event.window_focus.focused;
+                break;
             default:
-                return "";
+                break;
         }
-    }
-}
-
-namespace Game {
-    std::ostream& operator<<(std::ostream& os, const Event& event) {
-        os << event.toString();
+        os << "}";
         return os;
     }
 }
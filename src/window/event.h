@@ -1,9 +1,12 @@
 #pragma once
 
-#include <string>
+#include "system/time.h"
+#include "window/key_event.h"
+#include "window/mouse_event.h"
+#include "window/window_event.h"
 
 namespace Game {
-    enum class EventType {
+    enum class EventType : u8 {
         None = 0,
         KeyPressed,
         KeyReleased,
@@ -11,35 +14,37 @@ namespace Game {
         KeyTyped,
         MouseMoved,
         MouseScrolled,
-        MouseButton,
         MouseButtonPressed,
         MouseButtonReleased,
         WindowClose,
         WindowMinimize,
         WindowResize,
+        WindowFocus,
+        Count,
     };
 
-    struct Event {
-    public:
-        EventType type;
-        std::string name;
-
-    protected:
-        explicit Event(EventType type);
-
-        virtual ~Event() = default;
+    constexpr u32 event_type_count = (u32) EventType::Count;
 
-    public:
-        virtual std::string toString() const;
+    // Events are small, trivially copyable values that are passed around and queued by value,
+    // the type selects which member of the payload union is valid.
+    struct Event {
+        EventType type = EventType::None;
+        TimePoint time{}; // When the event was polled from the window system
+        union {
+            KeyEvent key;                   // KeyPressed, KeyReleased, KeyRepeated
+            KeyTypedEvent key_typed;        // KeyTyped
+            MouseMovedEvent mouse_moved;    // MouseMoved
+            MouseScrolledEvent mouse_scrolled; // MouseScrolled
+            MouseButtonEvent mouse_button;  // MouseButtonPressed, MouseButtonReleased
+            WindowMinimizeEvent window_minimize; // WindowMinimize
+            WindowResizeEvent window_resize; // WindowResize
+            WindowFocusEvent window_focus;   // WindowFocus
+        };
+    };
 
-        static std::string getName(EventType eventType);
+    static_assert(std::is_trivially_copyable_v<Event>);
 
-        template<typename T>
-        T& as() const {
-            auto downcastedEvent = (T*) this;
-            return *downcastedEvent;
-        }
-    };
+    const char* get_event_name(EventType type);
 
     std::ostream& operator<<(std::ostream& os, const Event& event);
 }
@@ -0,0 +1,102 @@
+#include "event_dispatcher.h"
+
+namespace Game {
+    void insert_event_listener(EventDispatcher& dispatcher, EventType type, const EventListener& listener) {
+        std::vector<EventListener>& listeners = dispatcher.listeners[(u32) type];
+        auto position = std::upper_bound(listeners.begin(), listeners.end(), listener.priority, [](i32 priority, const EventListener& listener) {
+            return priority > listener.priority;
+        });
+        listeners.insert(position, listener);
+    }
+
+    void erase_event_listener(EventDispatcher& dispatcher, EventType type, const EventListener& removed_listener) {
+        std::erase_if(dispatcher.listeners[(u32) type], [&removed_listener](const EventListener& listener) {
+            return listener.function == removed_listener.function && listener.user_data == removed_listener.user_data;
+        });
+    }
+
+    // Applied in the order they were made, so that removing a listener that was added during the dispatch removes it
+    void apply_pending_listener_changes(EventDispatcher& dispatcher) {
+        for (const EventListenerChange& change : dispatcher.pending_listener_changes) {
+            if (change.removed) {
+                erase_event_listener(dispatcher, change.type, change.listener);
+            } else {
+                insert_event_listener(dispatcher, change.type, change.listener);
+            }
+        }
+        dispatcher.pending_listener_changes.clear();
+    }
+
+    void change_event_listener(EventDispatcher& dispatcher, const EventListenerChange& change) {
+        dispatcher.pending_listener_changes.push_back(change);
+        if (dispatcher.dispatch_depth == 0) {
+            apply_pending_listener_changes(dispatcher);
+        }
+    }
+
+    void add_event_listener(EventDispatcher& dispatcher, EventType type, EventListenerFunction function, void* user_data, i32 priority) {
+        if (function == nullptr) {
+            GM_THROW("Could not add listener for [" << get_event_name(type) << "] without a function");
+        }
+        if ((u32) type >= event_type_count) {
+            GM_THROW("Could not add listener for invalid event type [" << (u32) type << "]");
+        }
+        change_event_listener(dispatcher, {
+            .type = type,
+            .listener = {
+                .function = function,
+                .user_data = user_data,
+                .priority = priority,
+            },
+        });
+    }
+
+    void remove_event_listener(EventDispatcher& dispatcher, EventType type, EventListenerFunction function, void* user_data) {
+        if ((u32) type >= event_type_count) {
+            GM_THROW("Could not remove listener for invalid event type [" << (u32) type << "]");
+        }
+        change_event_listener(dispatcher, {
+            .type = type,
+            .listener = {
+                .function = function,
+                .user_data = user_data,
+            },
+            .removed = true,
+        });
+    }
+
+    bool dispatch_event(EventDispatcher& dispatcher, const Event& event) {
+        bool consumed = false;
+        dispatcher.dispatch_depth++;
+        try {
+            for (const EventListener& listener : dispatcher.listeners[(u32) event.type]) {
+                if (listener.function(listener.user_data, event)) {
+                    consumed = true;
+                    break;
+                }
+            }
+        } catch (...) {
+            dispatcher.dispatch_depth--;
+            throw;
+        }
+        dispatcher.dispatch_depth--;
+
+        if (dispatcher.dispatch_depth == 0 && !dispatcher.pending_listener_changes.empty()) {
+            apply_pending_listener_changes(dispatcher);
+        }
+        return consumed;
+    }
+
+    void queue_event(EventDispatcher& dispatcher, const Event& event) {
+        dispatcher.queued_events.push_back(event);
+    }
+
+    void dispatch_queued_events(EventDispatcher& dispatcher) {
+        // Swap the queues so that listeners can queue new events while the batch is being dispatched
+        std::swap(dispatcher.queued_events, dispatcher.dispatching_events);
+        for (const Event& event : dispatcher.dispatching_events) {
+            dispatch_event(dispatcher, event);
+        }
+        dispatcher.dispatching_events.clear();
+    }
+}
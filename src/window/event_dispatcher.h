@@ -0,0 +1,49 @@
+#pragma once
+
+#include "window/event.h"
+
+namespace Game {
+    // Returns true if the event was consumed, which stops it from reaching listeners with lower priority.
+    typedef bool (*EventListenerFunction)(void* user_data, const Event& event);
+
+    struct EventListener {
+        EventListenerFunction function = nullptr;
+        void* user_data = nullptr;
+        i32 priority = 0;
+    };
+
+    // Adding or removing a listener while an event is being dispatched
+    struct EventListenerChange {
+        EventType type = EventType::None;
+        EventListener listener{};
+        bool removed = false;
+    };
+
+    // Listeners are registered per event type and sorted by priority, so dispatching an event only visits
+    // the listeners for its type. Queued events are dispatched in a batch once per frame, and the queues keep
+    // their capacity, so dispatching doesn't allocate after the first few frames.
+    struct EventDispatcher {
+        std::array<std::vector<EventListener>, event_type_count> listeners;
+        std::vector<Event> queued_events;
+        std::vector<Event> dispatching_events;
+
+        // Listeners that add or remove listeners would change the list that is being iterated, so their changes
+        // are kept here until the outermost dispatch returns
+        u32 dispatch_depth = 0;
+        std::vector<EventListenerChange> pending_listener_changes;
+    };
+
+    // Listeners with higher priority are called first, listeners with the same priority in the order they were added.
+    // Listeners can be added and removed by listeners, which takes effect once the event has been dispatched.
+    void add_event_listener(EventDispatcher& dispatcher, EventType type, EventListenerFunction function, void* user_data = nullptr, i32 priority = 0);
+
+    void remove_event_listener(EventDispatcher& dispatcher, EventType type, EventListenerFunction function, void* user_data = nullptr);
+
+    // Dispatches the event to its listeners right away. Returns true if a listener consumed it.
+    bool dispatch_event(EventDispatcher& dispatcher, const Event& event);
+
+    void queue_event(EventDispatcher& dispatcher, const Event& event);
+
+    // Dispatches all queued events. Events queued by the listeners are dispatched in the next batch.
+    void dispatch_queued_events(EventDispatcher& dispatcher);
+}
@@ -0,0 +1,89 @@
+#include "input.h"
+
+namespace Game {
+    void create_input_state(InputState& input) {
+        input.keys_by_scan_code.fill(Key::None);
+        for (const KeyInfo& key_info : key_infos) {
+            i32 scan_code = glfwGetKeyScancode((i32) key_info.key);
+            if (scan_code >= 0 && scan_code < (i32) max_scan_code_count) {
+                input.keys_by_scan_code[scan_code] = key_info.key;
+            }
+        }
+    }
+
+    void begin_input_tick(InputState& input) {
+        input.keys_pressed.reset();
+        input.keys_released.reset();
+        input.mouse_buttons_pressed.reset();
+        input.mouse_buttons_released.reset();
+        input.mouse_delta_x = 0.0;
+        input.mouse_delta_y = 0.0;
+        input.scroll_x = 0.0;
+        input.scroll_y = 0.0;
+    }
+
+    void apply_input_event(InputState& input, const Event& event) {
+        switch (event.type) {
+            case EventType::KeyPressed:
+            case EventType::KeyReleased: {
+                // Unknown keys are reported as GLFW_KEY_UNKNOWN (-1)
+                if (event.key.key_code < 0 || event.key.key_code >= (i32) key_count) {
+                    break;
+                }
+                bool pressed = event.type == EventType::KeyPressed;
+                input.keys_down[event.key.key_code] = pressed;
+                if (pressed) {
+                    input.keys_pressed[event.key.key_code] = true;
+                } else {
+                    input.keys_released[event.key.key_code] = true;
+                }
+                break;
+            }
+            case EventType::MouseButtonPressed:
+            case EventType::MouseButtonReleased: {
+                if (event.mouse_button.button < 0 || event.mouse_button.button >= (i32) mouse_button_count) {
+                    break;
+                }
+                bool pressed = event.type == EventType::MouseButtonPressed;
+                input.mouse_buttons_down[event.mouse_button.button] = pressed;
+                if (pressed) {
+                    input.mouse_buttons_pressed[event.mouse_button.button] = true;
+                } else {
+                    input.mouse_buttons_released[event.mouse_button.button] = true;
+                }
+                break;
+            }
+            case EventType::MouseMoved: {
+                // The first position has nothing to be relative to, so it doesn't count as movement
+                if (input.mouse_position_known) {
+                    input.mouse_delta_x += event.mouse_moved.x - input.mouse_x;
+                    input.mouse_delta_y += event.mouse_moved.y - input.mouse_y;
+                }
+                input.mouse_x = event.mouse_moved.x;
+                input.mouse_y = event.mouse_moved.y;
+                input.mouse_position_known = true;
+                break;
+            }
+            case EventType::MouseScrolled: {
+                input.scroll_x += event.mouse_scrolled.x_offset;
+                input.scroll_y += event.mouse_scrolled.y_offset;
+                break;
+            }
+            case EventType::WindowFocus: {
+                // The window gets no release events for keys and buttons let go while it is not focused, so they would
+                // stay down until pressed again. Release them all, and forget the cursor so that it doesn't jump when
+                // the window gets the focus back.
+                if (!event.window_focus.focused) {
+                    input.keys_released |= input.keys_down;
+                    input.keys_down.reset();
+                    input.mouse_buttons_released |= input.mouse_buttons_down;
+                    input.mouse_buttons_down.reset();
+                    input.mouse_position_known = false;
+                }
+                break;
+            }
+            default:
+                break;
+        }
+    }
+}
@@ -0,0 +1,68 @@
+#pragma once
+
+#include "window/event.h"
+
+#include <bitset>
+
+namespace Game {
+    constexpr u32 max_scan_code_count = 512;
+
+    // Keyboard and mouse state as of the current update tick. Game code polls this every tick instead of
+    // listening for events. Pressed and released are kept separately from down, so that a key that is pressed
+    // and released within the same tick still reports the press.
+    struct InputState {
+        std::bitset<key_count> keys_down;
+        std::bitset<key_count> keys_pressed;
+        std::bitset<key_count> keys_released;
+
+        std::bitset<mouse_button_count> mouse_buttons_down;
+        std::bitset<mouse_button_count> mouse_buttons_pressed;
+        std::bitset<mouse_button_count> mouse_buttons_released;
+
+        f64 mouse_x = 0.0;
+        f64 mouse_y = 0.0;
+        f64 mouse_delta_x = 0.0;
+        f64 mouse_delta_y = 0.0;
+        f64 scroll_x = 0.0;
+        f64 scroll_y = 0.0;
+        bool mouse_position_known = false;
+
+        // Scan codes are platform-specific and only known at runtime, so this table is filled in when the input is created
+        std::array<Key, max_scan_code_count> keys_by_scan_code{};
+    };
+
+    void create_input_state(InputState& input);
+
+    // Clears the per-tick state (pressed, released, deltas) before the events of the next tick are applied.
+    void begin_input_tick(InputState& input);
+
+    void apply_input_event(InputState& input, const Event& event);
+
+    inline bool is_key_down(const InputState& input, Key key) {
+        return input.keys_down[(u32) key];
+    }
+
+    inline bool was_key_pressed(const InputState& input, Key key) {
+        return input.keys_pressed[(u32) key];
+    }
+
+    inline bool was_key_released(const InputState& input, Key key) {
+        return input.keys_released[(u32) key];
+    }
+
+    inline bool is_mouse_button_down(const InputState& input, MouseButton button) {
+        return input.mouse_buttons_down[(u32) button];
+    }
+
+    inline bool was_mouse_button_pressed(const InputState& input, MouseButton button) {
+        return input.mouse_buttons_pressed[(u32) button];
+    }
+
+    inline bool was_mouse_button_released(const InputState& input, MouseButton button) {
+        return input.mouse_buttons_released[(u32) button];
+    }
+
+    inline Key get_key_by_scan_code(const InputState& input, i32 scan_code) {
+        return scan_code >= 0 && scan_code < (i32) max_scan_code_count ? input.keys_by_scan_code[scan_code] : Key::None;
+    }
+}
@@ -1,44 +1,16 @@
 #pragma once
 
-#include "event.h"
-#include "keyboard.h"
+#include "window/keyboard.h"
 
 namespace Game {
-    struct KeyEvent : Event {
-    public:
+    struct KeyEvent {
         Key key;
-        int32_t keyCode;
-        int32_t mods;
-        int32_t scanCode;
-
-        KeyEvent(EventType type, int32_t keyCode, int32_t mods, int32_t scanCode);
-
-        std::string toString() const override;
+        i32 key_code;
+        i32 mods;
+        i32 scan_code;
     };
 
-    std::ostream& operator<<(std::ostream& os, const KeyEvent& event);
-}
-
-namespace Game {
-    struct KeyPressedEvent final : KeyEvent {
-        explicit KeyPressedEvent(int32_t key, int32_t mods, int32_t scanCode);
-    };
-}
-
-namespace Game {
-    struct KeyReleasedEvent final : KeyEvent {
-        explicit KeyReleasedEvent(int32_t key, int32_t mods, int32_t scanCode);
-    };
-}
-
-namespace Game {
-    struct KeyRepeatedEvent final : KeyEvent {
-        explicit KeyRepeatedEvent(int32_t key, int32_t mods, int32_t scanCode);
-    };
-}
-
-namespace Game {
-    struct KeyTypedEvent final : KeyEvent {
-        explicit KeyTypedEvent(int32_t key, int32_t mods, int32_t scanCode);
+    struct KeyTypedEvent {
+        u32 codepoint;
     };
 }
@@ -1,6 +1,7 @@
 #pragma once
 
-#include "window.h"
+#include <array>
+#include <string_view>
 
 namespace Game {
     enum class Key {
@@ -74,45 +75,113 @@ namespace Game {
         Right = GLFW_KEY_RIGHT,
     };
 
-    struct KeyboardConfig {
-        Window* window = nullptr;
+    enum class MouseButton {
+        Left = GLFW_MOUSE_BUTTON_LEFT,
+        Right = GLFW_MOUSE_BUTTON_RIGHT,
+        Middle = GLFW_MOUSE_BUTTON_MIDDLE,
     };
 
-    class Keyboard {
-    private:
-        KeyboardConfig config;
-        std::vector<Key> keys;
-        std::unordered_map<std::string, Key> keysByName;
-        std::unordered_map<Key, std::string> namesByKey;
+    constexpr u32 key_count = GLFW_KEY_LAST + 1;
+    constexpr u32 mouse_button_count = GLFW_MOUSE_BUTTON_LAST + 1;
 
-    public:
-        explicit Keyboard(const KeyboardConfig& config);
-
-        const std::vector<Key>& getKeys() const;
-
-        const std::unordered_map<std::string, Key>& getKeysByName() const;
-
-        std::unordered_map<Key, std::string> getNamesByKey() const;
-
-        bool isPressed(Key key) const;
-
-        bool isPressed(uint16_t key) const;
-
-        bool isPressed(const std::string& keyName) const;
-
-        std::string getName(Key key) const;
-
-        std::string getName(uint16_t key) const;
-
-        static std::string getKeyName(Key key);
-
-        static std::string getKeyName(uint16_t key);
-
-    private:
-        static std::vector<Key> createKeys();
-
-        static std::unordered_map<std::string, Key> createKeysByName();
+    struct KeyInfo {
+        Key key = Key::None;
+        const char* name = "";
+    };
 
-        static std::unordered_map<Key, std::string> createNamesByKey();
+    constexpr std::array key_infos = {
+        KeyInfo{Key::A, "A"},
+        KeyInfo{Key::B, "B"},
+        KeyInfo{Key::C, "C"},
+        KeyInfo{Key::D, "D"},
+        KeyInfo{Key::E, "E"},
+        KeyInfo{Key::F, "F"},
+        KeyInfo{Key::G, "G"},
+        KeyInfo{Key::H, "H"},
+        KeyInfo{Key::I, "I"},
+        KeyInfo{Key::J, "J"},
+        KeyInfo{Key::K, "K"},
+        KeyInfo{Key::L, "L"},
+        KeyInfo{Key::M, "M"},
+        KeyInfo{Key::N, "N"},
+        KeyInfo{Key::O, "O"},
+        KeyInfo{Key::P, "P"},
+        KeyInfo{Key::Q, "Q"},
+        KeyInfo{Key::R, "R"},
+        KeyInfo{Key::S, "S"},
+        KeyInfo{Key::T, "T"},
+        KeyInfo{Key::U, "U"},
+        KeyInfo{Key::V, "V"},
+        KeyInfo{Key::W, "W"},
+        KeyInfo{Key::X, "X"},
+        KeyInfo{Key::Y, "Y"},
+        KeyInfo{Key::Z, "Z"},
+        KeyInfo{Key::Num_0, "Num_0"},
+        KeyInfo{Key::Num_1, "Num_1"},
+        KeyInfo{Key::Num_2, "Num_2"},
+        KeyInfo{Key::Num_3, "Num_3"},
+        KeyInfo{Key::Num_4, "Num_4"},
+        KeyInfo{Key::Num_5, "Num_5"},
+        KeyInfo{Key::Num_6, "Num_6"},
+        KeyInfo{Key::Num_7, "Num_7"},
+        KeyInfo{Key::Num_8, "Num_8"},
+        KeyInfo{Key::Num_9, "Num_9"},
+        KeyInfo{Key::Numpad_0, "Numpad_0"},
+        KeyInfo{Key::Numpad_1, "Numpad_1"},
+        KeyInfo{Key::Numpad_2, "Numpad_2"},
+        KeyInfo{Key::Numpad_3, "Numpad_3"},
+        KeyInfo{Key::Numpad_4, "Numpad_4"},
+        KeyInfo{Key::Numpad_5, "Numpad_5"},
+        KeyInfo{Key::Numpad_6, "Numpad_6"},
+        KeyInfo{Key::Numpad_7, "Numpad_7"},
+        KeyInfo{Key::Numpad_8, "Numpad_8"},
+        KeyInfo{Key::Numpad_9, "Numpad_9"},
+        KeyInfo{Key::F1, "F1"},
+        KeyInfo{Key::F2, "F2"},
+        KeyInfo{Key::F3, "F3"},
+        KeyInfo{Key::F4, "F4"},
+        KeyInfo{Key::F5, "F5"},
+        KeyInfo{Key::F6, "F6"},
+        KeyInfo{Key::F7, "F7"},
+        KeyInfo{Key::F8, "F8"},
+        KeyInfo{Key::F9, "F9"},
+        KeyInfo{Key::F10, "F10"},
+        KeyInfo{Key::F11, "F11"},
+        KeyInfo{Key::F12, "F12"},
+        KeyInfo{Key::Space, "Space"},
+        KeyInfo{Key::Escape, "Escape"},
+        KeyInfo{Key::Enter, "Enter"},
+        KeyInfo{Key::Tab, "Tab"},
+        KeyInfo{Key::Backspace, "Backspace"},
+        KeyInfo{Key::Up, "Up"},
+        KeyInfo{Key::Down, "Down"},
+        KeyInfo{Key::Left, "Left"},
+        KeyInfo{Key::Right, "Right"},
     };
+
+    // Key names indexed by key code, built at compile time from the key infos.
+    constexpr std::array<const char*, key_count> key_names = [] {
+        std::array<const char*, key_count> names{};
+        names.fill("");
+        for (const KeyInfo& key_info : key_infos) {
+            names[(u32) key_info.key] = key_info.name;
+        }
+        return names;
+    }();
+
+    constexpr const char* get_key_name(Key key) {
+        u32 key_code = (u32) key;
+        return key_code < key_count ? key_names[key_code] : "";
+    }
+
+    constexpr Key get_key_by_name(std::string_view name) {
+        for (const KeyInfo& key_info : key_infos) {
+            if (name == key_info.name) {
+                return key_info.key;
+            }
+        }
+        return Key::None;
+    }
+
+    static_assert(get_key_by_name(get_key_name(Key::Escape)) == Key::Escape);
 }
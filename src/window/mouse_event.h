@@ -0,0 +1,18 @@
+#pragma once
+
+namespace Game {
+    struct MouseMovedEvent {
+        f64 x;
+        f64 y;
+    };
+
+    struct MouseScrolledEvent {
+        f64 x_offset;
+        f64 y_offset;
+    };
+
+    struct MouseButtonEvent {
+        i32 button;
+        i32 mods;
+    };
+}
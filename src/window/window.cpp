@@ -1,40 +1,127 @@
 #include "window.h"
-#include "key_event.h"
-#include "window_event.h"
 
 #include <GLFW/glfw3.h>
 
+#include "system/flight_recorder.h"
+
 namespace Game {
     void on_glfw_error(i32 error, const char* description) {
         std::cerr << "GLFW error: [" << error << "]" << description << std::endl;
     }
 
-    void on_glfw_event(Event& event, GLFWwindow* glfw_window) {
+    void on_glfw_event(Event event, GLFWwindow* glfw_window) {
+        auto window = (Window*) glfwGetWindowUserPointer(glfw_window);
+        if (window != nullptr && window->event_dispatcher != nullptr) {
+            event.time = Time::now();
+            queue_event(*window->event_dispatcher, event);
+        }
+    }
+
+    // Input callbacks only timestamp the event and push it to the input queue, handling it is left to the update ticks.
+    // GLFW runs the callbacks from glfwPollEvents and doesn't pass on when the OS received the event, so the time is
+    // when the event was polled, on the same clock as the game loop.
+    void on_glfw_input_event(Event event, GLFWwindow* glfw_window) {
         auto window = (Window*) glfwGetWindowUserPointer(glfw_window);
-        window->on_event(event);
+        event.time = Time::now();
+        if (!push_spsc_queue(window->input_queue, event)) {
+            window->dropped_input_event_count.fetch_add(1, std::memory_order_relaxed);
+        }
     }
 
     void window_close_callback(GLFWwindow* glfw_window) {
-        WindowCloseEvent event{};
-        on_glfw_event(event, glfw_window);
+        on_glfw_event(Event{
+            .type = EventType::WindowClose,
+        }, glfw_window);
+    }
+
+    void window_iconify_callback(GLFWwindow* glfw_window, i32 iconified) {
+        on_glfw_event(Event{
+            .type = EventType::WindowMinimize,
+            .window_minimize = {
+                .minimized = iconified == GLFW_TRUE,
+            },
+        }, glfw_window);
     }
 
     void key_callback(GLFWwindow* glfw_window, i32 key, i32 scan_code, i32 action, i32 mods) {
+        EventType type;
         if (action == GLFW_PRESS) {
-            KeyPressedEvent event(key, mods, scan_code);
-            on_glfw_event(event, glfw_window);
+            type = EventType::KeyPressed;
         } else if (action == GLFW_RELEASE) {
-            KeyReleasedEvent event(key, mods, scan_code);
-            on_glfw_event(event, glfw_window);
+            type = EventType::KeyReleased;
         } else if (action == GLFW_REPEAT) {
-            KeyRepeatedEvent event(key, mods, scan_code);
-            on_glfw_event(event, glfw_window);
+            type = EventType::KeyRepeated;
+        } else {
+            return;
         }
+        on_glfw_input_event(Event{
+            .type = type,
+            .key = {
+                .key = (Key) key,
+                .key_code = key,
+                .mods = mods,
+                .scan_code = scan_code,
+            },
+        }, glfw_window);
+    }
+
+    void char_callback(GLFWwindow* glfw_window, u32 codepoint) {
+        on_glfw_input_event(Event{
+            .type = EventType::KeyTyped,
+            .key_typed = {
+                .codepoint = codepoint,
+            },
+        }, glfw_window);
+    }
+
+    void cursor_position_callback(GLFWwindow* glfw_window, f64 x, f64 y) {
+        on_glfw_input_event(Event{
+            .type = EventType::MouseMoved,
+            .mouse_moved = {
+                .x = x,
+                .y = y,
+            },
+        }, glfw_window);
+    }
+
+    void scroll_callback(GLFWwindow* glfw_window, f64 x_offset, f64 y_offset) {
+        on_glfw_input_event(Event{
+            .type = EventType::MouseScrolled,
+            .mouse_scrolled = {
+                .x_offset = x_offset,
+                .y_offset = y_offset,
+            },
+        }, glfw_window);
+    }
+
+    void mouse_button_callback(GLFWwindow* glfw_window, i32 button, i32 action, i32 mods) {
+        on_glfw_input_event(Event{
+            .type = action == GLFW_PRESS ? EventType::MouseButtonPressed : EventType::MouseButtonReleased,
+            .mouse_button = {
+                .button = button,
+                .mods = mods,
+            },
+        }, glfw_window);
+    }
+
+    // Goes through the input queue, so that it is ordered with the key and mouse events around it
+    void window_focus_callback(GLFWwindow* glfw_window, i32 focused) {
+        on_glfw_input_event(Event{
+            .type = EventType::WindowFocus,
+            .window_focus = {
+                .focused = focused == GLFW_TRUE,
+            },
+        }, glfw_window);
     }
 
     void framebuffer_size_callback(GLFWwindow* glfw_window, i32 width, i32 height) {
-        WindowResizeEvent event(width, height);
-        on_glfw_event(event, glfw_window);
+        on_glfw_event(Event{
+            .type = EventType::WindowResize,
+            .window_resize = {
+                .width = width,
+                .height = height,
+            },
+        }, glfw_window);
     }
 
     void create_window(Window& window, const WindowConfig& config) {
@@ -44,6 +131,8 @@ namespace Game {
 
         glfwSetErrorCallback(on_glfw_error);
 
+        create_input_state(window.input);
+
         glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API);
         glfwWindowHint(GLFW_RESIZABLE, config.resizable);
         glfwWindowHint(GLFW_MAXIMIZED, config.maximized);
@@ -61,9 +150,17 @@ namespace Game {
             GM_THROW("Could not create GLFW window");
         }
 
+        glfwSetWindowUserPointer(window.glfw_window, &window);
+
         glfwSetFramebufferSizeCallback(window.glfw_window, framebuffer_size_callback);
         glfwSetKeyCallback(window.glfw_window, key_callback);
+        glfwSetCharCallback(window.glfw_window, char_callback);
+        glfwSetCursorPosCallback(window.glfw_window, cursor_position_callback);
+        glfwSetScrollCallback(window.glfw_window, scroll_callback);
+        glfwSetMouseButtonCallback(window.glfw_window, mouse_button_callback);
         glfwSetWindowCloseCallback(window.glfw_window, window_close_callback);
+        glfwSetWindowIconifyCallback(window.glfw_window, window_iconify_callback);
+        glfwSetWindowFocusCallback(window.glfw_window, window_focus_callback);
     }
 
     void destroy_window(const Window& window) {
@@ -71,9 +168,50 @@ namespace Game {
         glfwTerminate();
     }
 
-    void set_window_event_listener(Window& window, const std::function<void(Event&)>& on_event) {
-        window.on_event = on_event;
-        glfwSetWindowUserPointer(window, &window);
+    void set_window_event_dispatcher(Window& window, EventDispatcher* event_dispatcher) {
+        window.event_dispatcher = event_dispatcher;
+    }
+
+    // Keeps the identifying part of the payload in the flight recorder
+    void record_input_event(const Event& event) {
+        switch (event.type) {
+            case EventType::KeyPressed:
+            case EventType::KeyReleased:
+            case EventType::KeyRepeated:
+                record_flight_input(get_event_name(event.type), event.key.key_code, event.key.mods);
+                break;
+            case EventType::KeyTyped:
+                record_flight_input(get_event_name(event.type), event.key_typed.codepoint, 0);
+                break;
+            case EventType::MouseMoved:
+                // A moving mouse reports every poll, it would push everything else out of the ring
+                break;
+            case EventType::MouseScrolled:
+                record_flight_input(get_event_name(event.type), (i64) event.mouse_scrolled.x_offset, (i64) event.mouse_scrolled.y_offset);
+                break;
+            case EventType::MouseButtonPressed:
+            case EventType::MouseButtonReleased:
+                record_flight_input(get_event_name(event.type), event.mouse_button.button, event.mouse_button.mods);
+                break;
+            default:
+                record_flight_input(get_event_name(event.type), 0, 0);
+                break;
+        }
+    }
+
+    void update_window_input(Window& window, TimePoint end_time) {
+        begin_input_tick(window.input);
+        while (const Event* event = peek_spsc_queue(window.input_queue)) {
+            if (event->time >= end_time) {
+                break;
+            }
+            apply_input_event(window.input, *event);
+            record_input_event(*event);
+            if (window.event_dispatcher != nullptr) {
+                dispatch_event(*window.event_dispatcher, *event);
+            }
+            pop_spsc_queue(window.input_queue);
+        }
     }
 
     WindowSize get_window_size(const Window& window) {
@@ -104,4 +242,17 @@ namespace Game {
     bool is_window_iconified(const Window& window) {
         return glfwGetWindowAttrib(window.glfw_window, GLFW_ICONIFIED) == 1;
     }
-}
+
+    bool is_window_focused(const Window& window) {
+        return glfwGetWindowAttrib(window.glfw_window, GLFW_FOCUSED) == 1;
+    }
+
+    i32 get_window_refresh_rate(const Window& window) {
+        GLFWmonitor* monitor = glfwGetWindowMonitor(window.glfw_window);
+        if (monitor == nullptr) {
+            monitor = glfwGetPrimaryMonitor();
+        }
+        const GLFWvidmode* video_mode = monitor != nullptr ? glfwGetVideoMode(monitor) : nullptr;
+        return video_mode != nullptr ? video_mode->refreshRate : 0;
+    }
+}
\ No newline at end of file
@@ -1,6 +1,8 @@
 #pragma once
 
-#include "window/event.h"
+#include "system/spsc_queue.h"
+#include "window/event_dispatcher.h"
+#include "window/input.h"
 
 namespace Game {
     struct WindowConfig {
@@ -11,9 +13,19 @@ namespace Game {
         bool resizable = true;
     };
 
+    constexpr u32 window_input_queue_capacity = 1024;
+
     struct Window {
         GLFWwindow* glfw_window = nullptr;
-        std::function<void(Event&)> on_event;
+        EventDispatcher* event_dispatcher = nullptr;
+
+        // Keyboard, mouse and focus events are timestamped and queued by the window callbacks, and dispatched by the
+        // first update tick after they were polled. Events that don't fit in the queue are dropped and counted.
+        SpscQueue<Event, window_input_queue_capacity> input_queue{};
+        std::atomic<u64> dropped_input_event_count = 0;
+
+        // Keyboard and mouse state as of the last update tick
+        InputState input{};
 
         operator GLFWwindow*() const {
             return glfw_window;
@@ -24,7 +36,12 @@ namespace Game {
 
     void destroy_window(const Window& window);
 
-    void set_window_event_listener(Window& window, const std::function<void(Event&)>& on_event);
+    // Window events are queued to the dispatcher while polling, and dispatched when the dispatcher flushes its queue.
+    void set_window_event_dispatcher(Window& window, EventDispatcher* event_dispatcher);
+
+    // Advances the input state to the given time. The queued input events that were polled before it are applied to the
+    // input state and dispatched in the order they happened, called once at the start of every update tick.
+    void update_window_input(Window& window, TimePoint end_time);
 
     struct WindowSize {
         i32 width = 0;
@@ -36,4 +53,9 @@ namespace Game {
     void get_window_size(const Window& window, i32* width, i32* height);
 
     bool is_window_iconified(const Window& window);
+
+    bool is_window_focused(const Window& window);
+
+    // Refresh rate of the monitor the window is on, or the primary monitor for windowed mode.
+    i32 get_window_refresh_rate(const Window& window);
 }
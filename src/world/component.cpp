@@ -0,0 +1,19 @@
+#include "component.h"
+
+namespace Game {
+    std::array<ComponentInfo, max_component_types> component_infos{};
+    std::atomic<u32> component_count = 0;
+
+    u32 register_component(const ComponentInfo& info) {
+        u32 component_id = component_count.fetch_add(1, std::memory_order_relaxed);
+        if (component_id >= max_component_types) {
+            GM_THROW("Could not register component [" << info.name << "], max component type count [" << max_component_types << "] exceeded");
+        }
+        component_infos[component_id] = info;
+        return component_id;
+    }
+
+    const ComponentInfo& get_component_info(u32 component_id) {
+        return component_infos[component_id];
+    }
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <atomic>
+#include <typeinfo>
+
+namespace Game {
+    // Components are plain data that is moved around with memcpy when entities change archetype,
+    // which keeps the storage free of per-type move/destroy callbacks.
+    constexpr u32 max_component_types = 64;
+
+    typedef u64 ComponentMask;
+
+    struct ComponentInfo {
+        u32 size = 0;
+        u32 alignment = 0;
+        const char* name = "";
+    };
+
+    u32 register_component(const ComponentInfo& info);
+
+    const ComponentInfo& get_component_info(u32 component_id);
+
+    template<typename T>
+    u32 get_component_id() {
+        static_assert(std::is_trivially_copyable_v<T>, "Components must be trivially copyable");
+        static const u32 component_id = register_component({
+            .size = sizeof(T),
+            .alignment = alignof(T),
+            .name = typeid(T).name(),
+        });
+        return component_id;
+    }
+
+    template<typename... Components>
+    ComponentMask get_component_mask() {
+        return ((ComponentMask(1) << get_component_id<Components>()) | ... | ComponentMask(0));
+    }
+}
@@ -0,0 +1,170 @@
+#include "system_scheduler.h"
+
+namespace Game {
+    // Weight of the latest sample in the rolling average of system timings.
+    constexpr f64 timing_average_weight = 0.05;
+
+    bool has_conflicting_access(const SystemConfig& a, const SystemConfig& b) {
+        if (a.exclusive || b.exclusive) {
+            return true;
+        }
+        return (a.writes & (b.reads | b.writes)) != 0 || (b.writes & a.reads) != 0;
+    }
+
+    // Builds the dependency graph of the enabled systems. When two systems conflict, the one that was added first
+    // runs first, which keeps the order of systems that touch the same data deterministic.
+    void build_system_graph(SystemScheduler& scheduler) {
+        u32 system_count = (u32) scheduler.systems.size();
+        for (SystemNode& system : scheduler.systems) {
+            system.dependents.clear();
+            system.dependency_count = 0;
+        }
+        for (u32 i = 0; i < system_count; ++i) {
+            SystemNode& system = scheduler.systems[i];
+            if (!system.enabled) {
+                continue;
+            }
+            for (u32 j = i + 1; j < system_count; ++j) {
+                SystemNode& later_system = scheduler.systems[j];
+                if (later_system.enabled && has_conflicting_access(system.config, later_system.config)) {
+                    system.dependents.push_back(j);
+                    later_system.dependency_count++;
+                }
+            }
+        }
+        scheduler.remaining_dependency_counts = std::make_unique<std::atomic<u32>[]>(system_count);
+        scheduler.path_lengths_ms.resize(system_count);
+        scheduler.graph_dirty = false;
+    }
+
+    void submit_system(SystemScheduler& scheduler, u32 system_index);
+
+    void run_system(SystemScheduler& scheduler, u32 system_index) {
+        SystemNode& system = scheduler.systems[system_index];
+
+        TimePoint start_time = Time::now();
+        system.config.on_update(*scheduler.world, *scheduler.job_system, scheduler.timestep);
+        f64 duration_ms = Time::as<Microseconds>(Time::now() - start_time).count() / 1000.0;
+
+        SystemTiming& timing = system.timing;
+        timing.last_ms = duration_ms;
+        timing.average_ms = timing.average_ms == 0.0 ? duration_ms : timing.average_ms + (duration_ms - timing.average_ms) * timing_average_weight;
+        timing.max_ms = std::max(timing.max_ms, duration_ms);
+
+        // Start every dependent system whose last dependency just finished
+        for (u32 dependent_index : system.dependents) {
+            if (scheduler.remaining_dependency_counts[dependent_index].fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                submit_system(scheduler, dependent_index);
+            }
+        }
+    }
+
+    void submit_system(SystemScheduler& scheduler, u32 system_index) {
+        SystemScheduler* scheduler_ptr = &scheduler;
+        run_job(*scheduler.job_system, [scheduler_ptr, system_index] {
+            run_system(*scheduler_ptr, system_index);
+        }, &scheduler.running_system_counter);
+    }
+
+    void update_scheduler_stats(SystemScheduler& scheduler) {
+        SystemSchedulerStats& stats = scheduler.stats;
+        stats.tick_ms = Time::as<Microseconds>(Time::now() - scheduler.tick_start_time).count() / 1000.0;
+        stats.total_system_ms = 0.0;
+        stats.critical_path_ms = 0.0;
+
+        // Dependents always come after the system they depend on, so a single pass in order finds the longest chain.
+        std::vector<f64>& path_lengths_ms = scheduler.path_lengths_ms;
+        std::fill(path_lengths_ms.begin(), path_lengths_ms.end(), 0.0);
+        for (u32 i = 0; i < scheduler.systems.size(); ++i) {
+            const SystemNode& system = scheduler.systems[i];
+            if (!system.enabled) {
+                continue;
+            }
+            path_lengths_ms[i] += system.timing.last_ms;
+            stats.total_system_ms += system.timing.last_ms;
+            stats.critical_path_ms = std::max(stats.critical_path_ms, path_lengths_ms[i]);
+            for (u32 dependent_index : system.dependents) {
+                path_lengths_ms[dependent_index] = std::max(path_lengths_ms[dependent_index], path_lengths_ms[i]);
+            }
+        }
+        stats.parallelism = stats.tick_ms > 0.0 ? stats.total_system_ms / stats.tick_ms : 0.0;
+    }
+
+    u32 add_system(SystemScheduler& scheduler, const SystemConfig& config) {
+        if (!config.on_update) {
+            GM_THROW("System [" << config.name << "] does not have an update function");
+        }
+        scheduler.systems.push_back({
+            .config = config,
+        });
+        scheduler.graph_dirty = true;
+        return (u32) scheduler.systems.size() - 1;
+    }
+
+    void set_system_enabled(SystemScheduler& scheduler, u32 system_index, bool enabled) {
+        SystemNode& system = scheduler.systems.at(system_index);
+        if (system.enabled != enabled) {
+            system.enabled = enabled;
+            scheduler.graph_dirty = true;
+        }
+    }
+
+    void run_systems(SystemScheduler& scheduler, World& world, JobSystem& job_system, f64 timestep) {
+        if (scheduler.graph_dirty) {
+            build_system_graph(scheduler);
+        }
+
+        scheduler.world = &world;
+        scheduler.job_system = &job_system;
+        scheduler.timestep = timestep;
+        scheduler.tick_start_time = Time::now();
+
+        u32 system_count = (u32) scheduler.systems.size();
+        for (u32 i = 0; i < system_count; ++i) {
+            scheduler.remaining_dependency_counts[i].store(scheduler.systems[i].dependency_count, std::memory_order_relaxed);
+        }
+        for (u32 i = 0; i < system_count; ++i) {
+            const SystemNode& system = scheduler.systems[i];
+            if (system.enabled && system.dependency_count == 0) {
+                submit_system(scheduler, i);
+            }
+        }
+        wait_for_counter(job_system, scheduler.running_system_counter);
+
+        update_scheduler_stats(scheduler);
+    }
+
+    void log_system_timings(const SystemScheduler& scheduler) {
+        const SystemSchedulerStats& stats = scheduler.stats;
+        f64 budget_ms = scheduler.timestep * 1000.0;
+        GM_LOG_INFO(
+            "Systems took [{:.3f} ms] ({:.1f}% of {:.2f} ms budget), total system time [{:.3f} ms], critical path [{:.3f} ms], parallelism [{:.2f}]",
+            stats.tick_ms,
+            stats.tick_ms / budget_ms * 100.0,
+            budget_ms,
+            stats.total_system_ms,
+            stats.critical_path_ms,
+            stats.parallelism
+        );
+
+        std::vector<const SystemNode*> systems;
+        for (const SystemNode& system : scheduler.systems) {
+            systems.push_back(&system);
+        }
+        std::sort(systems.begin(), systems.end(), [](const SystemNode* a, const SystemNode* b) {
+            return a->timing.average_ms > b->timing.average_ms;
+        });
+        for (const SystemNode* system : systems) {
+            const SystemTiming& timing = system->timing;
+            GM_LOG_INFO(
+                "  [{}] last [{:.3f} ms], average [{:.3f} ms] ({:.1f}% of budget), max [{:.3f} ms]{}",
+                system->config.name,
+                timing.last_ms,
+                timing.average_ms,
+                timing.average_ms / budget_ms * 100.0,
+                timing.max_ms,
+                system->enabled ? "" : " (disabled)"
+            );
+        }
+    }
+}
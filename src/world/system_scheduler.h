@@ -0,0 +1,70 @@
+#pragma once
+
+#include "world/world.h"
+#include "system/job_system.h"
+#include "system/time.h"
+
+namespace Game {
+    struct SystemConfig {
+        std::string name = "System";
+
+        // Components the system reads and writes. Systems that don't write anything the other reads or writes
+        // are independent and may run at the same time on different workers.
+        ComponentMask reads = 0;
+        ComponentMask writes = 0;
+
+        // Exclusive systems run alone, which is required when a system creates or destroys entities or
+        // adds or removes components (structural changes move entities between chunks).
+        bool exclusive = false;
+
+        std::function<void(World& world, JobSystem& job_system, f64 timestep)> on_update;
+    };
+
+    struct SystemTiming {
+        f64 last_ms = 0.0;
+        f64 average_ms = 0.0;
+        f64 max_ms = 0.0;
+    };
+
+    struct SystemNode {
+        SystemConfig config{};
+        bool enabled = true;
+        std::vector<u32> dependents; // Systems that can only start after this one has finished
+        u32 dependency_count = 0;
+        SystemTiming timing{};
+    };
+
+    struct SystemSchedulerStats {
+        f64 tick_ms = 0.0;          // Wall time of the last tick
+        f64 total_system_ms = 0.0;  // Sum of the time spent in all systems during the last tick
+        f64 critical_path_ms = 0.0; // Longest chain of dependent systems during the last tick
+        f64 parallelism = 0.0;      // Average number of systems running at the same time during the last tick
+    };
+
+    struct SystemScheduler {
+        std::vector<SystemNode> systems;
+        bool graph_dirty = true;
+
+        // Per-tick state used while the systems are running
+        std::unique_ptr<std::atomic<u32>[]> remaining_dependency_counts;
+        std::vector<f64> path_lengths_ms;
+        JobCounter running_system_counter{};
+        World* world = nullptr;
+        JobSystem* job_system = nullptr;
+        f64 timestep = 0.0;
+        TimePoint tick_start_time{};
+
+        SystemSchedulerStats stats{};
+    };
+
+    u32 add_system(SystemScheduler& scheduler, const SystemConfig& config);
+
+    void set_system_enabled(SystemScheduler& scheduler, u32 system_index, bool enabled);
+
+    // Runs all enabled systems once. Systems with conflicting access run in the order they were added,
+    // all other systems run concurrently on the job system. Returns when every system has finished.
+    void run_systems(SystemScheduler& scheduler, World& world, JobSystem& job_system, f64 timestep);
+
+    // Logs the timings of the last tick and of every system, relative to the timestep of the last tick.
+    void log_system_timings(const SystemScheduler& scheduler);
+}
@@ -0,0 +1,46 @@
+#include "transform.h"
+
+#include <cmath>
+
+namespace Game {
+    Transform interpolate_transform(const Transform& previous, const Transform& current, f32 alpha) {
+        // Blend the rotation along the shortest arc, so that wrapping around doesn't make the entity spin backwards
+        constexpr f32 pi = std::numbers::pi_v<f32>;
+        f32 rotation_delta = std::remainder(current.rotation - previous.rotation, 2.0f * pi);
+        return {
+            .x = std::lerp(previous.x, current.x, alpha),
+            .y = std::lerp(previous.y, current.y, alpha),
+            .rotation = previous.rotation + rotation_delta * alpha,
+            .scale = std::lerp(previous.scale, current.scale, alpha),
+        };
+    }
+
+    void teleport_transform(World& world, Entity entity, const Transform& transform) {
+        *get_component<Transform>(world, entity) = transform;
+        get_component<PreviousTransform>(world, entity)->transform = transform;
+    }
+
+    u32 add_transform_snapshot_system(SystemScheduler& scheduler) {
+        return add_system(scheduler, {
+            .name = "TransformSnapshot",
+            .reads = get_component_mask<Transform>(),
+            .writes = get_component_mask<PreviousTransform>(),
+            .on_update = [](World& world, JobSystem& job_system, f64) {
+                parallel_for_each_chunk<Transform, PreviousTransform>(world, job_system, [](u32 count, Transform* transforms, PreviousTransform* previous_transforms) {
+                    for (u32 i = 0; i < count; ++i) {
+                        previous_transforms[i].transform = transforms[i];
+                    }
+                });
+            },
+        });
+    }
+
+    void get_interpolated_transforms(World& world, f32 alpha, std::vector<Transform>& transforms) {
+        transforms.clear();
+        for_each_chunk<Transform, PreviousTransform>(world, [&transforms, alpha](u32 count, Transform* current_transforms, PreviousTransform* previous_transforms) {
+            for (u32 i = 0; i < count; ++i) {
+                transforms.push_back(interpolate_transform(previous_transforms[i].transform, current_transforms[i], alpha));
+            }
+        });
+    }
+}
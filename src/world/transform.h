@@ -0,0 +1,33 @@
+#pragma once
+
+#include "world/system_scheduler.h"
+#include "world/world.h"
+
+namespace Game {
+    // Layout matches the push constant block of the triangle vertex shader.
+    struct Transform {
+        f32 x = 0.0f;
+        f32 y = 0.0f;
+        f32 rotation = 0.0f; // Radians
+        f32 scale = 1.0f;
+    };
+
+    // The transform at the end of the previous tick. The renderer blends from this to the current transform
+    // with the leftover fraction of a tick, so that motion is smooth at any display rate.
+    struct PreviousTransform {
+        Transform transform{};
+    };
+
+    Transform interpolate_transform(const Transform& previous, const Transform& current, f32 alpha);
+
+    // Sets both the current and previous transform, so that the entity jumps to the new transform
+    // instead of being interpolated towards it.
+    void teleport_transform(World& world, Entity entity, const Transform& transform);
+
+    // Adds the system that copies the current transforms to the previous transforms at the start of every tick.
+    // Must be added before any system that writes transforms.
+    u32 add_transform_snapshot_system(SystemScheduler& scheduler);
+
+    // Collects the interpolated transforms of all entities that have both a current and previous transform.
+    void get_interpolated_transforms(World& world, f32 alpha, std::vector<Transform>& transforms);
+}
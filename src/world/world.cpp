@@ -0,0 +1,247 @@
+#include "world.h"
+
+namespace Game {
+    u32 align_up(u32 value, u32 alignment) {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+
+    //
+    // Archetypes
+    //
+
+    // Finds the largest number of entities per chunk where the entity column and all component columns,
+    // each aligned to a cache line, fit within the chunk.
+    void compute_chunk_layout(Archetype& archetype) {
+        u32 bytes_per_entity = sizeof(Entity);
+        for (u32 component_id : archetype.component_ids) {
+            const ComponentInfo& component_info = get_component_info(component_id);
+            if (component_info.alignment > world_column_alignment) {
+                GM_THROW("Component [" << component_info.name << "] alignment [" << component_info.alignment << "] exceeds column alignment [" << world_column_alignment << "]");
+            }
+            bytes_per_entity += component_info.size;
+        }
+
+        u32 capacity = world_chunk_size / bytes_per_entity;
+        while (capacity > 0) {
+            u32 offset = align_up(capacity * sizeof(Entity), world_column_alignment);
+            for (u32 component_id : archetype.component_ids) {
+                archetype.column_offsets[component_id] = offset;
+                offset = align_up(offset + capacity * get_component_info(component_id).size, world_column_alignment);
+            }
+            if (offset <= world_chunk_size) {
+                break;
+            }
+            capacity--;
+        }
+        if (capacity == 0) {
+            GM_THROW("Archetype components do not fit in a chunk of [" << world_chunk_size << "] bytes");
+        }
+        archetype.chunk_capacity = capacity;
+    }
+
+    Archetype& get_or_create_archetype(World& world, ComponentMask mask) {
+        auto iterator = world.archetypes_by_mask.find(mask);
+        if (iterator != world.archetypes_by_mask.end()) {
+            return *iterator->second;
+        }
+
+        auto archetype = std::make_unique<Archetype>();
+        archetype->mask = mask;
+        for (u32 component_id = 0; component_id < max_component_types; ++component_id) {
+            if (mask & (ComponentMask(1) << component_id)) {
+                archetype->component_ids.push_back(component_id);
+            }
+        }
+        compute_chunk_layout(*archetype);
+
+        Archetype* archetype_ptr = archetype.get();
+        world.archetypes.push_back(std::move(archetype));
+        world.archetypes_by_mask[mask] = archetype_ptr;
+        return *archetype_ptr;
+    }
+
+    //
+    // Rows
+    //
+
+    void copy_row(const WorldChunk& source_chunk, u32 source_row, WorldChunk& destination_chunk, u32 destination_row, u32 component_id) {
+        u32 size = get_component_info(component_id).size;
+        const u8* source = source_chunk.data->bytes + source_chunk.archetype->column_offsets[component_id] + source_row * size;
+        u8* destination = destination_chunk.data->bytes + destination_chunk.archetype->column_offsets[component_id] + destination_row * size;
+        std::memcpy(destination, source, size);
+    }
+
+    // Appends a row to the last chunk of the archetype, creating a new chunk if the last one is full.
+    void allocate_row(Archetype& archetype, Entity entity, u32* chunk_index, u32* row) {
+        if (archetype.chunks.empty() || archetype.chunks.back()->count == archetype.chunk_capacity) {
+            auto chunk = std::make_unique<WorldChunk>();
+            chunk->archetype = &archetype;
+            chunk->data = std::unique_ptr<WorldChunkData>(new WorldChunkData); // Skip zero-initializing the whole chunk
+            archetype.chunks.push_back(std::move(chunk));
+        }
+        WorldChunk& chunk = *archetype.chunks.back();
+        *chunk_index = (u32) archetype.chunks.size() - 1;
+        *row = chunk.count++;
+        archetype.entity_count++;
+
+        auto entities = reinterpret_cast<Entity*>(chunk.data->bytes);
+        entities[*row] = entity;
+    }
+
+    // Removes a row by moving the last row of the archetype into its place, which keeps every chunk but the last one full.
+    void remove_row(World& world, Archetype& archetype, u32 chunk_index, u32 row) {
+        WorldChunk& chunk = *archetype.chunks[chunk_index];
+        WorldChunk& last_chunk = *archetype.chunks.back();
+        u32 last_chunk_index = (u32) archetype.chunks.size() - 1;
+        u32 last_row = last_chunk.count - 1;
+
+        if (chunk_index != last_chunk_index || row != last_row) {
+            auto entities = reinterpret_cast<Entity*>(chunk.data->bytes);
+            auto last_entities = reinterpret_cast<Entity*>(last_chunk.data->bytes);
+            Entity moved_entity = last_entities[last_row];
+            entities[row] = moved_entity;
+            for (u32 component_id : archetype.component_ids) {
+                copy_row(last_chunk, last_row, chunk, row, component_id);
+            }
+            EntityRecord& moved_record = world.entities[moved_entity.index];
+            moved_record.chunk_index = chunk_index;
+            moved_record.row = row;
+        }
+
+        last_chunk.count--;
+        archetype.entity_count--;
+        if (last_chunk.count == 0) {
+            archetype.chunks.pop_back();
+        }
+    }
+
+    void move_entity(World& world, Entity entity, ComponentMask mask) {
+        EntityRecord& record = world.entities[entity.index];
+        Archetype& source_archetype = *record.archetype;
+        Archetype& destination_archetype = get_or_create_archetype(world, mask);
+
+        u32 chunk_index = 0;
+        u32 row = 0;
+        allocate_row(destination_archetype, entity, &chunk_index, &row);
+
+        const WorldChunk& source_chunk = *source_archetype.chunks[record.chunk_index];
+        WorldChunk& destination_chunk = *destination_archetype.chunks[chunk_index];
+        for (u32 component_id : destination_archetype.component_ids) {
+            if (source_archetype.mask & (ComponentMask(1) << component_id)) {
+                copy_row(source_chunk, record.row, destination_chunk, row, component_id);
+            } else {
+                u32 size = get_component_info(component_id).size;
+                std::memset(destination_chunk.data->bytes + destination_archetype.column_offsets[component_id] + row * size, 0, size);
+            }
+        }
+
+        remove_row(world, source_archetype, record.chunk_index, record.row);
+
+        record.archetype = &destination_archetype;
+        record.chunk_index = chunk_index;
+        record.row = row;
+    }
+
+    EntityRecord& get_entity_record(World& world, Entity entity) {
+        if (!is_entity_alive(world, entity)) {
+            GM_THROW("Entity [" << entity.index << ":" << entity.generation << "] is not alive");
+        }
+        return world.entities[entity.index];
+    }
+
+    //
+    // Entities
+    //
+
+    Entity create_entity(World& world, ComponentMask mask) {
+        Entity entity{};
+        if (!world.free_entity_indices.empty()) {
+            entity.index = world.free_entity_indices.back();
+            world.free_entity_indices.pop_back();
+        } else {
+            entity.index = (u32) world.entities.size();
+            world.entities.emplace_back();
+        }
+
+        EntityRecord& record = world.entities[entity.index];
+        entity.generation = record.generation;
+
+        Archetype& archetype = get_or_create_archetype(world, mask);
+        allocate_row(archetype, entity, &record.chunk_index, &record.row);
+        record.archetype = &archetype;
+
+        WorldChunk& chunk = *archetype.chunks[record.chunk_index];
+        for (u32 component_id : archetype.component_ids) {
+            u32 size = get_component_info(component_id).size;
+            std::memset(chunk.data->bytes + archetype.column_offsets[component_id] + record.row * size, 0, size);
+        }
+        return entity;
+    }
+
+    void destroy_entity(World& world, Entity entity) {
+        EntityRecord& record = get_entity_record(world, entity);
+        remove_row(world, *record.archetype, record.chunk_index, record.row);
+        record.archetype = nullptr;
+        record.generation++;
+        world.free_entity_indices.push_back(entity.index);
+    }
+
+    bool is_entity_alive(const World& world, Entity entity) {
+        if (entity.index >= world.entities.size()) {
+            return false;
+        }
+        const EntityRecord& record = world.entities[entity.index];
+        return record.archetype != nullptr && record.generation == entity.generation;
+    }
+
+    u32 get_entity_count(const World& world) {
+        return (u32) (world.entities.size() - world.free_entity_indices.size());
+    }
+
+    //
+    // Components
+    //
+
+    void* get_component(World& world, Entity entity, u32 component_id) {
+        EntityRecord& record = get_entity_record(world, entity);
+        const Archetype& archetype = *record.archetype;
+        if (!(archetype.mask & (ComponentMask(1) << component_id))) {
+            return nullptr;
+        }
+        const WorldChunk& chunk = *archetype.chunks[record.chunk_index];
+        u32 size = get_component_info(component_id).size;
+        return chunk.data->bytes + archetype.column_offsets[component_id] + record.row * size;
+    }
+
+    void add_component(World& world, Entity entity, u32 component_id, const void* value) {
+        EntityRecord& record = get_entity_record(world, entity);
+        ComponentMask component_bit = ComponentMask(1) << component_id;
+        if (!(record.archetype->mask & component_bit)) {
+            move_entity(world, entity, record.archetype->mask | component_bit);
+        }
+        std::memcpy(get_component(world, entity, component_id), value, get_component_info(component_id).size);
+    }
+
+    void remove_component(World& world, Entity entity, u32 component_id) {
+        EntityRecord& record = get_entity_record(world, entity);
+        ComponentMask component_bit = ComponentMask(1) << component_id;
+        if (record.archetype->mask & component_bit) {
+            move_entity(world, entity, record.archetype->mask & ~component_bit);
+        }
+    }
+
+    //
+    // Queries
+    //
+
+    void get_matching_chunks(World& world, ComponentMask mask, std::vector<WorldChunk*>& chunks) {
+        for (const std::unique_ptr<Archetype>& archetype : world.archetypes) {
+            if ((archetype->mask & mask) != mask) {
+                continue;
+            }
+            for (const std::unique_ptr<WorldChunk>& chunk : archetype->chunks) {
+                chunks.push_back(chunk.get());
+            }
+        }
+    }
+}
@@ -0,0 +1,168 @@
+#pragma once
+
+#include "world/component.h"
+#include "system/job_system.h"
+
+#include <array>
+#include <memory>
+#include <unordered_map>
+
+namespace Game {
+    struct Entity {
+        u32 index = UINT32_MAX;
+        u32 generation = 0;
+
+        bool operator==(const Entity& other) const = default;
+    };
+
+    // Entities with the same set of components (an archetype) are stored together in fixed-size chunks.
+    // Each chunk is laid out as a structure of arrays, one column per component, where every column starts on a
+    // cache line so that iterating a column is a linear, SIMD-friendly walk over contiguous memory.
+    constexpr u32 world_chunk_size = 16 * 1024;
+    constexpr u32 world_column_alignment = 64;
+
+    struct alignas(world_column_alignment) WorldChunkData {
+        u8 bytes[world_chunk_size];
+    };
+
+    struct Archetype;
+
+    struct WorldChunk {
+        Archetype* archetype = nullptr;
+        std::unique_ptr<WorldChunkData> data;
+        u32 count = 0;
+    };
+
+    struct Archetype {
+        ComponentMask mask = 0;
+        std::vector<u32> component_ids;
+        std::array<u32, max_component_types> column_offsets{}; // Indexed by component ID
+        u32 chunk_capacity = 0;
+        u32 entity_count = 0;
+
+        // All chunks are full except the last one. Removing an entity moves the very last entity into its slot.
+        std::vector<std::unique_ptr<WorldChunk>> chunks;
+    };
+
+    struct EntityRecord {
+        Archetype* archetype = nullptr;
+        u32 chunk_index = 0;
+        u32 row = 0;
+        u32 generation = 0;
+    };
+
+    struct World {
+        std::vector<EntityRecord> entities;
+        std::vector<u32> free_entity_indices;
+        std::vector<std::unique_ptr<Archetype>> archetypes;
+        std::unordered_map<ComponentMask, Archetype*> archetypes_by_mask;
+    };
+
+    // Creates an entity with zero-initialized components.
+    Entity create_entity(World& world, ComponentMask mask);
+
+    void destroy_entity(World& world, Entity entity);
+
+    bool is_entity_alive(const World& world, Entity entity);
+
+    u32 get_entity_count(const World& world);
+
+    void* get_component(World& world, Entity entity, u32 component_id);
+
+    void add_component(World& world, Entity entity, u32 component_id, const void* value);
+
+    void remove_component(World& world, Entity entity, u32 component_id);
+
+    // Collects all chunks with entities that have (at least) the components in the given mask.
+    void get_matching_chunks(World& world, ComponentMask mask, std::vector<WorldChunk*>& chunks);
+
+    inline const Entity* get_chunk_entities(const WorldChunk& chunk) {
+        return reinterpret_cast<const Entity*>(chunk.data->bytes);
+    }
+
+    template<typename T>
+    T* get_chunk_column(const WorldChunk& chunk) {
+        u32 column_offset = chunk.archetype->column_offsets[get_component_id<T>()];
+        return std::assume_aligned<world_column_alignment>(reinterpret_cast<T*>(chunk.data->bytes + column_offset));
+    }
+
+    template<typename... Components>
+    Entity create_entity(World& world, const Components&... components) {
+        Entity entity = create_entity(world, get_component_mask<Components...>());
+        ((*static_cast<Components*>(get_component(world, entity, get_component_id<Components>())) = components), ...);
+        return entity;
+    }
+
+    template<typename T>
+    T* get_component(World& world, Entity entity) {
+        return static_cast<T*>(get_component(world, entity, get_component_id<T>()));
+    }
+
+    template<typename T>
+    void add_component(World& world, Entity entity, const T& component) {
+        add_component(world, entity, get_component_id<T>(), &component);
+    }
+
+    template<typename T>
+    void remove_component(World& world, Entity entity) {
+        remove_component(world, entity, get_component_id<T>());
+    }
+
+    // Calls `function(count, columns...)` once per chunk with the requested component columns.
+    template<typename... Components, typename Function>
+    void for_each_chunk(World& world, const Function& function) {
+        ComponentMask mask = get_component_mask<Components...>();
+        for (const std::unique_ptr<Archetype>& archetype : world.archetypes) {
+            if ((archetype->mask & mask) != mask) {
+                continue;
+            }
+            for (const std::unique_ptr<WorldChunk>& chunk : archetype->chunks) {
+                function(chunk->count, get_chunk_column<Components>(*chunk)...);
+            }
+        }
+    }
+
+    // Calls `function(components&...)` once per entity with the requested components.
+    template<typename... Components, typename Function>
+    void for_each(World& world, const Function& function) {
+        for_each_chunk<Components...>(world, [&function](u32 count, Components*... columns) {
+            for (u32 i = 0; i < count; ++i) {
+                function(columns[i]...);
+            }
+        });
+    }
+
+    // Same as `for_each_chunk`, but the chunks are distributed over the job system workers.
+    // The function must not add or remove entities or components while the query is running.
+    template<typename... Components, typename Function>
+    void parallel_for_each_chunk(World& world, JobSystem& job_system, const Function& function) {
+        ComponentMask mask = get_component_mask<Components...>();
+        u32 chunk_count = 0;
+        for (const std::unique_ptr<Archetype>& archetype : world.archetypes) {
+            if ((archetype->mask & mask) == mask) {
+                chunk_count += (u32) archetype->chunks.size();
+            }
+        }
+
+        // The matching chunks are numbered in archetype order, and every batch walks the archetypes to find its range.
+        // Queries run every tick, often from several systems at once, so this doesn't collect the chunks into a list.
+        u32 chunks_per_job = 1;
+        parallel_for(job_system, chunk_count, chunks_per_job, [&world, mask, &function](u32 begin, u32 end) {
+            u32 archetype_begin = 0;
+            for (const std::unique_ptr<Archetype>& archetype : world.archetypes) {
+                if (begin == end) {
+                    break;
+                }
+                if ((archetype->mask & mask) != mask) {
+                    continue;
+                }
+                u32 archetype_end = archetype_begin + (u32) archetype->chunks.size();
+                for (; begin < std::min(end, archetype_end); ++begin) {
+                    const WorldChunk& chunk = *archetype->chunks[begin - archetype_begin];
+                    function(chunk.count, get_chunk_column<Components>(chunk)...);
+                }
+                archetype_begin = archetype_end;
+            }
+        });
+    }
+}
@@ -0,0 +1,153 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "system/asset_archive_format.h"
+#include "system/lz4.h"
+
+// Packs every file in a directory into an asset archive.
+//
+// Usage: AssetPacker <input directory> <output file>
+
+namespace Game {
+    struct PackedAsset {
+        std::string path;
+        AssetArchiveEntry entry{};
+        std::vector<u8> data;
+    };
+
+    // Only keep the compressed data when it saves at least this fraction of the size, otherwise decompressing
+    // costs more load time than reading the extra bytes.
+    constexpr f64 min_compression_saving = 0.1;
+
+    void write_padding(std::ofstream& file, u64& offset) {
+        constexpr char zeros[asset_archive_alignment] = {};
+        u64 padding = (asset_archive_alignment - offset % asset_archive_alignment) % asset_archive_alignment;
+        file.write(zeros, (std::streamsize) padding);
+        offset += padding;
+    }
+
+    int pack_assets(const std::filesystem::path& input_directory, const std::filesystem::path& output_path) {
+        if (!std::filesystem::is_directory(input_directory)) {
+            std::cerr << "Could not find input directory [" << input_directory.string() << "]" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        std::vector<PackedAsset> assets;
+        for (const std::filesystem::directory_entry& directory_entry : std::filesystem::recursive_directory_iterator(input_directory)) {
+            if (!directory_entry.is_regular_file()) {
+                continue;
+            }
+            PackedAsset& asset = assets.emplace_back();
+            asset.path = std::filesystem::relative(directory_entry.path(), input_directory).generic_string();
+
+            std::ifstream file(directory_entry.path(), std::ios::binary);
+            asset.data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+            if (!file.good() && !file.eof()) {
+                std::cerr << "Could not read [" << directory_entry.path().string() << "]" << std::endl;
+                return EXIT_FAILURE;
+            }
+
+            asset.entry.path_hash = get_asset_path_hash(asset.path);
+            asset.entry.uncompressed_size = asset.data.size();
+            asset.entry.compression = AssetCompression::None;
+
+            if (!asset.data.empty() && asset.data.size() <= max_lz4_input_size) {
+                std::vector<u8> compressed;
+                compress_lz4(asset.data, compressed);
+
+                // A block that doesn't decompress back to the asset would only fail once the asset is loaded
+                std::vector<u8> decompressed(asset.data.size());
+                if (!decompress_lz4(compressed, decompressed) || decompressed != asset.data) {
+                    std::cerr << "Could not compress [" << asset.path << "], the compressed block doesn't decompress back to it" << std::endl;
+                    return EXIT_FAILURE;
+                }
+                if ((f64) compressed.size() <= (f64) asset.data.size() * (1.0 - min_compression_saving)) {
+                    asset.data = std::move(compressed);
+                    asset.entry.compression = AssetCompression::Lz4;
+                }
+            }
+            asset.entry.size = asset.data.size();
+        }
+
+        std::sort(assets.begin(), assets.end(), [](const PackedAsset& a, const PackedAsset& b) {
+            return a.entry.path_hash < b.entry.path_hash;
+        });
+        for (u32 i = 1; i < assets.size(); ++i) {
+            if (assets[i - 1].entry.path_hash == assets[i].entry.path_hash) {
+                std::cerr << "Paths [" << assets[i - 1].path << "] and [" << assets[i].path << "] have the same hash, rename one of them" << std::endl;
+                return EXIT_FAILURE;
+            }
+        }
+
+        // Write to a temporary file, so that a failed pack never leaves a truncated archive behind
+        std::filesystem::path temporary_path = output_path;
+        temporary_path += ".tmp";
+        if (output_path.has_parent_path()) {
+            std::filesystem::create_directories(output_path.parent_path());
+        }
+        std::ofstream file(temporary_path, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            std::cerr << "Could not open [" << temporary_path.string() << "]" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        AssetArchiveHeader header{};
+        std::memcpy(header.magic, asset_archive_magic, sizeof(asset_archive_magic));
+        header.entry_count = (u32) assets.size();
+        file.write((const char*) &header, sizeof(AssetArchiveHeader));
+        u64 offset = sizeof(AssetArchiveHeader);
+
+        std::string string_table;
+        u64 uncompressed_size = 0;
+        for (PackedAsset& asset : assets) {
+            write_padding(file, offset);
+            asset.entry.offset = offset;
+            file.write((const char*) asset.data.data(), (std::streamsize) asset.data.size());
+            offset += asset.data.size();
+
+            asset.entry.path_offset = (u32) string_table.size();
+            asset.entry.path_size = (u32) asset.path.size();
+            string_table += asset.path;
+            uncompressed_size += asset.entry.uncompressed_size;
+        }
+
+        write_padding(file, offset);
+        header.index_offset = offset;
+        for (const PackedAsset& asset : assets) {
+            file.write((const char*) &asset.entry, sizeof(AssetArchiveEntry));
+            offset += sizeof(AssetArchiveEntry);
+        }
+
+        header.string_table_offset = offset;
+        header.string_table_size = string_table.size();
+        file.write(string_table.data(), (std::streamsize) string_table.size());
+        offset += string_table.size();
+
+        file.seekp(0);
+        file.write((const char*) &header, sizeof(AssetArchiveHeader));
+        file.close();
+        if (!file) {
+            std::cerr << "Could not write [" << temporary_path.string() << "]" << std::endl;
+            return EXIT_FAILURE;
+        }
+        std::filesystem::rename(temporary_path, output_path);
+
+        std::cout << "Packed [" << assets.size() << "] assets of [" << uncompressed_size << "] bytes into [" << output_path.string() << "] of [" << offset << "] bytes" << std::endl;
+        return EXIT_SUCCESS;
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc != 3) {
+        std::cerr << "Usage: " << argv[0] << " <input directory> <output file>" << std::endl;
+        return EXIT_FAILURE;
+    }
+    return Game::pack_assets(argv[1], argv[2]);
+}
@@ -0,0 +1,256 @@
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "system/binary_log_format.h"
+
+// Decodes a binary log written by GM_BINARY_LOG into text, formatting every record with the format string of its site.
+//
+// Usage: BinaryLogDecoder <file>
+
+namespace Game {
+    struct BinaryLogSite {
+        u32 line_number = 0;
+        u8 level = 0;
+        std::vector<BinaryLogArgType> arg_types;
+        std::string format;
+        std::string file_name;
+        std::string function_name;
+    };
+
+    struct BinaryLogLine {
+        i64 time_ns = 0;
+        u32 thread_index = 0;
+        std::string text;
+    };
+
+    // Same order as the spdlog levels
+    constexpr const char* binary_log_level_names[] = {"trace", "debug", "info", "warning", "error", "critical", "off"};
+
+    template<typename T>
+    T read_value(const u8* bytes) {
+        T value;
+        std::memcpy(&value, bytes, sizeof(T));
+        return value;
+    }
+
+    std::string format_binary_log_arg(std::string_view spec, BinaryLogArgType type, const u8*& bytes, const u8* end) {
+        if (type == BinaryLogArgType::String) {
+            if (end - bytes < (std::ptrdiff_t) sizeof(u32)) {
+                return "<truncated>";
+            }
+            u32 size = read_value<u32>(bytes);
+            bytes += sizeof(u32);
+            if (end - bytes < (std::ptrdiff_t) size) {
+                return "<truncated>";
+            }
+            std::string_view value((const char*) bytes, size);
+            bytes += size;
+            return std::vformat(spec, std::make_format_args(value));
+        }
+        if (end - bytes < (std::ptrdiff_t) sizeof(u64)) {
+            return "<truncated>";
+        }
+        u64 bits = read_value<u64>(bytes);
+        bytes += sizeof(u64);
+        switch (type) {
+            case BinaryLogArgType::I64: {
+                i64 value = (i64) bits;
+                return std::vformat(spec, std::make_format_args(value));
+            }
+            case BinaryLogArgType::U64:
+                return std::vformat(spec, std::make_format_args(bits));
+            case BinaryLogArgType::F64: {
+                f64 value = std::bit_cast<f64>(bits);
+                return std::vformat(spec, std::make_format_args(value));
+            }
+            case BinaryLogArgType::Bool: {
+                bool value = bits != 0;
+                return std::vformat(spec, std::make_format_args(value));
+            }
+            case BinaryLogArgType::Char: {
+                char value = (char) bits;
+                return std::vformat(spec, std::make_format_args(value));
+            }
+            case BinaryLogArgType::Pointer: {
+                const void* value = (const void*) (uintptr_t) bits;
+                return std::vformat(spec, std::make_format_args(value));
+            }
+            default:
+                return "<unknown>";
+        }
+    }
+
+    // Replaces every replacement field of the format string with the next argument, one std::vformat call per field,
+    // since the argument types are only known at runtime.
+    std::string format_binary_log_record(const BinaryLogSite& site, const u8* bytes, const u8* end) {
+        std::string message;
+        const std::string& format = site.format;
+        u32 arg_index = 0;
+        for (size_t i = 0; i < format.size(); ++i) {
+            char c = format[i];
+            if ((c == '{' || c == '}') && i + 1 < format.size() && format[i + 1] == c) {
+                message += c;
+                ++i;
+                continue;
+            }
+            if (c != '{') {
+                message += c;
+                continue;
+            }
+            size_t field_end = format.find('}', i);
+            if (field_end == std::string::npos || arg_index >= site.arg_types.size()) {
+                message += format.substr(i);
+                break;
+            }
+            std::string spec = "{" + format.substr(i + 1, field_end - i - 1) + "}";
+            try {
+                message += format_binary_log_arg(spec, site.arg_types[arg_index], bytes, end);
+            } catch (const std::format_error& e) {
+                message += std::format("<{}>", e.what());
+            }
+            ++arg_index;
+            i = field_end;
+        }
+        return message;
+    }
+
+    std::string format_binary_log_time(i64 time_ns) {
+        std::chrono::sys_time<std::chrono::nanoseconds> time{std::chrono::nanoseconds(time_ns)};
+        return std::format("{:%Y-%m-%d %H:%M:%S}", std::chrono::floor<std::chrono::microseconds>(time));
+    }
+
+    void decode_records(const std::unordered_map<u64, BinaryLogSite>& sites, u32 thread_index, const u8* bytes, const u8* end, std::vector<BinaryLogLine>& lines) {
+        while (end - bytes >= (std::ptrdiff_t) sizeof(u32) * 2) {
+            u32 size = read_value<u32>(bytes);
+            u32 flags = read_value<u32>(bytes + sizeof(u32));
+            if (size == 0 || end - bytes < (std::ptrdiff_t) size) {
+                std::cerr << "Truncated record in thread [" << thread_index << "]" << std::endl;
+                return;
+            }
+            if ((flags & binary_log_padding_flag) == 0 && size >= sizeof(BinaryLogRecordHeader)) {
+                auto record_header = read_value<BinaryLogRecordHeader>(bytes);
+                auto it = sites.find(record_header.site_id);
+                BinaryLogLine line{
+                    .time_ns = record_header.time_ns,
+                    .thread_index = thread_index,
+                };
+                if (it == sites.end()) {
+                    line.text = std::format("[{}] [thread {}] Unknown site [{:#x}]", format_binary_log_time(line.time_ns), thread_index, record_header.site_id);
+                } else {
+                    const BinaryLogSite& site = it->second;
+                    const char* level_name = site.level < std::size(binary_log_level_names) ? binary_log_level_names[site.level] : "?";
+                    line.text = std::format(
+                        "[{}] [thread {}] [{}] [{}:{}] [{}] {}",
+                        format_binary_log_time(line.time_ns),
+                        thread_index,
+                        level_name,
+                        site.file_name,
+                        site.line_number,
+                        site.function_name,
+                        format_binary_log_record(site, bytes + sizeof(BinaryLogRecordHeader), bytes + size)
+                    );
+                }
+                lines.push_back(std::move(line));
+            }
+            bytes += size;
+        }
+    }
+
+    int decode_binary_log(const std::string& path) {
+        std::ifstream file(path, std::ios::binary);
+        if (!file) {
+            std::cerr << "Could not open [" << path << "]" << std::endl;
+            return EXIT_FAILURE;
+        }
+        std::vector<u8> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+        if (bytes.size() < sizeof(BinaryLogFileHeader)) {
+            std::cerr << "[" << path << "] is not a binary log" << std::endl;
+            return EXIT_FAILURE;
+        }
+        auto file_header = read_value<BinaryLogFileHeader>(bytes.data());
+        if (std::memcmp(file_header.magic, binary_log_magic, sizeof(binary_log_magic)) != 0) {
+            std::cerr << "[" << path << "] is not a binary log" << std::endl;
+            return EXIT_FAILURE;
+        }
+        if (file_header.version != binary_log_version) {
+            std::cerr << "Unsupported binary log version [" << file_header.version << "]" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        std::unordered_map<u64, BinaryLogSite> sites;
+        std::vector<BinaryLogLine> lines;
+
+        const u8* position = bytes.data() + sizeof(BinaryLogFileHeader);
+        const u8* end = bytes.data() + bytes.size();
+        while (end - position >= (std::ptrdiff_t) sizeof(BinaryLogBlockHeader)) {
+            auto block_header = read_value<BinaryLogBlockHeader>(position);
+            position += sizeof(BinaryLogBlockHeader);
+            if ((u64) (end - position) < block_header.size) {
+                std::cerr << "Truncated block, the log was not shut down cleanly" << std::endl;
+                break;
+            }
+            const u8* block = position;
+            position += block_header.size;
+
+            if (block_header.type == BinaryLogBlockType::Records) {
+                decode_records(sites, block_header.thread_index, block, position, lines);
+                continue;
+            }
+            if (block_header.type != BinaryLogBlockType::Site) {
+                continue;
+            }
+            if (block_header.size < sizeof(BinaryLogSiteHeader)) {
+                std::cerr << "Corrupt block, site block of [" << block_header.size << "] bytes is smaller than its header" << std::endl;
+                continue;
+            }
+            auto site_header = read_value<BinaryLogSiteHeader>(block);
+
+            // The argument types and the strings follow the header, and must all fit in the block
+            u64 site_size = sizeof(BinaryLogSiteHeader) + (u64) site_header.arg_count + site_header.format_size + site_header.file_name_size + site_header.function_name_size;
+            if (site_size > block_header.size) {
+                std::cerr << "Corrupt block, site [" << site_header.site_id << "] needs [" << site_size << "] bytes but the block has [" << block_header.size << "]" << std::endl;
+                continue;
+            }
+            const char* strings = (const char*) block + sizeof(BinaryLogSiteHeader) + site_header.arg_count;
+
+            BinaryLogSite& site = sites[site_header.site_id];
+            site.line_number = site_header.line_number;
+            site.level = site_header.level;
+            site.arg_types.resize(site_header.arg_count);
+            std::memcpy(site.arg_types.data(), block + sizeof(BinaryLogSiteHeader), site_header.arg_count);
+            site.format.assign(strings, site_header.format_size);
+            strings += site_header.format_size;
+            site.file_name.assign(strings, site_header.file_name_size);
+            strings += site_header.file_name_size;
+            site.function_name.assign(strings, site_header.function_name_size);
+        }
+
+        // Every thread writes its own buffer, so records are only ordered within a thread
+        std::stable_sort(lines.begin(), lines.end(), [](const BinaryLogLine& a, const BinaryLogLine& b) {
+            return a.time_ns < b.time_ns;
+        });
+        for (const BinaryLogLine& line : lines) {
+            std::cout << line.text << '\n';
+        }
+        std::cout.flush();
+        return EXIT_SUCCESS;
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc != 2) {
+        std::cerr << "Usage: " << argv[0] << " <file>" << std::endl;
+        return EXIT_FAILURE;
+    }
+    return Game::decode_binary_log(argv[1]);
+}
@@ -0,0 +1,134 @@
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "system/hash.h"
+#include "system/numbers.h"
+
+// Generates a header with the compiled shaders in a directory as arrays, to be compiled into the executable.
+// The header is only rewritten when its contents change, so that an unchanged shader doesn't cause a rebuild.
+//
+// Usage: ShaderEmbedder <compiled shader directory> <output header>
+
+namespace Game {
+    constexpr u32 spirv_magic = 0x07230203;
+    constexpr u32 words_per_line = 8;
+
+    struct CompiledShader {
+        std::string name;       // Source file name, without the .spv extension
+        std::string identifier;
+        std::vector<u32> code;
+        u64 hash = fnv1a_offset_basis;
+    };
+
+    std::string get_identifier(const std::string& file_name) {
+        std::string identifier = file_name;
+        for (char& c : identifier) {
+            if (!std::isalnum((u8) c)) {
+                c = '_';
+            }
+        }
+        return identifier;
+    }
+
+    int embed_shaders(const std::filesystem::path& input_directory, const std::filesystem::path& output_path) {
+        if (!std::filesystem::is_directory(input_directory)) {
+            std::cerr << "Could not find input directory [" << input_directory.string() << "]" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        std::vector<CompiledShader> shaders;
+        for (const std::filesystem::directory_entry& directory_entry : std::filesystem::directory_iterator(input_directory)) {
+            if (!directory_entry.is_regular_file() || directory_entry.path().extension() != ".spv") {
+                continue;
+            }
+            std::ifstream file(directory_entry.path(), std::ios::binary);
+            std::vector<char> bytes(std::istreambuf_iterator<char>(file), (std::istreambuf_iterator<char>()));
+            if (bytes.empty() || bytes.size() % sizeof(u32) != 0) {
+                std::cerr << "[" << directory_entry.path().string() << "] is not SPIR-V, its size of [" << bytes.size() << "] bytes is not a multiple of 4" << std::endl;
+                return EXIT_FAILURE;
+            }
+
+            CompiledShader& shader = shaders.emplace_back();
+            shader.name = directory_entry.path().stem().string();
+            shader.identifier = get_identifier(directory_entry.path().filename().string());
+            shader.code.resize(bytes.size() / sizeof(u32));
+            std::memcpy(shader.code.data(), bytes.data(), bytes.size());
+            if (shader.code[0] != spirv_magic) {
+                std::cerr << "[" << directory_entry.path().string() << "] is not SPIR-V, it doesn't start with the magic number" << std::endl;
+                return EXIT_FAILURE;
+            }
+            shader.hash = hash_bytes(shader.hash, std::string_view(bytes.data(), bytes.size()));
+        }
+        if (shaders.empty()) {
+            std::cerr << "Could not find any compiled shaders in [" << input_directory.string() << "]" << std::endl;
+            return EXIT_FAILURE;
+        }
+        std::sort(shaders.begin(), shaders.end(), [](const CompiledShader& a, const CompiledShader& b) {
+            return a.name < b.name;
+        });
+
+        std::ostringstream header;
+        header << "#pragma once\n\n";
+        header << "// Generated by ShaderEmbedder, do not edit\n\n";
+        header << "#include \"graphics/embedded_shader.h\"\n\n";
+        header << "namespace Game {\n";
+        for (const CompiledShader& shader : shaders) {
+            header << "    alignas(16) constexpr u32 " << shader.identifier << "[] = {";
+            for (u32 i = 0; i < shader.code.size(); ++i) {
+                header << (i % words_per_line == 0 ? "\n        " : " ");
+                header << "0x" << std::hex;
+                header.width(8);
+                header.fill('0');
+                header << shader.code[i] << std::dec << ",";
+            }
+            header << "\n    };\n\n";
+        }
+        header << "    constexpr EmbeddedShader embedded_shaders[] = {\n";
+        for (const CompiledShader& shader : shaders) {
+            header << "        {\"" << shader.name << "\", " << shader.identifier << ", 0x" << std::hex << shader.hash << std::dec << "ull},\n";
+        }
+        header << "    };\n";
+        header << "}\n";
+
+        std::string contents = header.str();
+        {
+            std::ifstream existing_file(output_path, std::ios::binary);
+            std::string existing_contents(std::istreambuf_iterator<char>(existing_file), (std::istreambuf_iterator<char>()));
+            if (existing_contents == contents) {
+                std::cout << "Embedded shaders in [" << output_path.string() << "] are up to date" << std::endl;
+                return EXIT_SUCCESS;
+            }
+        }
+
+        if (output_path.has_parent_path()) {
+            std::filesystem::create_directories(output_path.parent_path());
+        }
+        std::ofstream file(output_path, std::ios::binary | std::ios::trunc);
+        file << contents;
+        file.close();
+        if (!file) {
+            std::cerr << "Could not write [" << output_path.string() << "]" << std::endl;
+            return EXIT_FAILURE;
+        }
+
+        std::cout << "Embedded [" << shaders.size() << "] shaders into [" << output_path.string() << "]" << std::endl;
+        return EXIT_SUCCESS;
+    }
+}
+
+int main(int argc, char** argv) {
+    if (argc != 3) {
+        std::cerr << "Usage: " << argv[0] << " <compiled shader directory> <output header>" << std::endl;
+        return EXIT_FAILURE;
+    }
+    return Game::embed_shaders(argv[1], argv[2]);
+}